@@ -26,6 +26,8 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #include <utki/config.hpp>
 #include <utki/debug.hpp>
 
+#include "startup_profile.hpp"
+
 using namespace ruisapp;
 
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
@@ -53,6 +55,8 @@ std::unique_ptr<application> application_factory::make_application(
 	const char** argv
 )
 {
+	startup_profile::scope profile_scope(startup_phase::make_application);
+
 	auto cli_args = utki::make_span(argv, argc);
 
 	if (cli_args.empty()) {
@@ -83,6 +87,10 @@ application::application(private_parameters params) :
 	name(std::move(params.params.name)),
 	directory(std::move(params.directories))
 {
+	if (!params.params.startup_trace_file.empty()) {
+		startup_profile::inst().set_trace_file(std::move(params.params.startup_trace_file));
+	}
+
 	is_constructed_v = true;
 }
 
@@ -144,6 +152,8 @@ ruis::real application::get_pixels_per_pp(
 
 ruisapp::window& application::make_window(window_parameters window_params)
 {
+	startup_profile::scope profile_scope(startup_phase::make_window);
+
 	auto& win = this->make_window_internal(std::move(window_params));
 
 	// By choice, the VSYNC is enabled by default.
@@ -151,4 +161,4 @@ ruisapp::window& application::make_window(window_parameters window_params)
 	win.gui.context.get().ren().ctx().set_vsync_enabled(true);
 
 	return win;
-}
\ No newline at end of file
+}
@@ -21,6 +21,8 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <exception>
+#include <functional>
 #include <memory>
 
 #include <fsif/file.hpp>
@@ -30,6 +32,7 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #include <ruis/util/key.hpp>
 #include <utki/config.hpp>
 #include <utki/destructable.hpp>
+#include <utki/enum_array.hpp>
 #include <utki/flags.hpp>
 #include <utki/singleton.hpp>
 #include <utki/unique_ref.hpp>
@@ -37,10 +40,42 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #include <utki/version.hpp>
 
 #include "config.hpp"
+#include "inline_function.hpp"
 #include "window.hpp"
 
 namespace ruisapp {
 
+/**
+ * @brief Priority of a procedure posted to the UI thread.
+ * Each priority has its own lane in the UI thread queue. The UI thread executes posted procedures
+ * within a time budget derived from the next frame deadline, so that a burst of posted procedures
+ * does not delay rendering and input handling.
+ */
+enum class ui_priority {
+	/**
+	 * @brief Input critical work.
+	 * Executed first and regardless of the time budget.
+	 * Should only be used for short procedures which directly affect the response to user input.
+	 */
+	input,
+
+	/**
+	 * @brief Normal work.
+	 * Executed after the input critical work, within the time budget.
+	 * Procedures posted via ruis::context::post_to_ui_thread() go to this lane.
+	 */
+	normal,
+
+	/**
+	 * @brief Idle work.
+	 * Executed only when there is no other work and the frame has been finished early,
+	 * i.e. there is spare time left before the next frame deadline.
+	 */
+	idle,
+
+	enum_size
+};
+
 /**
  * @brief Base singleton class of application.
  * An application should subclass this class and return an instance from the
@@ -128,6 +163,25 @@ public:
 			.minor = 0
 		};
 		// clang-format on
+
+		/**
+		 * @brief Read display server events on a dedicated thread.
+		 * The input thread reads events as soon as they arrive, even while the UI thread is busy
+		 * rendering a long frame, so the display server's connection buffer never fills up.
+		 * The events are stamped with their receive time and handed over to the UI thread
+		 * which dispatches them as usual. The receive to dispatch delay is reported as
+		 * frame_phase::input_latency in the windows' frame statistics.
+		 * Only the xorg and wayland backends have the input thread, others ignore this flag.
+		 */
+		bool dedicated_input_thread = false;
+
+		/**
+		 * @brief File to write the startup profile to.
+		 * If not empty, once the first frame is presented, the startup profile is written to the file
+		 * in Chrome trace event JSON format, see ruisapp::startup_profile for details.
+		 * The RUISAPP_STARTUP_TRACE environment variable takes precedence over this value.
+		 */
+		std::string startup_trace_file;
 	};
 
 private:
@@ -168,6 +222,54 @@ public:
 	 */
 	void quit() noexcept;
 
+	/**
+	 * @brief Type of procedures posted to the UI thread.
+	 * Callables not bigger than 6 pointers, e.g. lambdas capturing a few pointers, are stored inline,
+	 * so posting them does not allocate memory. Bigger callables are stored on the heap.
+	 */
+	using ui_procedure_type = inline_function<6 * sizeof(void*)>;
+
+	/**
+	 * @brief Post procedure to the UI thread.
+	 * Can be called from any thread.
+	 * The procedures of the same priority are executed in the order they were posted.
+	 * @param procedure - procedure to execute on the UI thread.
+	 * Priority lanes are supported by the xorg, wayland and headless backends. Other backends have
+	 * a single lane: the priority is ignored and all procedures are executed in the order they were posted.
+	 * @param priority - priority lane to post the procedure to.
+	 */
+	void post_to_ui_thread(
+		ui_procedure_type procedure, //
+		ui_priority priority = ui_priority::normal
+	);
+
+	/**
+	 * @brief UI thread queue metrics.
+	 * Allow detecting producers which flood the UI thread with posted procedures.
+	 * The time procedures wait in the queue before being executed is reported as
+	 * frame_phase::ui_queue_latency in the windows' frame statistics.
+	 */
+	struct ui_queue_metrics {
+		/**
+		 * @brief Number of procedures waiting in each priority lane.
+		 * Sampled when the UI thread started executing the posted procedures last time.
+		 */
+		utki::enum_array<size_t, ui_priority> depth{};
+
+		/**
+		 * @brief Maximal total number of waiting procedures ever observed.
+		 */
+		size_t max_depth = 0;
+	};
+
+	/**
+	 * @brief Get UI thread queue metrics.
+	 * Must be called from the UI thread.
+	 * The metrics are collected by the xorg, wayland and headless backends.
+	 * @return UI thread queue metrics. All zeros on other backends.
+	 */
+	ui_queue_metrics get_ui_queue_metrics();
+
 private:
 	ruisapp::window& make_window_internal(window_parameters window_params);
 
@@ -180,12 +282,82 @@ public:
 	// TODO: allow injecting own style provider (along with loader)
 	ruisapp::window& make_window(window_parameters window_params);
 
+	/**
+	 * @brief Window readiness notification function.
+	 * @param w - the window which has become ready.
+	 */
+	using on_window_ready_function_type = std::function<void(ruisapp::window& w)>;
+
+	/**
+	 * @brief Create native window without waiting for it to become ready.
+	 * On some platforms (e.g. Wayland) a native window can be rendered to only after the display server
+	 * has configured it, which takes at least one round trip to the display server. The make_window() blocks
+	 * until then, while this function returns right away. This allows creating several windows without
+	 * paying for the round trips one after another.
+	 *
+	 * The returned window can be populated with widgets right away. Its first frame is rendered once
+	 * the window is ready. Rendering settings, e.g. vsync, are to be changed only after the window is ready,
+	 * i.e. from the completion function or later. Same as with make_window(), vsync is enabled by default.
+	 *
+	 * Window creation is asynchronous on the wayland backend only. On other backends window creation
+	 * is synchronous, so the completion function is called before this function returns.
+	 * @param window_params - window parameters.
+	 * @param on_ready - completion function, called on the UI thread once the window is ready.
+	 *                   Not called if the window is destroyed before it becomes ready.
+	 * @return The created window.
+	 */
+	ruisapp::window& make_window_async(
+		window_parameters window_params, //
+		on_window_ready_function_type on_ready
+	);
+
 	/**
 	 * @brief Destroy native window.
 	 * @param w - native window to destroy.
 	 */
 	void destroy_window(ruisapp::window& w);
 
+	/**
+	 * @brief Resource loading function.
+	 * @param loader - resource loader to load the resources with.
+	 */
+	using load_function_type = std::function<void(ruis::resource_loader& loader)>;
+
+	/**
+	 * @brief Resource loading completion function.
+	 * @param error - exception thrown by the loading function, or nullptr if loading has succeeded.
+	 */
+	using on_loaded_function_type = std::function<void(std::exception_ptr error)>;
+
+	/**
+	 * @brief Load resources in background.
+	 * The loading function is executed on the resource loading thread. The thread has its own
+	 * graphics context which shares resources with all windows, so decoding images, fonts, SVGs etc.
+	 * and uploading them to GPU does not block the UI thread.
+	 * Once the loading function returns, the completion function is posted to the UI thread,
+	 * at that point the loaded resources are ready to be used by widgets.
+	 * The loading tasks are executed in the order they were submitted.
+	 *
+	 * The loading thread has its own resource loader which is passed to the loading function.
+	 * Resource packs mounted to the windows' resource loader are not visible to it, so the needed
+	 * resource packs have to be mounted to it from the loading function, e.g. by the first loading task.
+	 *
+	 * Loading tasks still pending when the application is destroyed are dropped, neither the loading
+	 * nor the completion functions are called. Same as for the procedures posted to the UI thread,
+	 * completion functions of the tasks which have finished loading, but are not yet executed
+	 * on the UI thread, are not called either.
+	 *
+	 * Background loading is supported by the xorg, wayland and headless backends.
+	 * @param load - loading function, called on the resource loading thread.
+	 * @param on_loaded - completion function, called on the UI thread. Must not be empty.
+	 * @throw std::logic_error - in case the backend does not support background loading.
+	 * @throw std::invalid_argument - in case the completion function is empty.
+	 */
+	void load_resources_async(
+		load_function_type load, //
+		on_loaded_function_type on_loaded
+	);
+
 	/**
 	 * @brief Get dots per density pixel (dp) for given display parameters.
 	 * The size of the dp for desktop displays should normally be equal to one
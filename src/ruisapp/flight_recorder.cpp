@@ -0,0 +1,354 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "flight_recorder.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+using namespace ruisapp;
+
+namespace {
+// initialized when the library is loaded, which is close enough to the program start
+const auto program_start_time = flight_recorder::clock::now();
+
+constexpr auto dump_file_env_var = "RUISAPP_FLIGHT_RECORDER_FILE";
+
+constexpr auto default_dump_file_name = "ruisapp_flight_recorder.json";
+
+using microseconds = std::chrono::duration<double, std::micro>;
+} // namespace
+
+std::string_view ruisapp::to_string(trace_event event)
+{
+	switch (event) {
+		case trace_event::wait:
+			return "wait";
+		case trace_event::update:
+			return "update";
+		case trace_event::ui_queue_drain:
+			return "ui_queue_drain";
+		case trace_event::event_dispatch:
+			return "event_dispatch";
+		case trace_event::native_event:
+			return "native_event";
+		case trace_event::render:
+			return "render";
+		case trace_event::swap:
+			return "swap";
+		case trace_event::window_create:
+			return "window_create";
+		case trace_event::window_destroy:
+			return "window_destroy";
+		case trace_event::window_configure:
+			return "window_configure";
+		case trace_event::window_resize:
+			return "window_resize";
+		case trace_event::enum_size:
+			break;
+	}
+	return "unknown";
+}
+
+// Single producer ring buffer of events.
+// Only the owning thread writes to the ring, while any thread can read it.
+// Each entry is protected by a sequence lock, so that readers can detect entries
+// which were overwritten or were being written while reading.
+struct flight_recorder::ring {
+	struct entry {
+		// 2 * index + 2 of the event stored in the entry, odd value means the entry is being written
+		std::atomic<uint64_t> seq{0};
+
+		// all the fields are atomic to make concurrent reading well defined,
+		// relaxed atomic stores compile to plain stores
+		std::atomic<uint64_t> begin_ns{0};
+		std::atomic<uint64_t> duration_ns{0};
+		std::atomic<uint32_t> event{0};
+		std::atomic<uint32_t> arg0{0};
+		std::atomic<uint32_t> arg1{0};
+	};
+
+	const unsigned thread;
+
+	// whether the owning thread has exited, guarded by the flight_recorder's mutex
+	bool exited = false;
+
+	// total number of events ever recorded to the ring
+	std::atomic<uint64_t> pos{0};
+
+	std::array<entry, ring_size> entries;
+
+	ring(unsigned thread) :
+		thread(thread)
+	{}
+
+	struct event_record {
+		uint64_t begin_ns;
+		uint64_t duration_ns;
+		trace_event event;
+		uint32_t arg0;
+		uint32_t arg1;
+	};
+
+	std::vector<event_record> read() const
+	{
+		std::vector<event_record> ret;
+
+		auto end = this->pos.load(std::memory_order_acquire);
+		auto begin = end > ring_size ? end - ring_size : 0;
+
+		ret.reserve(size_t(end - begin));
+
+		for (auto i = begin; i != end; ++i) {
+			const auto& e = this->entries[i % ring_size];
+
+			auto seq = e.seq.load(std::memory_order_acquire);
+			if (seq != 2 * i + 2) {
+				// overwritten by newer event or being overwritten right now
+				continue;
+			}
+
+			event_record r = {
+				.begin_ns = e.begin_ns.load(std::memory_order_relaxed),
+				.duration_ns = e.duration_ns.load(std::memory_order_relaxed),
+				.event = trace_event(e.event.load(std::memory_order_relaxed)),
+				.arg0 = e.arg0.load(std::memory_order_relaxed),
+				.arg1 = e.arg1.load(std::memory_order_relaxed)
+			};
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (e.seq.load(std::memory_order_relaxed) != seq) {
+				// the entry was overwritten while reading
+				continue;
+			}
+
+			ret.push_back(r);
+		}
+
+		return ret;
+	}
+};
+
+flight_recorder::flight_recorder() :
+	origin(program_start_time)
+{
+	// NOLINTNEXTLINE(concurrency-mt-unsafe, "the environment is not modified by the library")
+	if (auto file_name = std::getenv(dump_file_env_var)) {
+		this->dump_file = file_name;
+	} else {
+		std::error_code ec;
+		auto dir = std::filesystem::temp_directory_path(ec);
+		this->dump_file = (dir / default_dump_file_name).string();
+	}
+}
+
+flight_recorder& flight_recorder::inst()
+{
+	static flight_recorder recorder;
+	return recorder;
+}
+
+struct flight_recorder::thread_ring_owner {
+	ring* r = nullptr;
+
+	thread_ring_owner() = default;
+
+	thread_ring_owner(const thread_ring_owner&) = delete;
+	thread_ring_owner& operator=(const thread_ring_owner&) = delete;
+
+	thread_ring_owner(thread_ring_owner&&) = delete;
+	thread_ring_owner& operator=(thread_ring_owner&&) = delete;
+
+	~thread_ring_owner()
+	{
+		if (this->r) {
+			flight_recorder::inst().on_thread_exit(*this->r);
+		}
+	}
+};
+
+flight_recorder::ring& flight_recorder::get_thread_ring()
+{
+	thread_local thread_ring_owner owner;
+
+	if (!owner.r) {
+		std::lock_guard lock(this->mutex);
+		this->rings.push_back(std::make_shared<ring>(this->num_threads));
+		++this->num_threads;
+		owner.r = this->rings.back().get();
+	}
+
+	return *owner.r;
+}
+
+void flight_recorder::on_thread_exit(ring& r)
+{
+	std::lock_guard lock(this->mutex);
+
+	r.exited = true;
+
+	auto num_exited = size_t(std::count_if(this->rings.begin(), this->rings.end(), [](const auto& e) {
+		return e->exited;
+	}));
+	if (num_exited <= max_exited_threads) {
+		return;
+	}
+
+	// Free the ring of the exited thread which started recording first.
+	// In case a dump is being written at the moment, the ring is freed once the dump is done.
+	auto i = std::find_if(this->rings.begin(), this->rings.end(), [](const auto& e) {
+		return e->exited;
+	});
+	this->rings.erase(i);
+}
+
+void flight_recorder::record(
+	trace_event event, //
+	clock::time_point begin,
+	clock::time_point end,
+	uint32_t arg0,
+	uint32_t arg1
+) noexcept
+{
+	auto& r = [this]() -> ring& {
+		try {
+			return this->get_thread_ring();
+		} catch (...) {
+			// could not allocate the ring, should not normally happen
+			static ring dummy_ring(unsigned(-1));
+			return dummy_ring;
+		}
+	}();
+
+	using std::chrono::duration_cast;
+	using std::chrono::nanoseconds;
+
+	auto i = r.pos.load(std::memory_order_relaxed);
+	auto& e = r.entries[i % ring_size];
+
+	e.seq.store(2 * i + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	e.begin_ns.store(
+		uint64_t(std::max(duration_cast<nanoseconds>(begin - this->origin).count(), nanoseconds::rep(0))),
+		std::memory_order_relaxed
+	);
+	e.duration_ns.store(
+		uint64_t(std::max(duration_cast<nanoseconds>(end - begin).count(), nanoseconds::rep(0))),
+		std::memory_order_relaxed
+	);
+	e.event.store(uint32_t(event), std::memory_order_relaxed);
+	e.arg0.store(arg0, std::memory_order_relaxed);
+	e.arg1.store(arg1, std::memory_order_relaxed);
+
+	e.seq.store(2 * i + 2, std::memory_order_release);
+	r.pos.store(i + 1, std::memory_order_release);
+}
+
+std::string flight_recorder::to_chrome_trace() const
+{
+	std::vector<std::shared_ptr<ring>> rings;
+	{
+		std::lock_guard lock(this->mutex);
+		rings = this->rings;
+	}
+
+	std::stringstream ss;
+	ss << std::fixed << std::setprecision(3);
+
+	ss << R"({"displayTimeUnit":"ms","traceEvents":[)";
+
+	bool first = true;
+	for (const auto& r : rings) {
+		for (const auto& e : r->read()) {
+			if (!first) {
+				ss << ",";
+			}
+			first = false;
+
+			ss << R"({"name":")" << to_string(e.event) << R"(","cat":"ruisapp","pid":1,"tid":)" << r->thread //
+			   << R"(,"ts":)" << microseconds(std::chrono::nanoseconds(e.begin_ns)).count();
+
+			switch (e.event) {
+				case trace_event::window_create:
+				case trace_event::window_destroy:
+				case trace_event::window_configure:
+				case trace_event::window_resize:
+					ss << R"(,"ph":"i","s":"t")";
+					break;
+				default:
+					ss << R"(,"ph":"X","dur":)" << microseconds(std::chrono::nanoseconds(e.duration_ns)).count();
+					break;
+			}
+
+			switch (e.event) {
+				case trace_event::wait:
+					ss << R"(,"args":{"timeout_ms":)" << e.arg0 << "}";
+					break;
+				case trace_event::native_event:
+					ss << R"(,"args":{"type":)" << e.arg0 << "}";
+					break;
+				case trace_event::render:
+				case trace_event::swap:
+				case trace_event::window_create:
+				case trace_event::window_destroy:
+					ss << R"(,"args":{"window":)" << e.arg0 << "}";
+					break;
+				case trace_event::window_configure:
+				case trace_event::window_resize:
+					ss << R"(,"args":{"width":)" << e.arg0 << R"(,"height":)" << e.arg1 << "}";
+					break;
+				default:
+					break;
+			}
+
+			ss << "}";
+		}
+	}
+
+	ss << "]}";
+
+	return ss.str();
+}
+
+bool flight_recorder::dump(const std::string& file_name) const
+{
+	std::ofstream f(file_name);
+	f << this->to_chrome_trace();
+	return bool(f);
+}
+
+bool flight_recorder::dump() const
+{
+	if (!this->dump(this->dump_file)) {
+		std::clog << "ruisapp: could not write flight recorder dump to " << this->dump_file << std::endl;
+		return false;
+	}
+	std::clog << "ruisapp: flight recorder dumped to " << this->dump_file << std::endl;
+	return true;
+}
@@ -0,0 +1,300 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ruisapp {
+
+/**
+ * @brief Events recorded by the flight recorder.
+ */
+enum class trace_event {
+	/**
+	 * @brief Waiting for events in the main loop.
+	 * First argument is the wait timeout in milliseconds.
+	 */
+	wait,
+
+	/**
+	 * @brief Updating updateables in the main loop.
+	 */
+	update,
+
+	/**
+	 * @brief Draining the UI queue in the main loop.
+	 */
+	ui_queue_drain,
+
+	/**
+	 * @brief Dispatching events received from the windowing system in the main loop.
+	 */
+	event_dispatch,
+
+	/**
+	 * @brief Handling of a single event received from the windowing system.
+	 * First argument is the native event type.
+	 */
+	native_event,
+
+	/**
+	 * @brief Rendering a window.
+	 * First argument is the window trace id.
+	 */
+	render,
+
+	/**
+	 * @brief Swapping frame buffers of a window.
+	 * First argument is the window trace id.
+	 */
+	swap,
+
+	/**
+	 * @brief Window was created.
+	 * First argument is the window trace id.
+	 */
+	window_create,
+
+	/**
+	 * @brief Window was destroyed.
+	 * First argument is the window trace id.
+	 */
+	window_destroy,
+
+	/**
+	 * @brief Windowing system requested window configuration.
+	 * Arguments are the requested width and height.
+	 */
+	window_configure,
+
+	/**
+	 * @brief Window viewport was resized.
+	 * Arguments are the new width and height.
+	 */
+	window_resize,
+
+	enum_size
+};
+
+/**
+ * @brief Get name of a trace event.
+ * @param event - trace event to get the name of.
+ * @return Name of the trace event.
+ */
+std::string_view to_string(trace_event event);
+
+/**
+ * @brief Always-on recorder of the recent main loop events.
+ * Each thread records events to its own fixed-size ring buffer, so recording is lock-free,
+ * does not allocate memory and costs a few plain stores in addition to reading the clock.
+ * When the ring is full the oldest events are overwritten, so the recorder always holds
+ * the last few seconds of the application's life.
+ *
+ * Rings of exited threads are kept for the last max_exited_threads threads only, older ones are freed.
+ *
+ * The recorded events can be dumped at any time, from any thread, in Chrome trace event
+ * JSON format (can be viewed with chrome://tracing or https://ui.perfetto.dev).
+ * On linux the dump is also written on fatal errors, i.e. when std::terminate() is called,
+ * and, in case the RUISAPP_FLIGHT_RECORDER_SIGNAL environment variable is set, on the signal
+ * it names, e.g. USR1, SIGUSR2 or a signal number. Without the variable no signal is intercepted.
+ * The file to dump to is set with the RUISAPP_FLIGHT_RECORDER_FILE environment variable,
+ * by default it is ruisapp_flight_recorder.json in the temporary directory.
+ *
+ * Main loop events are recorded by the xorg, wayland and headless backends. On other backends
+ * only window lifecycle, render and swap events are recorded.
+ */
+class flight_recorder
+{
+public:
+	using clock = std::chrono::steady_clock;
+
+	/**
+	 * @brief Maximum number of events kept per thread.
+	 */
+	constexpr static size_t ring_size = 8192;
+
+	/**
+	 * @brief Maximum number of exited threads to keep the recorded events of.
+	 */
+	constexpr static size_t max_exited_threads = 4;
+
+	/**
+	 * @brief Record event duration within a scope.
+	 * Records the event from construction till destruction of the object.
+	 */
+	class scope
+	{
+		const trace_event event;
+		const clock::time_point begin = clock::now();
+
+	public:
+		uint32_t arg0;
+		uint32_t arg1;
+
+		scope(
+			trace_event event, //
+			uint32_t arg0 = 0,
+			uint32_t arg1 = 0
+		) :
+			event(event),
+			arg0(arg0),
+			arg1(arg1)
+		{}
+
+		scope(const scope&) = delete;
+		scope& operator=(const scope&) = delete;
+
+		scope(scope&&) = delete;
+		scope& operator=(scope&&) = delete;
+
+		~scope()
+		{
+			flight_recorder::inst().record(
+				this->event, //
+				this->begin,
+				clock::now(),
+				this->arg0,
+				this->arg1
+			);
+		}
+	};
+
+private:
+	struct ring;
+
+	// frees the thread's ring when the thread exits
+	struct thread_ring_owner;
+
+	const clock::time_point origin;
+
+	mutable std::mutex mutex;
+
+	// rings of all threads which have recorded anything, in the order of the threads' first recording,
+	// rings of a few last exited threads are kept to be able to see what those threads were doing
+	std::vector<std::shared_ptr<ring>> rings;
+
+	// used to assign trace ids to threads
+	unsigned num_threads = 0;
+
+	std::string dump_file;
+
+	flight_recorder();
+
+	ring& get_thread_ring();
+
+	void on_thread_exit(ring& r);
+
+public:
+	flight_recorder(const flight_recorder&) = delete;
+	flight_recorder& operator=(const flight_recorder&) = delete;
+
+	flight_recorder(flight_recorder&&) = delete;
+	flight_recorder& operator=(flight_recorder&&) = delete;
+
+	~flight_recorder() = default;
+
+	/**
+	 * @brief Get the program-wide flight recorder.
+	 * @return The flight recorder.
+	 */
+	static flight_recorder& inst();
+
+	/**
+	 * @brief Record event.
+	 * Can be called from any thread. Lock-free, except for the very first call on a thread.
+	 * @param event - event to record.
+	 * @param begin - time the event has started.
+	 * @param end - time the event has ended. For instant events it is same as begin.
+	 * @param arg0 - first event argument.
+	 * @param arg1 - second event argument.
+	 */
+	void record(
+		trace_event event, //
+		clock::time_point begin,
+		clock::time_point end,
+		uint32_t arg0 = 0,
+		uint32_t arg1 = 0
+	) noexcept;
+
+	/**
+	 * @brief Record instant event.
+	 * Same as record() with begin and end both set to current time.
+	 * @param event - event to record.
+	 * @param arg0 - first event argument.
+	 * @param arg1 - second event argument.
+	 */
+	void record_instant(
+		trace_event event, //
+		uint32_t arg0 = 0,
+		uint32_t arg1 = 0
+	) noexcept
+	{
+		auto now = clock::now();
+		this->record(
+			event, //
+			now,
+			now,
+			arg0,
+			arg1
+		);
+	}
+
+	/**
+	 * @brief Get recorded events in Chrome trace event JSON format.
+	 * Can be called from any thread while other threads keep recording.
+	 * @return JSON string.
+	 */
+	std::string to_chrome_trace() const;
+
+	/**
+	 * @brief Write recorded events to a file in Chrome trace event JSON format.
+	 * @param file_name - name of the file to write to.
+	 * @return true if the file was written successfully.
+	 * @return false otherwise.
+	 */
+	bool dump(const std::string& file_name) const;
+
+	/**
+	 * @brief Write recorded events to the default dump file.
+	 * The path of the written file is printed to std::clog.
+	 * @return true if the file was written successfully.
+	 * @return false otherwise.
+	 */
+	bool dump() const;
+
+	/**
+	 * @brief Get the default dump file name.
+	 * @return The default dump file name.
+	 */
+	const std::string& get_dump_file() const noexcept
+	{
+		return this->dump_file;
+	}
+};
+
+} // namespace ruisapp
@@ -0,0 +1,148 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "frame_statistics.hpp"
+
+#include <algorithm>
+#include <limits>
+
+using namespace ruisapp;
+
+void frame_statistics::push(const sample& s) noexcept
+{
+	auto n = this->num_recorded.load(std::memory_order_relaxed);
+
+	auto& slot = this->ring[n % capacity];
+
+	auto seq = slot.sequence.load(std::memory_order_relaxed);
+
+	// mark the slot as being written
+	slot.sequence.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	for (size_t p = 0; p != slot.durations_us.size(); ++p) {
+		auto us = std::clamp<duration_type::rep>(
+			s.durations[frame_phase(p)].count(), //
+			0,
+			std::numeric_limits<uint32_t>::max()
+		);
+		slot.durations_us[p].store(uint32_t(us), std::memory_order_relaxed);
+	}
+
+	// mark the slot as written
+	slot.sequence.store(seq + 2, std::memory_order_release);
+
+	this->num_recorded.store(n + 1, std::memory_order_release);
+}
+
+std::vector<frame_statistics::sample> frame_statistics::get_samples() const
+{
+	auto n = this->num_recorded.load(std::memory_order_acquire);
+
+	auto count = std::min(n, uint64_t(capacity));
+
+	std::vector<sample> ret;
+	ret.reserve(count);
+
+	for (auto i = n - count; i != n; ++i) {
+		const auto& slot = this->ring[i % capacity];
+
+		auto seq_before = slot.sequence.load(std::memory_order_acquire);
+		if (seq_before % 2 != 0) {
+			// the slot is being written
+			continue;
+		}
+
+		sample s;
+		for (size_t p = 0; p != slot.durations_us.size(); ++p) {
+			s.durations[frame_phase(p)] = duration_type(slot.durations_us[p].load(std::memory_order_relaxed));
+		}
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		if (slot.sequence.load(std::memory_order_relaxed) != seq_before) {
+			// the slot was overwritten while reading
+			continue;
+		}
+
+		ret.push_back(s);
+	}
+
+	return ret;
+}
+
+frame_statistics::histogram frame_statistics::get_histogram(frame_phase phase) const
+{
+	auto samples = this->get_samples();
+
+	histogram ret;
+
+	if (samples.empty()) {
+		return ret;
+	}
+
+	ret.num_samples = samples.size();
+	ret.min = duration_type::max();
+
+	duration_type sum{0};
+
+	for (const auto& s : samples) {
+		auto d = s.durations[phase];
+
+		ret.min = std::min(ret.min, d);
+		ret.max = std::max(ret.max, d);
+		sum += d;
+
+		auto us = uint64_t(d.count());
+		size_t bucket = 0;
+		while (us != 0 && bucket != histogram::num_buckets - 1) {
+			us >>= 1;
+			++bucket;
+		}
+		++ret.buckets[bucket];
+	}
+
+	ret.mean = sum / samples.size();
+
+	return ret;
+}
+
+frame_statistics::duration_type frame_statistics::get_percentile(frame_phase phase, float fraction) const
+{
+	auto samples = this->get_samples();
+
+	if (samples.empty()) {
+		return duration_type{0};
+	}
+
+	std::vector<duration_type> durations;
+	durations.reserve(samples.size());
+	for (const auto& s : samples) {
+		durations.push_back(s.durations[phase]);
+	}
+
+	auto index = size_t(std::clamp(fraction, 0.0f, 1.0f) * float(durations.size() - 1));
+
+	auto nth = std::next(durations.begin(), std::ptrdiff_t(index));
+	std::nth_element(durations.begin(), nth, durations.end());
+
+	return *nth;
+}
@@ -0,0 +1,190 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include <utki/enum_array.hpp>
+
+namespace ruisapp {
+
+/**
+ * @brief Phases of a main loop iteration.
+ */
+enum class frame_phase {
+	/**
+	 * @brief Updating of the ruis::updater updateables.
+	 */
+	update,
+
+	/**
+	 * @brief CPU time of the widget hierarchy rendering, i.e. ruis::gui::render().
+	 */
+	render,
+
+	/**
+	 * @brief Time blocked in swapping frame buffers.
+	 */
+	swap,
+
+	/**
+	 * @brief Dispatching of events coming from the display server.
+	 * Note, that on backends where rendering is triggered by display server's callbacks (e.g. Wayland),
+	 * this time includes the render and swap times.
+	 */
+	event_dispatch,
+
+	/**
+	 * @brief Execution of procedures posted to the UI thread.
+	 */
+	ui_queue_drain,
+
+	/**
+	 * @brief Maximal delay between receiving an input event and dispatching it.
+	 * Unlike the rest of the entries, this is not a duration of a phase, but the longest time an event
+	 * received from the display server waited for being dispatched to the GUI within the main loop iteration.
+	 * Only measured when events are read by a dedicated input thread,
+	 * see ruisapp::application::parameters::dedicated_input_thread.
+	 */
+	input_latency,
+
+	/**
+	 * @brief Maximal time a procedure posted to the UI thread waited before being executed.
+	 * Like input_latency, this is not a duration of a phase, but the longest wait of the procedures
+	 * executed within the main loop iteration.
+	 * See ruisapp::application::post_to_ui_thread().
+	 * Measured by the xorg, wayland and headless backends, always zero on other backends.
+	 */
+	ui_queue_latency,
+
+	enum_size
+};
+
+/**
+ * @brief Rolling record of main loop iteration timings.
+ * Holds a fixed number of latest samples in a lock-free ring buffer.
+ * Samples are recorded by the UI thread and can be read from any thread.
+ */
+class frame_statistics
+{
+public:
+	using duration_type = std::chrono::microseconds;
+
+	/**
+	 * @brief Timings of a single main loop iteration.
+	 */
+	struct sample {
+		utki::enum_array<duration_type, frame_phase> durations{};
+	};
+
+	/**
+	 * @brief Number of latest samples kept.
+	 */
+	constexpr static size_t capacity = 256;
+
+	/**
+	 * @brief Histogram of a frame phase durations.
+	 * Bucket 0 counts durations below 1 microsecond.
+	 * Bucket i > 0 counts durations in range [2^(i-1), 2^i) microseconds.
+	 * The last bucket also counts all longer durations.
+	 */
+	struct histogram {
+		constexpr static size_t num_buckets = 24;
+
+		std::array<size_t, num_buckets> buckets{};
+
+		size_t num_samples = 0;
+
+		duration_type min{0};
+		duration_type max{0};
+		duration_type mean{0};
+	};
+
+	frame_statistics() = default;
+
+	frame_statistics(const frame_statistics&) = delete;
+	frame_statistics& operator=(const frame_statistics&) = delete;
+
+	frame_statistics(frame_statistics&&) = delete;
+	frame_statistics& operator=(frame_statistics&&) = delete;
+
+	~frame_statistics() = default;
+
+	/**
+	 * @brief Record a sample.
+	 * Overwrites the oldest sample when the ring buffer is full.
+	 * Must only be called from one thread at a time, normally the UI thread.
+	 * @param s - sample to record.
+	 */
+	void push(const sample& s) noexcept;
+
+	/**
+	 * @brief Get latest samples.
+	 * Can be called from any thread.
+	 * Samples which are being overwritten during the call are skipped.
+	 * @return Latest samples, oldest first.
+	 */
+	std::vector<sample> get_samples() const;
+
+	/**
+	 * @brief Get histogram of the frame phase durations over the latest samples.
+	 * Can be called from any thread.
+	 * @param phase - frame phase to get the histogram for.
+	 * @return Histogram of the phase durations.
+	 */
+	histogram get_histogram(frame_phase phase) const;
+
+	/**
+	 * @brief Get percentile of the frame phase durations over the latest samples.
+	 * Can be called from any thread.
+	 * @param phase - frame phase to get the percentile for.
+	 * @param fraction - percentile fraction in range [0, 1], e.g. 0.99 for 99th percentile.
+	 * @return Duration value of the requested percentile. Zero if there are no samples.
+	 */
+	duration_type get_percentile(frame_phase phase, float fraction) const;
+
+	/**
+	 * @brief Get total number of samples recorded since creation.
+	 * @return Total number of recorded samples.
+	 */
+	uint64_t get_num_recorded() const noexcept
+	{
+		return this->num_recorded.load(std::memory_order_acquire);
+	}
+
+private:
+	struct slot {
+		// odd value means the slot is being written
+		std::atomic_uint32_t sequence{0};
+		std::array<std::atomic_uint32_t, size_t(frame_phase::enum_size)> durations_us{};
+	};
+
+	std::array<slot, capacity> ring;
+
+	std::atomic_uint64_t num_recorded{0};
+};
+
+} // namespace ruisapp
@@ -35,7 +35,7 @@ void app_window::set_win_rect(const ruis::rect& r)
 
 	ruis::rect viewport_rect = r;
 	viewport_rect.p.y() = glob.cur_window_dims.y() - viewport_rect.y2();
-	this->gui.set_viewport(viewport_rect);
+	this->set_viewport(viewport_rect);
 }
 
 application_glue::application_glue(utki::version_duplet gl_version) :
@@ -71,9 +71,8 @@ app_window& application_glue::make_window(ruisapp::window_parameters window_para
 
 	auto ruis_context = utki::make_shared<ruis::context>(ruis::context::parameters{
 		.post_to_ui_thread_function =
-			[this](std::function<void()> procedure) {
-				auto& glob = get_glob();
-				glob.ui_queue.push_back(std::move(procedure));
+			[](std::function<void()> procedure) {
+				ruisapp::inst().post_to_ui_thread(std::move(procedure));
 			},
 		.updater = this->updater,
 		.renderer = utki::make_shared<ruis::render::renderer>(
@@ -166,6 +165,21 @@ ruisapp::window& ruisapp::application::make_window_internal(ruisapp::window_para
 	return glue.make_window(std::move(window_params));
 }
 
+ruisapp::window& ruisapp::application::make_window_async(
+	window_parameters window_params, //
+	on_window_ready_function_type on_ready
+)
+{
+	// window creation is synchronous on this backend, so the window is ready right away
+	auto& win = this->make_window(std::move(window_params));
+
+	if (on_ready) {
+		on_ready(win);
+	}
+
+	return win;
+}
+
 void ruisapp::application::destroy_window(ruisapp::window& w)
 {
 	utki::assert(
@@ -182,3 +196,28 @@ void ruisapp::application::quit() noexcept
 	utki::assert(globals_wrapper::native_activity, SL);
 	ANativeActivity_finish(globals_wrapper::native_activity);
 }
+
+void ruisapp::application::post_to_ui_thread(
+	ui_procedure_type procedure, //
+	[[maybe_unused]] ui_priority priority
+)
+{
+	// this backend has a single UI queue lane, so the priority is ignored
+	auto& glob = get_glob();
+	glob.ui_queue.push_back(std::move(procedure));
+}
+
+ruisapp::application::ui_queue_metrics ruisapp::application::get_ui_queue_metrics()
+{
+	// the metrics are not collected by this backend
+	return {};
+}
+
+void ruisapp::application::load_resources_async(
+	[[maybe_unused]] load_function_type load, //
+	[[maybe_unused]] on_loaded_function_type on_loaded
+)
+{
+	// this backend has no resource loading thread, loading synchronously instead would block the UI thread
+	throw std::logic_error("application::load_resources_async(): not supported on this backend");
+}
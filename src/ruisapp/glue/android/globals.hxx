@@ -23,11 +23,12 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #include <android/native_activity.h>
 #include <android/window.h>
-#include <nitki/queue.hpp>
 #include <utki/debug.hpp>
 #include <utki/unique_ref.hpp>
 
 #include "../../application.hpp"
+#include "../procedure_queue.hxx"
+#include "../wakeup_waitable.hxx"
 
 #include "android_configuration.hxx"
 #include "event_fd.hxx"
@@ -65,7 +66,7 @@ struct globals_wrapper final {
 		this->main_loop_event_fd.set();
 	}};
 
-	nitki::queue ui_queue;
+	procedure_queue<wakeup_waitable> ui_queue;
 
 	utki::unique_ref<android_configuration_wrapper> cur_android_configuration =
 		utki::make_unique<android_configuration_wrapper>(*globals_wrapper::native_activity->assetManager);
@@ -127,7 +127,7 @@ JNIEXPORT void JNICALL Java_io_github_cppfw_ruisapp_RuisappActivity_handleCharac
 	auto& glue = get_glue();
 
 	if (auto win = glue.get_window()) {
-		win->gui.send_character_input(provider, ruis::key::unknown);
+		win->send_character_input(provider, ruis::key::unknown);
 	}
 }
 
@@ -232,7 +232,7 @@ void handle_input_events()
 
 							utki::assert(win, SL);
 
-							win->gui.send_mouse_button(
+							win->send_mouse_button(
 								ruis::button_action::press, //
 								win->android_win_coords_to_ruisapp_win_rect_coords(p), // pos
 								ruis::mouse_button::left,
@@ -269,7 +269,7 @@ void handle_input_events()
 
 							utki::assert(win, SL);
 
-							win->gui.send_mouse_button(
+							win->send_mouse_button(
 								ruis::button_action::release, //
 								win->android_win_coords_to_ruisapp_win_rect_coords(p), // pos
 								ruis::mouse_button::left,
@@ -307,7 +307,7 @@ void handle_input_events()
 								glob.pointers[pointer_id] = p;
 
 								utki::assert(win, SL);
-								win->gui.send_mouse_move(
+								win->send_mouse_move(
 									win->android_win_coords_to_ruisapp_win_rect_coords(p), // pos
 									pointer_id
 								);
@@ -346,20 +346,20 @@ void handle_input_events()
 
 							// detect auto-repeated key events
 							if (AKeyEvent_getRepeatCount(event) == 0) {
-								win->gui.send_key(
+								win->send_key(
 									ruis::button_action::press, //
 									key
 								);
 							}
 
-							win->gui.send_character_input(
+							win->send_character_input(
 								key_input_string_resolver, //
 								key
 							);
 							break;
 						case AKEY_EVENT_ACTION_UP:
 							// utki::log_debug([&](auto&o){o << "AKEY_EVENT_ACTION_UP" << std::endl;});
-							win->gui.send_key(
+							win->send_key(
 								ruis::button_action::release, //
 								key
 							);
@@ -0,0 +1,176 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <optional>
+#include <stdexcept>
+
+#include <GLES2/gl2.h>
+#include <ruis/render/native_window.hpp>
+#include <utki/shared_ref.hpp>
+#include <utki/string.hpp>
+#include <utki/version.hpp>
+
+#include "egl_utils.hxx"
+
+namespace {
+/**
+ * @brief GL context which is not tied to any window.
+ * Used for GL contexts which are only needed to create GL objects shared with
+ * window contexts, e.g. the shared resources context and the resource loading context.
+ * The context is bound without a surface in case EGL_KHR_surfaceless_context is supported,
+ * otherwise it is bound with a tiny pbuffer surface. Nothing can be presented from the context.
+ * @tparam display_wrapper_type - backend's display wrapper type, must have egl_display member.
+ */
+template <typename display_wrapper_type>
+class egl_offscreen_context : public ruis::render::native_window
+{
+	const utki::shared_ref<display_wrapper_type> display;
+
+	egl_config_wrapper egl_config;
+	egl_context_wrapper egl_context;
+
+	// not created in case EGL_KHR_surfaceless_context is supported
+	std::optional<egl_pbuffer_surface_wrapper> egl_surface;
+
+	bool is_surfaceless() const noexcept
+	{
+		return this->display.get().egl_display.extensions.get(egl::extension::khr_surfaceless_context);
+	}
+
+public:
+	egl_offscreen_context(
+		utki::shared_ref<display_wrapper_type> display, //
+		const utki::version_duplet& gl_version,
+		const egl_offscreen_context* shared_context
+	) :
+		display(std::move(display)),
+		egl_config(
+			this->display.get().egl_display, //
+			gl_version,
+			ruisapp::window_parameters{},
+			// surfaceless context does not need pbuffer support from the config
+			this->is_surfaceless() ? 0 : EGL_PBUFFER_BIT
+		),
+		egl_context(
+			this->display.get().egl_display, //
+			gl_version,
+			this->egl_config,
+			shared_context ? shared_context->get_egl_context() : EGL_NO_CONTEXT
+		)
+	{
+		if (!this->is_surfaceless()) {
+			this->egl_surface.emplace(
+				this->display.get().egl_display, //
+				this->egl_config,
+				r4::vector2<unsigned>{1, 1}
+			);
+		}
+	}
+
+	egl_offscreen_context(const egl_offscreen_context&) = delete;
+	egl_offscreen_context& operator=(const egl_offscreen_context&) = delete;
+
+	egl_offscreen_context(egl_offscreen_context&&) = delete;
+	egl_offscreen_context& operator=(egl_offscreen_context&&) = delete;
+
+	~egl_offscreen_context() override = default;
+
+	EGLContext get_egl_context() const noexcept
+	{
+		return this->egl_context.context;
+	}
+
+	r4::vector2<unsigned> get_dims() const noexcept override
+	{
+		return {0, 0};
+	}
+
+	void swap_frame_buffers() override
+	{
+		// nothing to present
+	}
+
+	void bind_rendering_context() override
+	{
+		EGLSurface surface = this->egl_surface.has_value() ? this->egl_surface.value().surface : EGL_NO_SURFACE;
+
+		if (eglMakeCurrent(
+				this->display.get().egl_display.display, //
+				surface,
+				surface,
+				this->egl_context.context
+			) == EGL_FALSE)
+		{
+			throw std::runtime_error(utki::cat(
+				"eglMakeCurrent() failed, error: ", //
+				egl_error_to_string(eglGetError())
+			));
+		}
+	}
+
+	bool is_rendering_context_bound() const noexcept override
+	{
+		return eglGetCurrentContext() == this->egl_context.context;
+	}
+
+	/**
+	 * @brief Unbind the context from the calling thread.
+	 * Waits for all GL commands issued in the context to complete, so that GL objects
+	 * created in the context are ready to be used from shared contexts.
+	 * Does nothing if the context is not bound on the calling thread.
+	 */
+	void unbind_rendering_context()
+	{
+		if (!this->is_rendering_context_bound()) {
+			return;
+		}
+		glFinish();
+		eglMakeCurrent(
+			this->display.get().egl_display.display,
+			EGL_NO_SURFACE,
+			EGL_NO_SURFACE,
+			EGL_NO_CONTEXT
+		);
+	}
+
+	void set_vsync_enabled_internal([[maybe_unused]] bool enabled) override
+	{
+		// nothing is presented, so no vsync
+	}
+
+	void set_fullscreen_internal([[maybe_unused]] bool enable) override
+	{
+		// no window, nothing to do
+	}
+
+	void set_mouse_cursor([[maybe_unused]] ruis::mouse_cursor c) override
+	{
+		// no window, nothing to do
+	}
+
+	void set_mouse_cursor_visible([[maybe_unused]] bool visible) override
+	{
+		// no window, nothing to do
+	}
+};
+} // namespace
@@ -21,14 +21,23 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <algorithm>
+#include <chrono>
 #include <stdexcept>
 #include <string_view>
+#include <vector>
 
 #include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <r4/rectangle.hpp>
+#include <utki/span.hpp>
 #include <utki/string.hpp>
 #include <utki/version.hpp>
 
+#include "../startup_profile.hpp"
 #include "../window.hpp"
+#include "fb_config_selector.hxx"
+#include "frame_fences.hxx"
 
 namespace {
 std::string_view egl_error_to_string(EGLint err)
@@ -75,9 +84,19 @@ namespace {
 namespace egl {
 enum class extension {
 	khr_surfaceless_context,
+	ext_buffer_age,
+	khr_partial_update,
+	khr_swap_buffers_with_damage,
+	ext_swap_buffers_with_damage,
+	khr_fence_sync,
 
 	enum_size
 };
+
+/**
+ * @brief Tag for opening EGL display not backed by any display server.
+ */
+struct headless_display_tag {};
 } // namespace egl
 } // namespace
 
@@ -90,6 +109,17 @@ public:
 
 	const utki::flags<egl::extension> extensions;
 
+	// eglSwapBuffersWithDamageKHR() or eglSwapBuffersWithDamageEXT(), nullptr if not supported
+	const PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC swap_buffers_with_damage;
+
+	// eglSetDamageRegionKHR(), nullptr if not supported
+	const PFNEGLSETDAMAGEREGIONKHRPROC set_damage_region;
+
+	// EGL_KHR_fence_sync functions, nullptr if not supported
+	const PFNEGLCREATESYNCKHRPROC create_sync;
+	const PFNEGLDESTROYSYNCKHRPROC destroy_sync;
+	const PFNEGLCLIENTWAITSYNCKHRPROC client_wait_sync;
+
 private:
 	utki::flags<egl::extension> get_egl_extensions()
 	{
@@ -114,12 +144,158 @@ private:
 			if (e == "EGL_KHR_surfaceless_context"sv) {
 				exts.set(egl::extension::khr_surfaceless_context);
 				utki::logcat_debug("  EGL_KHR_surfaceless_context", '\n');
+			} else if (e == "EGL_EXT_buffer_age"sv) {
+				exts.set(egl::extension::ext_buffer_age);
+				utki::logcat_debug("  EGL_EXT_buffer_age", '\n');
+			} else if (e == "EGL_KHR_partial_update"sv) {
+				exts.set(egl::extension::khr_partial_update);
+				utki::logcat_debug("  EGL_KHR_partial_update", '\n');
+			} else if (e == "EGL_KHR_swap_buffers_with_damage"sv) {
+				exts.set(egl::extension::khr_swap_buffers_with_damage);
+				utki::logcat_debug("  EGL_KHR_swap_buffers_with_damage", '\n');
+			} else if (e == "EGL_EXT_swap_buffers_with_damage"sv) {
+				exts.set(egl::extension::ext_swap_buffers_with_damage);
+				utki::logcat_debug("  EGL_EXT_swap_buffers_with_damage", '\n');
+			} else if (e == "EGL_KHR_fence_sync"sv) {
+				exts.set(egl::extension::khr_fence_sync);
+				utki::logcat_debug("  EGL_KHR_fence_sync", '\n');
 			}
 		}
 
 		return exts;
 	}
 
+	PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC get_swap_buffers_with_damage_proc()
+	{
+		if (this->extensions.get(egl::extension::khr_swap_buffers_with_damage)) {
+			return PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC(eglGetProcAddress("eglSwapBuffersWithDamageKHR"));
+		}
+		if (this->extensions.get(egl::extension::ext_swap_buffers_with_damage)) {
+			// the EXT function has same signature as the KHR one
+			return PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC(eglGetProcAddress("eglSwapBuffersWithDamageEXT"));
+		}
+		return nullptr;
+	}
+
+	PFNEGLSETDAMAGEREGIONKHRPROC get_set_damage_region_proc()
+	{
+		if (this->extensions.get(egl::extension::khr_partial_update)) {
+			return PFNEGLSETDAMAGEREGIONKHRPROC(eglGetProcAddress("eglSetDamageRegionKHR"));
+		}
+		return nullptr;
+	}
+
+	template <typename proc_type>
+	proc_type get_fence_sync_proc(const char* name)
+	{
+		if (this->extensions.get(egl::extension::khr_fence_sync)) {
+			return proc_type(eglGetProcAddress(name));
+		}
+		return nullptr;
+	}
+
+	utki::version_duplet initialize()
+	{
+		EGLint major = 0;
+		EGLint minor = 0;
+
+		if (eglInitialize(
+				this->display, //
+				&major,
+				&minor
+			) == EGL_FALSE)
+		{
+			eglTerminate(this->display);
+			throw std::runtime_error("eglInitialize() failed");
+		}
+		return utki::version_duplet{
+			.major = uint16_t(major), //
+			.minor = uint16_t(minor)
+		};
+	}
+
+	void bind_api()
+	{
+		utki::logcat_debug("EGL version = ", this->egl_version, '\n');
+
+		try {
+			if (eglBindAPI(EGL_OPENGL_ES_API) == EGL_FALSE) {
+				throw std::runtime_error("eglBindApi() failed");
+			}
+		} catch (...) {
+			eglTerminate(this->display);
+			throw;
+		}
+	}
+
+	static EGLDisplay get_headless_display()
+	{
+		// client extensions are queried with EGL_NO_DISPLAY
+		const char* client_exts_str = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+		if (!client_exts_str) {
+			throw std::runtime_error(utki::cat(
+				"eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS) failed, error: ", //
+				egl_error_to_string(eglGetError())
+			));
+		}
+		utki::logcat_debug("EGL client extensions string = ", client_exts_str, '\n');
+
+		auto client_exts = utki::split(std::string_view(client_exts_str));
+
+		auto has_extension = [&](std::string_view name) {
+			return std::ranges::find(client_exts, name) != client_exts.end();
+		};
+
+		using namespace std::string_view_literals;
+
+		auto egl_get_platform_display_ext =
+			PFNEGLGETPLATFORMDISPLAYEXTPROC(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+		if (!has_extension("EGL_EXT_platform_base"sv) || !egl_get_platform_display_ext) {
+			throw std::runtime_error("EGL_EXT_platform_base is not supported, unable to open headless EGL display");
+		}
+
+		if (has_extension("EGL_MESA_platform_surfaceless"sv)) {
+			auto d = egl_get_platform_display_ext(
+				EGL_PLATFORM_SURFACELESS_MESA, //
+				EGL_DEFAULT_DISPLAY,
+				nullptr
+			);
+			if (d != EGL_NO_DISPLAY) {
+				utki::logcat_debug("EGL display opened via EGL_MESA_platform_surfaceless", '\n');
+				return d;
+			}
+		}
+
+		if (has_extension("EGL_EXT_platform_device"sv) && has_extension("EGL_EXT_device_enumeration"sv)) {
+			auto egl_query_devices_ext = PFNEGLQUERYDEVICESEXTPROC(eglGetProcAddress("eglQueryDevicesEXT"));
+
+			EGLDeviceEXT device = EGL_NO_DEVICE_EXT;
+			EGLint num_devices = 0;
+			if (egl_query_devices_ext &&
+				egl_query_devices_ext(
+					1, // max number of devices to return
+					&device,
+					&num_devices
+				) == EGL_TRUE &&
+				num_devices > 0)
+			{
+				auto d = egl_get_platform_display_ext(
+					EGL_PLATFORM_DEVICE_EXT, //
+					device,
+					nullptr
+				);
+				if (d != EGL_NO_DISPLAY) {
+					utki::logcat_debug("EGL display opened via EGL_EXT_platform_device", '\n');
+					return d;
+				}
+			}
+		}
+
+		throw std::runtime_error(
+			"could not open headless EGL display, neither EGL_MESA_platform_surfaceless nor EGL_EXT_platform_device is usable"
+		);
+	}
+
 public:
 	egl_display_wrapper(EGLNativeDisplayType display_id = EGL_DEFAULT_DISPLAY) :
 		display([&]() {
@@ -133,36 +309,28 @@ public:
 
 			return d;
 		}()),
-		egl_version([&]() {
-			EGLint major = 0;
-			EGLint minor = 0;
-
-			if (eglInitialize(
-					this->display, //
-					&major,
-					&minor
-				) == EGL_FALSE)
-			{
-				eglTerminate(this->display);
-				throw std::runtime_error("eglInitialize() failed");
-			}
-			return utki::version_duplet{
-				.major = uint16_t(major), //
-				.minor = uint16_t(minor)
-			};
-		}()),
-		extensions(this->get_egl_extensions())
+		egl_version(this->initialize()),
+		extensions(this->get_egl_extensions()),
+		swap_buffers_with_damage(this->get_swap_buffers_with_damage_proc()),
+		set_damage_region(this->get_set_damage_region_proc()),
+		create_sync(this->get_fence_sync_proc<PFNEGLCREATESYNCKHRPROC>("eglCreateSyncKHR")),
+		destroy_sync(this->get_fence_sync_proc<PFNEGLDESTROYSYNCKHRPROC>("eglDestroySyncKHR")),
+		client_wait_sync(this->get_fence_sync_proc<PFNEGLCLIENTWAITSYNCKHRPROC>("eglClientWaitSyncKHR"))
 	{
-		utki::logcat_debug("EGL version = ", this->egl_version, '\n');
+		this->bind_api();
+	}
 
-		try {
-			if (eglBindAPI(EGL_OPENGL_ES_API) == EGL_FALSE) {
-				throw std::runtime_error("eglBindApi() failed");
-			}
-		} catch (...) {
-			eglTerminate(this->display);
-			throw;
-		}
+	egl_display_wrapper(egl::headless_display_tag) :
+		display(get_headless_display()),
+		egl_version(this->initialize()),
+		extensions(this->get_egl_extensions()),
+		swap_buffers_with_damage(this->get_swap_buffers_with_damage_proc()),
+		set_damage_region(this->get_set_damage_region_proc()),
+		create_sync(this->get_fence_sync_proc<PFNEGLCREATESYNCKHRPROC>("eglCreateSyncKHR")),
+		destroy_sync(this->get_fence_sync_proc<PFNEGLDESTROYSYNCKHRPROC>("eglDestroySyncKHR")),
+		client_wait_sync(this->get_fence_sync_proc<PFNEGLCLIENTWAITSYNCKHRPROC>("eglClientWaitSyncKHR"))
+	{
+		this->bind_api();
 	}
 
 	egl_display_wrapper(const egl_display_wrapper&) = delete;
@@ -178,6 +346,56 @@ public:
 };
 } // namespace
 
+namespace {
+/**
+ * @brief EGL fence functions for frame_fences.
+ */
+struct egl_fence_api {
+	using fence_type = EGLSyncKHR;
+
+	const egl_display_wrapper& egl_display;
+
+	bool is_supported() const noexcept
+	{
+		return this->egl_display.create_sync && this->egl_display.destroy_sync && this->egl_display.client_wait_sync;
+	}
+
+	fence_type insert()
+	{
+		auto sync = this->egl_display.create_sync(
+			this->egl_display.display, //
+			EGL_SYNC_FENCE_KHR,
+			nullptr
+		);
+		if (sync == EGL_NO_SYNC_KHR) {
+			return fence_type{};
+		}
+		return sync;
+	}
+
+	void wait(
+		fence_type fence, //
+		std::chrono::nanoseconds timeout
+	)
+	{
+		this->egl_display.client_wait_sync(
+			this->egl_display.display,
+			fence,
+			EGL_SYNC_FLUSH_COMMANDS_BIT_KHR,
+			EGLTimeKHR(timeout.count())
+		);
+	}
+
+	void destroy(fence_type fence)
+	{
+		this->egl_display.destroy_sync(
+			this->egl_display.display, //
+			fence
+		);
+	}
+};
+} // namespace
+
 namespace {
 struct egl_config_wrapper {
 	EGLConfig config;
@@ -185,17 +403,24 @@ struct egl_config_wrapper {
 	egl_config_wrapper(
 		egl_display_wrapper& egl_display,
 		const utki::version_duplet& gl_version,
-		const ruisapp::window_parameters& window_params
+		const ruisapp::window_parameters& window_params,
+		EGLint surface_type = EGL_WINDOW_BIT
 	) :
 		config([&]() {
-			EGLConfig egl_config = nullptr;
+			ruisapp::startup_profile::scope profile_scope(ruisapp::startup_phase::config_choice);
 
-			// Here specify the attributes of the desired configuration.
-			// Below, we select an EGLConfig with at least 8 bits per color
-			// component compatible with on-screen windows.
-			const std::array<EGLint, 15> attribs = {
+			auto request = make_fb_config_request(
+				window_params, //
+				utki::byte_bits * sizeof(uint16_t) // 16 bits depth buffer is the one guaranteed by OpenGL ES
+			);
+
+			// Here specify the minimal attributes of the desired configuration
+			// compatible with the requested surface type, on-screen windows by default.
+			// The eglChooseConfig() sorts matching configs by its own criteria, e.g. it puts
+			// configs with deeper color buffer first, so the cheapest one is selected afterwards.
+			const std::array<EGLint, 17> attribs = {
 				EGL_SURFACE_TYPE,
-				EGL_WINDOW_BIT,
+				surface_type,
 				EGL_RENDERABLE_TYPE,
 				// We cannot set bits for all OpenGL ES versions because on platforms which do not
 				// support later versions the matching config will not be found by eglChooseConfig().
@@ -208,33 +433,82 @@ struct egl_config_wrapper {
 					return ret;
 				}(),
 				EGL_BLUE_SIZE,
-				8,
+				EGLint(request.blue_bits),
 				EGL_GREEN_SIZE,
-				8,
+				EGLint(request.green_bits),
 				EGL_RED_SIZE,
-				8,
+				EGLint(request.red_bits),
+				EGL_ALPHA_SIZE,
+				EGLint(request.alpha_bits),
 				EGL_DEPTH_SIZE,
-				window_params.buffers.get(ruisapp::buffer::depth) ? int(utki::byte_bits * sizeof(uint16_t)) : 0,
+				EGLint(request.depth_bits),
 				EGL_STENCIL_SIZE,
-				window_params.buffers.get(ruisapp::buffer::stencil) ? utki::byte_bits : 0,
+				EGLint(request.stencil_bits),
 				EGL_NONE
 			};
 
-			// Here, the application chooses the configuration it desires. In this
-			// sample, we have a very simplified selection process, where we pick
-			// the first EGLConfig that matches our criteria.
-			EGLint num_configs = 0;
-			eglChooseConfig(
-				egl_display.display, //
-				attribs.data(),
-				&egl_config,
-				1,
-				&num_configs
+			std::vector<EGLConfig> egl_configs = [&]() {
+				EGLint num_configs = 0;
+				if (!eglChooseConfig(
+						egl_display.display, //
+						attribs.data(),
+						nullptr,
+						0,
+						&num_configs
+					) ||
+					num_configs <= 0)
+				{
+					throw std::runtime_error("eglChooseConfig() failed, no matching config found");
+				}
+
+				std::vector<EGLConfig> configs(size_t(num_configs), nullptr);
+				eglChooseConfig(
+					egl_display.display, //
+					attribs.data(),
+					configs.data(),
+					num_configs,
+					&num_configs
+				);
+				configs.resize(size_t(std::max(num_configs, 0)));
+				return configs;
+			}();
+
+			std::vector<fb_config_attribs> candidates;
+			candidates.reserve(egl_configs.size());
+			for (auto c : egl_configs) {
+				auto get_attrib = [&](EGLint attrib) {
+					EGLint value = 0;
+					eglGetConfigAttrib(
+						egl_display.display, //
+						c,
+						attrib,
+						&value
+					);
+					return value;
+				};
+
+				candidates.push_back({
+					.red_bits = unsigned(get_attrib(EGL_RED_SIZE)),
+					.green_bits = unsigned(get_attrib(EGL_GREEN_SIZE)),
+					.blue_bits = unsigned(get_attrib(EGL_BLUE_SIZE)),
+					.alpha_bits = unsigned(get_attrib(EGL_ALPHA_SIZE)),
+					.depth_bits = unsigned(get_attrib(EGL_DEPTH_SIZE)),
+					.stencil_bits = unsigned(get_attrib(EGL_STENCIL_SIZE)),
+					.num_samples = get_attrib(EGL_SAMPLE_BUFFERS) == 0 ? 0 : unsigned(get_attrib(EGL_SAMPLES)),
+					.slow = get_attrib(EGL_CONFIG_CAVEAT) == EGL_SLOW_CONFIG
+				});
+			}
+
+			auto selected = select_fb_config(
+				request, //
+				candidates
 			);
-			if (num_configs <= 0) {
+			if (!selected.has_value()) {
 				throw std::runtime_error("eglChooseConfig() failed, no matching config found");
 			}
 
+			auto egl_config = egl_configs[selected.value()];
+
 			utki::assert(egl_config, SL);
 
 			return egl_config;
@@ -303,6 +577,93 @@ struct egl_surface_wrapper {
 		);
 	}
 
+private:
+	// reused between frames to avoid memory allocations
+	std::vector<EGLint> egl_rects;
+
+	void set_egl_rects(utki::span<const r4::rectangle<int>> rects)
+	{
+		this->egl_rects.clear();
+		for (const auto& r : rects) {
+			this->egl_rects.push_back(r.p.x());
+			this->egl_rects.push_back(r.p.y());
+			this->egl_rects.push_back(r.d.x());
+			this->egl_rects.push_back(r.d.y());
+		}
+	}
+
+public:
+	/**
+	 * @brief Swap frame buffers telling which regions have changed.
+	 * Falls back to swapping without damage information if neither
+	 * EGL_KHR_swap_buffers_with_damage nor EGL_EXT_swap_buffers_with_damage is supported.
+	 * @param damage - changed regions, with origin at bottom left corner of the surface.
+	 */
+	void swap_frame_buffers(utki::span<const r4::rectangle<int>> damage)
+	{
+		if (!this->egl_display.swap_buffers_with_damage || damage.empty()) {
+			this->swap_frame_buffers();
+			return;
+		}
+
+		this->set_egl_rects(damage);
+
+		this->egl_display.swap_buffers_with_damage(
+			this->egl_display.display, //
+			this->surface,
+			this->egl_rects.data(),
+			EGLint(damage.size())
+		);
+	}
+
+	/**
+	 * @brief Get age of the back buffer.
+	 * @return Age of the back buffer as defined by EGL_EXT_buffer_age.
+	 * @return 0 if the back buffer contents are undefined or buffer age query is not supported.
+	 */
+	unsigned get_buffer_age()
+	{
+		const auto& exts = this->egl_display.extensions;
+		if (!exts.get(egl::extension::ext_buffer_age) && !exts.get(egl::extension::khr_partial_update)) {
+			return 0;
+		}
+
+		EGLint age = 0;
+		if (eglQuerySurface(
+				this->egl_display.display, //
+				this->surface,
+				EGL_BUFFER_AGE_EXT,
+				&age
+			) == EGL_FALSE)
+		{
+			return 0;
+		}
+
+		return unsigned(std::max(age, 0));
+	}
+
+	/**
+	 * @brief Set region of the back buffer which is going to be repainted.
+	 * Does nothing if EGL_KHR_partial_update is not supported.
+	 * Must be called after get_buffer_age() and before any rendering to the back buffer.
+	 * @param region - the region to repaint, with origin at bottom left corner of the surface.
+	 */
+	void set_repaint_region(const r4::rectangle<int>& region)
+	{
+		if (!this->egl_display.set_damage_region) {
+			return;
+		}
+
+		this->set_egl_rects(utki::make_span(&region, 1));
+
+		this->egl_display.set_damage_region(
+			this->egl_display.display, //
+			this->surface,
+			this->egl_rects.data(),
+			1
+		);
+	}
+
 	r4::vector2<unsigned> get_dims()
 	{
 		EGLint width = 0;
@@ -329,15 +690,25 @@ namespace {
 struct egl_pbuffer_surface_wrapper {
 	egl_display_wrapper& egl_display;
 
+	const r4::vector2<unsigned> dims;
+
 	const EGLSurface surface;
 
 	egl_pbuffer_surface_wrapper(
 		egl_display_wrapper& egl_display, //
-		const egl_config_wrapper& egl_config
+		const egl_config_wrapper& egl_config,
+		r4::vector2<unsigned> dims = {0, 0}
 	) :
 		egl_display(egl_display),
+		dims(dims),
 		surface([&]() {
-			const std::array<EGLint, 1> attribs = {EGL_NONE};
+			const std::array<EGLint, 5> attribs = {
+				EGL_WIDTH,
+				EGLint(this->dims.x()),
+				EGL_HEIGHT,
+				EGLint(this->dims.y()),
+				EGL_NONE
+			};
 
 			auto s = eglCreatePbufferSurface(
 				this->egl_display.display, //
@@ -386,6 +757,8 @@ struct egl_context_wrapper {
 	) :
 		egl_display(egl_display),
 		context([&]() {
+			ruisapp::startup_profile::scope profile_scope(ruisapp::startup_phase::context_creation);
+
 			auto graphics_api_version = [&ver = gl_version]() {
 				if (ver.to_uint32_t() == 0) {
 					// default OpenGL ES version is 2.0
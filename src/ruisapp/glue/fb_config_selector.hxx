@@ -0,0 +1,173 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <algorithm>
+#include <optional>
+#include <tuple>
+
+#include <utki/span.hpp>
+#include <utki/util.hpp>
+
+#include "../window.hpp"
+
+namespace {
+/**
+ * @brief Framebuffer configuration attributes.
+ * Used both to describe the requested framebuffer and the candidate framebuffer configurations
+ * reported by the graphics API, e.g. GLX or EGL.
+ */
+struct fb_config_attribs {
+	unsigned red_bits = 0;
+	unsigned green_bits = 0;
+	unsigned blue_bits = 0;
+	unsigned alpha_bits = 0;
+	unsigned depth_bits = 0;
+	unsigned stencil_bits = 0;
+
+	// 0 means no multisampling
+	unsigned num_samples = 0;
+
+	// the config is marked as slow by the graphics API, e.g. not hardware accelerated
+	bool slow = false;
+};
+
+/**
+ * @brief Make requested framebuffer configuration out of window parameters.
+ * @param window_params - window parameters.
+ * @param default_depth_bits - depth buffer precision to use if window_parameters::depth_bits is 0.
+ * @return Requested framebuffer configuration.
+ */
+inline fb_config_attribs make_fb_config_request(
+	const ruisapp::window_parameters& window_params, //
+	unsigned default_depth_bits
+)
+{
+	return {
+		.red_bits = utki::byte_bits,
+		.green_bits = utki::byte_bits,
+		.blue_bits = utki::byte_bits,
+		.alpha_bits = window_params.alpha_bits,
+		.depth_bits = [&]() -> unsigned {
+			if (!window_params.buffers.get(ruisapp::buffer::depth)) {
+				return 0;
+			}
+			if (window_params.depth_bits == 0) {
+				return default_depth_bits;
+			}
+			return window_params.depth_bits;
+		}(),
+		.stencil_bits = window_params.buffers.get(ruisapp::buffer::stencil) ? unsigned(utki::byte_bits) : 0,
+		// 1 sample per pixel is same as no multisampling
+		.num_samples = window_params.num_samples <= 1 ? 0 : window_params.num_samples
+	};
+}
+
+/**
+ * @brief Select the cheapest framebuffer configuration satisfying the request.
+ * The configuration satisfies the request if each of its buffers has at least the requested precision.
+ * Configurations marked as slow are only selected if there are no other satisfying ones,
+ * even if that means getting less multisample samples than requested.
+ * Among the satisfying configurations the one with the least multisample samples, then the least
+ * color, depth and stencil bits is selected. If the requested number of multisample samples is not supported,
+ * then the configuration with the greatest number of samples lower than requested is selected.
+ * In case there are several equally cheap configurations, the first one of them is selected,
+ * so the selection is deterministic.
+ * @param request - requested framebuffer configuration.
+ * @param candidates - attributes of available framebuffer configurations.
+ * @return Index of the selected configuration in the candidates list.
+ * @return std::nullopt if none of the configurations satisfies the request.
+ */
+inline std::optional<size_t> select_fb_config(
+	const fb_config_attribs& request, //
+	utki::span<const fb_config_attribs> candidates
+)
+{
+	auto satisfies = [&](const fb_config_attribs& c) {
+		return c.red_bits >= request.red_bits && //
+			c.green_bits >= request.green_bits && //
+			c.blue_bits >= request.blue_bits && //
+			c.alpha_bits >= request.alpha_bits && //
+			c.depth_bits >= request.depth_bits && //
+			c.stencil_bits >= request.stencil_bits;
+	};
+
+	auto cost = [](const fb_config_attribs& c) {
+		return std::make_tuple(
+			c.slow, //
+			c.num_samples,
+			c.red_bits + c.green_bits + c.blue_bits + c.alpha_bits,
+			c.depth_bits,
+			c.stencil_bits
+		);
+	};
+
+	// among the configs having less than requested number of samples,
+	// prefer not slow config, then more samples, then cheaper config
+	auto is_better_fallback = [&cost](const fb_config_attribs& a, const fb_config_attribs& b) {
+		if (a.slow != b.slow) {
+			return !a.slow;
+		}
+		if (a.num_samples != b.num_samples) {
+			return a.num_samples > b.num_samples;
+		}
+		return cost(a) < cost(b);
+	};
+
+	std::optional<size_t> best;
+
+	// best among the configs having less than requested number of samples
+	std::optional<size_t> best_fallback;
+
+	for (size_t i = 0; i != candidates.size(); ++i) {
+		const auto& c = candidates[i];
+
+		if (!satisfies(c)) {
+			continue;
+		}
+
+		if (c.num_samples >= request.num_samples) {
+			if (!best || cost(c) < cost(candidates[best.value()])) {
+				best = i;
+			}
+		} else {
+			if (!best_fallback) {
+				best_fallback = i;
+				continue;
+			}
+			if (is_better_fallback(c, candidates[best_fallback.value()])) {
+				best_fallback = i;
+			}
+		}
+	}
+
+	if (best && best_fallback && candidates[best.value()].slow && !candidates[best_fallback.value()].slow) {
+		// not slow config with less samples is preferred over the slow one
+		return best_fallback;
+	}
+
+	if (best) {
+		return best;
+	}
+	return best_fallback;
+}
+} // namespace
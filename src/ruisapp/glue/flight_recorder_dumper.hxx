@@ -0,0 +1,160 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <atomic>
+#include <charconv>
+#include <csignal>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string_view>
+#include <system_error>
+#include <thread>
+
+#include <pthread.h>
+
+#include "../flight_recorder.hpp"
+
+namespace {
+/**
+ * @brief Dumps the flight recorder on fatal errors and, optionally, on a signal.
+ * The signal to dump on is set with the RUISAPP_FLIGHT_RECORDER_SIGNAL environment variable,
+ * e.g. USR1, SIGUSR2 or a signal number. In case the variable is not set, no signal is intercepted.
+ * The signal is received with sigwait() by a dedicated thread, so the dump is not done
+ * from within a signal handler. For that the signal is blocked on the thread which creates the dumper,
+ * so the object must be created at the beginning of main(), before any other threads are started,
+ * to make all the threads inherit the signal mask.
+ */
+class flight_recorder_dumper
+{
+	// std::terminate() handler is a plain function, so it cannot capture the previous handler
+	inline static std::terminate_handler previous_terminate_handler = nullptr;
+
+	constexpr static auto signal_env_var = "RUISAPP_FLIGHT_RECORDER_SIGNAL";
+
+	// 0 in case no dump signal is set
+	int dump_signal = 0;
+
+	sigset_t signal_set{};
+	sigset_t previous_signal_mask{};
+
+	std::atomic_bool quit_flag{false};
+
+	// receives the dump signal, not started in case no dump signal is set
+	std::thread thread;
+
+	static void on_terminate()
+	{
+		ruisapp::flight_recorder::inst().dump();
+
+		if (previous_terminate_handler) {
+			previous_terminate_handler();
+		}
+		std::abort();
+	}
+
+	// returns 0 in case the dump signal is not set or is invalid
+	static int get_dump_signal()
+	{
+		using namespace std::string_view_literals;
+
+		// NOLINTNEXTLINE(concurrency-mt-unsafe, "called before any other threads are started")
+		auto env_value = std::getenv(signal_env_var);
+		if (!env_value) {
+			return 0;
+		}
+
+		std::string_view value(env_value);
+		if (value.substr(0, 3) == "SIG"sv) {
+			value.remove_prefix(3);
+		}
+
+		if (value == "USR1"sv) {
+			return SIGUSR1;
+		} else if (value == "USR2"sv) {
+			return SIGUSR2;
+		}
+
+		int signal = 0;
+		auto res = std::from_chars(value.data(), value.data() + value.size(), signal);
+		if (res.ec == std::errc() && res.ptr == value.data() + value.size() && signal > 0 && signal < NSIG) {
+			return signal;
+		}
+
+		std::clog << "ruisapp: invalid " << signal_env_var << " value: " << env_value << std::endl;
+		return 0;
+	}
+
+public:
+	flight_recorder_dumper()
+	{
+		// construct the recorder on this thread, as it reads environment variables
+		ruisapp::flight_recorder::inst();
+
+		previous_terminate_handler = std::set_terminate(&on_terminate);
+
+		this->dump_signal = get_dump_signal();
+		if (this->dump_signal == 0) {
+			return;
+		}
+
+		sigemptyset(&this->signal_set);
+		sigaddset(&this->signal_set, this->dump_signal);
+		pthread_sigmask(SIG_BLOCK, &this->signal_set, &this->previous_signal_mask);
+
+		this->thread = std::thread([this]() {
+			for (;;) {
+				int signal = 0;
+				if (sigwait(&this->signal_set, &signal) != 0) {
+					return;
+				}
+				if (this->quit_flag.load()) {
+					return;
+				}
+				ruisapp::flight_recorder::inst().dump();
+			}
+		});
+	}
+
+	flight_recorder_dumper(const flight_recorder_dumper&) = delete;
+	flight_recorder_dumper& operator=(const flight_recorder_dumper&) = delete;
+
+	flight_recorder_dumper(flight_recorder_dumper&&) = delete;
+	flight_recorder_dumper& operator=(flight_recorder_dumper&&) = delete;
+
+	~flight_recorder_dumper()
+	{
+		std::set_terminate(previous_terminate_handler);
+
+		if (this->dump_signal == 0) {
+			return;
+		}
+
+		this->quit_flag.store(true);
+		pthread_kill(this->thread.native_handle(), this->dump_signal);
+		this->thread.join();
+
+		pthread_sigmask(SIG_SETMASK, &this->previous_signal_mask, nullptr);
+	}
+};
+} // namespace
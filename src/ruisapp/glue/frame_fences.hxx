@@ -0,0 +1,149 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <utki/debug.hpp>
+
+namespace {
+/**
+ * @brief Limiter of frames in flight.
+ * Inserts a fence after each presented frame and waits for the oldest fences,
+ * so that the GPU is not processing more than a given number of presented frames at the same time,
+ * while the CPU can already work on the next frame.
+ * @tparam fence_api_type - graphics API specific fence functions. Must provide:
+ *                          - fence_type - fence object type;
+ *                          - bool is_supported() - whether fences are supported;
+ *                          - fence_type insert() - insert a fence into the command stream, returns
+ *                            value-initialized fence_type in case of failure;
+ *                          - void wait(fence_type, std::chrono::nanoseconds timeout) - wait for the fence
+ *                            to be signalled, but not longer than the timeout;
+ *                          - void destroy(fence_type) - destroy the fence.
+ *                          All the functions are called with the rendering context bound.
+ */
+template <typename fence_api_type>
+class frame_fences
+{
+	using fence_type = typename fence_api_type::fence_type;
+
+	fence_api_type fence_api;
+
+	// oldest fence goes first
+	std::vector<fence_type> fences;
+
+public:
+	/**
+	 * @brief Maximum time to wait for a fence.
+	 * A frame normally completes much faster, the timeout only prevents the UI thread from hanging
+	 * in case the fence is never signalled, e.g. after a GPU reset.
+	 */
+	constexpr static auto wait_timeout = std::chrono::seconds(1);
+
+	frame_fences(fence_api_type fence_api) :
+		fence_api(std::move(fence_api))
+	{}
+
+	frame_fences(const frame_fences&) = delete;
+	frame_fences& operator=(const frame_fences&) = delete;
+
+	frame_fences(frame_fences&&) = delete;
+	frame_fences& operator=(frame_fences&&) = delete;
+
+	~frame_fences()
+	{
+		utki::assert(this->fences.empty(), [](auto& o) {
+			o << "frame_fences::release() must be called with the rendering context bound before destruction";
+		});
+	}
+
+	/**
+	 * @brief Check if there are fences to release.
+	 * @return true if there are fences of frames in flight.
+	 */
+	bool has_fences() const noexcept
+	{
+		return !this->fences.empty();
+	}
+
+	/**
+	 * @brief Destroy fences of all frames in flight without waiting for them.
+	 * Must be called with the rendering context bound.
+	 */
+	void release()
+	{
+		for (auto f : this->fences) {
+			this->fence_api.destroy(f);
+		}
+		this->fences.clear();
+	}
+
+	/**
+	 * @brief Notify that a frame has been presented.
+	 * Inserts a fence for the presented frame and waits until the number of frames in flight
+	 * does not exceed the given maximum.
+	 * Must be called with the rendering context bound.
+	 * @param max_frames_in_flight - maximum number of frames in flight. Value of 0 is treated as 1.
+	 * @return true if the number of frames in flight was limited.
+	 * @return false if fences are not supported or failed to be created, the caller is expected
+	 *         to limit the number of frames in flight by other means, e.g. glFinish().
+	 */
+	bool on_frame_presented(unsigned max_frames_in_flight)
+	{
+		if (!this->fence_api.is_supported()) {
+			return false;
+		}
+
+		auto fence = this->fence_api.insert();
+		if (fence == fence_type{}) {
+			return false;
+		}
+		this->fences.push_back(fence);
+
+		size_t max_fences = std::max(max_frames_in_flight, 1u);
+		if (this->fences.size() <= max_fences) {
+			return true;
+		}
+
+		auto num_to_wait = this->fences.size() - max_fences;
+		// Waiting for the newest of the excess fences is enough, as fences are signalled in order.
+		// In case the wait times out the fences are destroyed anyway, not to block the UI thread any longer.
+		this->fence_api.wait(
+			this->fences[num_to_wait - 1], //
+			wait_timeout
+		);
+
+		auto end = std::next(this->fences.begin(), std::ptrdiff_t(num_to_wait));
+		for (auto i = this->fences.begin(); i != end; ++i) {
+			this->fence_api.destroy(*i);
+		}
+		this->fences.erase(this->fences.begin(), end);
+
+		return true;
+	}
+};
+} // namespace
@@ -0,0 +1,409 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <r4/vector.hpp>
+
+#ifdef RUISAPP_RENDER_OPENGL
+#	include <GL/glew.h>
+
+#elif defined(RUISAPP_RENDER_OPENGLES)
+#	include <GLES3/gl3.h>
+
+#else
+#	error "Unknown graphics API"
+#endif
+
+#include "../window.hpp"
+
+#include "pixel_conversion.hxx"
+
+namespace {
+/**
+ * @brief Asynchronous reader of rendered frames.
+ * Frame pixels are read to a ring of pixel buffer objects, so reading the frame does not wait
+ * for the GPU to finish rendering it. The pixels are taken from the buffer once a fence inserted
+ * after the reading is signalled, i.e. usually a frame or two later. Then the pixels are flipped
+ * to top to bottom row order and converted to the requested pixel format on a worker thread,
+ * which also calls the capture callbacks. In case the callbacks do not keep up with rendering,
+ * delivering a frame waits for the worker thread to catch up, so the memory taken by the frames
+ * waiting for delivery is bounded.
+ * In case pixel buffer objects are not supported, e.g. on OpenGL ES 2, the pixels are read synchronously.
+ * All member functions, except destructor, must be called with the window's rendering context bound.
+ */
+class frame_readback
+{
+	// Readbacks in flight are limited by the ring size, when the ring is full
+	// starting a new readback waits for the oldest one to complete.
+	constexpr static size_t ring_size = 3;
+
+	struct readback {
+		GLuint buffer = 0;
+		size_t buffer_size = 0;
+		GLsync fence = nullptr;
+		r4::vector2<int> dims;
+		std::vector<ruisapp::frame_capture_request> requests;
+	};
+
+	std::array<readback, ring_size> ring;
+
+	// index of the oldest readback in flight
+	size_t oldest = 0;
+	size_t num_in_flight = 0;
+
+	// checked on the first readback
+	std::optional<bool> pbo_supported;
+
+	// Frames waiting for delivery on the worker thread are limited,
+	// when the limit is reached delivering a new frame waits for the worker thread.
+	constexpr static size_t max_queued_frames = 3;
+
+	std::mutex mutex;
+	std::condition_variable cond_var;
+	std::condition_variable dequeued_cond_var;
+	std::deque<std::function<void()>> tasks;
+	bool quit = false;
+
+	// started on the first delivered frame
+	std::thread worker;
+
+	static bool check_pbo_support()
+	{
+#ifdef RUISAPP_RENDER_OPENGL
+		// pixel buffer objects, buffer mapping and fences are all in core OpenGL since 3.2
+		return GLEW_VERSION_3_2 || (GLEW_ARB_pixel_buffer_object && GLEW_ARB_map_buffer_range && GLEW_ARB_sync);
+#elif defined(RUISAPP_RENDER_OPENGLES)
+		// clear errors left by previous GL calls, so that they are not taken for the query error
+		while (glGetError() != GL_NO_ERROR) {
+		}
+
+		// pixel buffer objects are in core OpenGL ES since 3.0,
+		// GL_MAJOR_VERSION query itself is only supported since OpenGL ES 3.0,
+		// on OpenGL ES 2 it fails with GL_INVALID_ENUM
+		GLint major = 0;
+		glGetIntegerv(GL_MAJOR_VERSION, &major);
+		return glGetError() == GL_NO_ERROR && major >= 3;
+#endif
+	}
+
+	void run_worker()
+	{
+		while (true) {
+			std::function<void()> task;
+			{
+				std::unique_lock lock(this->mutex);
+				this->cond_var.wait(lock, [this]() {
+					return this->quit || !this->tasks.empty();
+				});
+				if (this->tasks.empty()) {
+					// quit requested and all frames are delivered
+					return;
+				}
+				task = std::move(this->tasks.front());
+				this->tasks.pop_front();
+			}
+			this->dequeued_cond_var.notify_one();
+			task();
+		}
+	}
+
+	// converts the frame pixels and calls the callbacks on the worker thread
+	void deliver(
+		r4::vector2<int> dims, //
+		std::vector<uint8_t> pixels,
+		std::vector<ruisapp::frame_capture_request> requests
+	)
+	{
+		if (!this->worker.joinable()) {
+			this->worker = std::thread([this]() {
+				this->run_worker();
+			});
+		}
+
+		{
+			std::unique_lock lock(this->mutex);
+			this->dequeued_cond_var.wait(lock, [this]() {
+				return this->tasks.size() < max_queued_frames;
+			});
+			this->tasks.emplace_back([dims, pixels = std::move(pixels), requests = std::move(requests)]() {
+				for (const auto& r : requests) {
+					ruisapp::captured_frame frame{
+						.dims = dims.to<unsigned>(),
+						.format = r.format,
+						.pixels = std::vector<uint8_t>(pixels.size())
+					};
+
+					// pixels are read from framebuffer in RGBA format
+					copy_flipping_vertically(
+						utki::make_span(pixels), //
+						utki::make_span(frame.pixels),
+						size_t(dims.x()),
+						r.format == ruisapp::pixel_format::bgra
+					);
+
+					r.callback(std::move(frame));
+				}
+			});
+		}
+		this->cond_var.notify_one();
+	}
+
+	void complete_oldest()
+	{
+		auto& r = this->ring.at(this->oldest);
+
+		glDeleteSync(r.fence);
+		r.fence = nullptr;
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, r.buffer);
+		const auto* mapped = static_cast<const uint8_t*>(glMapBufferRange(
+			GL_PIXEL_PACK_BUFFER, //
+			0,
+			GLsizeiptr(r.buffer_size),
+			GL_MAP_READ_BIT
+		));
+
+		// the buffer has to be unmapped right away, so copy the pixels out of it
+		std::vector<uint8_t> pixels;
+		if (mapped) {
+			pixels.assign(mapped, std::next(mapped, std::ptrdiff_t(r.buffer_size)));
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		this->oldest = (this->oldest + 1) % ring_size;
+		--this->num_in_flight;
+
+		auto requests = std::move(r.requests);
+		r.requests.clear();
+
+		if (!mapped) {
+			// could not map the buffer, should not normally happen, the frame is lost
+			return;
+		}
+
+		this->deliver(
+			r.dims, //
+			std::move(pixels),
+			std::move(requests)
+		);
+	}
+
+public:
+	/**
+	 * @brief Interval of checking for completion of readbacks in flight when the main loop is idle.
+	 * While frames are rendered the readbacks are checked on every frame. When no more frames are rendered,
+	 * the readbacks still in flight are checked about once per frame period of a 60 Hz display,
+	 * by which time the GPU has normally finished them.
+	 */
+	constexpr static uint32_t idle_poll_interval_ms = 16;
+
+	frame_readback() = default;
+
+	frame_readback(const frame_readback&) = delete;
+	frame_readback& operator=(const frame_readback&) = delete;
+
+	frame_readback(frame_readback&&) = delete;
+	frame_readback& operator=(frame_readback&&) = delete;
+
+	/**
+	 * @brief Destroy the frame reader.
+	 * Waits for the worker thread to deliver the frames already read.
+	 * Readbacks in flight are discarded.
+	 * The GL objects have to be released with release() before destruction.
+	 */
+	~frame_readback()
+	{
+		if (this->worker.joinable()) {
+			{
+				std::lock_guard lock(this->mutex);
+				this->quit = true;
+			}
+			this->cond_var.notify_one();
+			this->worker.join();
+		}
+	}
+
+	/**
+	 * @brief Check if the frame reader has GL objects to be released.
+	 * @return true if release() has to be called before destruction.
+	 */
+	bool has_gl_objects() const noexcept
+	{
+		return std::any_of(
+			this->ring.begin(), //
+			this->ring.end(),
+			[](const auto& r) {
+				return r.buffer != 0;
+			}
+		);
+	}
+
+	/**
+	 * @brief Release GL objects.
+	 * Readbacks in flight are discarded.
+	 */
+	void release()
+	{
+		for (auto& r : this->ring) {
+			if (r.fence) {
+				glDeleteSync(r.fence);
+				r.fence = nullptr;
+			}
+			if (r.buffer != 0) {
+				glDeleteBuffers(1, &r.buffer);
+				r.buffer = 0;
+				r.buffer_size = 0;
+			}
+			r.requests.clear();
+		}
+		this->oldest = 0;
+		this->num_in_flight = 0;
+	}
+
+	/**
+	 * @brief Start reading the frame from the current framebuffer.
+	 * Called after the frame is rendered and before it is presented.
+	 * @param dims - framebuffer dimensions.
+	 * @param requests - requests to deliver the frame to.
+	 * @return true if there are readbacks in flight.
+	 */
+	bool read(
+		r4::vector2<int> dims, //
+		std::vector<ruisapp::frame_capture_request> requests
+	)
+	{
+		if (!this->pbo_supported.has_value()) {
+			this->pbo_supported = check_pbo_support();
+		}
+
+		const auto size = size_t(dims.x()) * size_t(dims.y()) * 4;
+
+		if (!this->pbo_supported.value()) {
+			std::vector<uint8_t> pixels(size);
+			glReadPixels(
+				0, //
+				0,
+				dims.x(),
+				dims.y(),
+				GL_RGBA,
+				GL_UNSIGNED_BYTE,
+				pixels.data()
+			);
+			this->deliver(
+				dims, //
+				std::move(pixels),
+				std::move(requests)
+			);
+			return false;
+		}
+
+		this->poll();
+
+		if (this->num_in_flight == ring_size) {
+			// the GPU is too far behind, wait for the oldest readback
+			constexpr GLuint64 timeout_ns = 100'000'000;
+			while (glClientWaitSync(
+					   this->ring.at(this->oldest).fence, //
+					   GL_SYNC_FLUSH_COMMANDS_BIT,
+					   timeout_ns
+				   ) == GL_TIMEOUT_EXPIRED)
+			{
+			}
+			this->complete_oldest();
+		}
+
+		auto& r = this->ring.at((this->oldest + this->num_in_flight) % ring_size);
+
+		if (r.buffer == 0) {
+			glGenBuffers(1, &r.buffer);
+		}
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, r.buffer);
+		if (r.buffer_size != size) {
+			glBufferData(
+				GL_PIXEL_PACK_BUFFER, //
+				GLsizeiptr(size),
+				nullptr,
+				GL_STREAM_READ
+			);
+			r.buffer_size = size;
+		}
+
+		// with pixel pack buffer bound the pixels are copied to the buffer without waiting for the GPU
+		glReadPixels(
+			0, //
+			0,
+			dims.x(),
+			dims.y(),
+			GL_RGBA,
+			GL_UNSIGNED_BYTE,
+			nullptr
+		);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		r.fence = glFenceSync(
+			GL_SYNC_GPU_COMMANDS_COMPLETE, //
+			0 // flags, must be 0
+		);
+		r.dims = dims;
+		r.requests = std::move(requests);
+
+		++this->num_in_flight;
+
+		return true;
+	}
+
+	/**
+	 * @brief Deliver frames whose readback has completed.
+	 * Does not wait for the readbacks in flight to complete.
+	 * @return true if there are readbacks still in flight.
+	 */
+	bool poll()
+	{
+		while (this->num_in_flight != 0) {
+			auto status = glClientWaitSync(
+				this->ring.at(this->oldest).fence, //
+				GL_SYNC_FLUSH_COMMANDS_BIT,
+				0 // timeout
+			);
+			if (status == GL_TIMEOUT_EXPIRED) {
+				break;
+			}
+			this->complete_oldest();
+		}
+		return this->num_in_flight != 0;
+	}
+};
+} // namespace
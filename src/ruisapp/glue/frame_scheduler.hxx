@@ -0,0 +1,163 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+
+namespace {
+/**
+ * @brief Frame scheduler aligning frame rendering to display's vblank.
+ * Learns the display refresh period and phase from vblank timestamps of presented frames,
+ * and the CPU time needed to render a frame. Using that, it tells when to start rendering
+ * the next frame so that it is finished just before the next vblank.
+ * Until then the main loop keeps handling input events, so that the frame reflects
+ * the latest input, which cuts input-to-photon latency by up to one refresh period.
+ */
+class frame_scheduler
+{
+public:
+	using clock = std::chrono::steady_clock;
+
+private:
+	// refresh period, zero if not known yet
+	clock::duration period{0};
+
+	// time of the latest observed vblank
+	std::optional<clock::time_point> last_vblank;
+
+	// estimated CPU time needed to render a frame
+	clock::duration frame_cost{0};
+
+	constexpr static auto min_period = std::chrono::milliseconds(2);
+	constexpr static auto max_period = std::chrono::milliseconds(50);
+
+	// extra time to leave before vblank to tolerate timing jitter, e.g. caused by thread scheduling
+	constexpr static auto safety_margin = std::chrono::milliseconds(2);
+
+	// vblank phase extrapolated over longer intervals is not reliable
+	constexpr static auto max_extrapolation = std::chrono::seconds(1);
+
+	// weight of a new sample in the exponential moving averages is 1 / averaging_factor
+	constexpr static auto averaging_factor = 8;
+
+	static bool is_valid_period(clock::duration p) noexcept
+	{
+		return min_period <= p && p <= max_period;
+	}
+
+public:
+	/**
+	 * @brief Set display refresh period.
+	 * Used when the refresh period is reported by the graphics API.
+	 * Otherwise it is learned from vblank timestamps.
+	 * @param refresh_period - refresh period of the display.
+	 */
+	void set_refresh_period(clock::duration refresh_period) noexcept
+	{
+		if (is_valid_period(refresh_period)) {
+			this->period = refresh_period;
+		}
+	}
+
+	/**
+	 * @brief Record timings of a frame presented at vblank.
+	 * @param frame_start - time when rendering of the frame has started.
+	 * @param swap_start - time when the frame was submitted for presenting, i.e. CPU work on the frame was done.
+	 * @param vblank - time when the frame was presented.
+	 */
+	void on_frame_presented(
+		clock::time_point frame_start, //
+		clock::time_point swap_start,
+		clock::time_point vblank
+	) noexcept
+	{
+		// frame cost estimate grows immediately and decays slowly to be on the safe side
+		auto cost = swap_start - frame_start;
+		if (cost > this->frame_cost) {
+			this->frame_cost = cost;
+		} else {
+			this->frame_cost -= (this->frame_cost - cost) / averaging_factor;
+		}
+
+		if (this->last_vblank.has_value()) {
+			auto delta = vblank - this->last_vblank.value();
+			if (this->period == clock::duration::zero()) {
+				if (is_valid_period(delta)) {
+					this->period = delta;
+				}
+			} else {
+				// the interval can span several refresh periods in case some vblanks were missed
+				auto num_periods = (delta + this->period / 2) / this->period;
+				if (num_periods > 0) {
+					auto measured = delta / num_periods;
+					// ignore outliers, e.g. caused by the UI thread being preempted
+					if (std::chrono::abs(measured - this->period) < this->period / averaging_factor) {
+						this->period += (measured - this->period) / averaging_factor;
+					}
+				}
+			}
+		}
+		this->last_vblank = vblank;
+	}
+
+	/**
+	 * @brief Forget the vblank phase.
+	 * To be called when a frame was presented without waiting for vblank,
+	 * e.g. vsync got disabled.
+	 */
+	void reset_phase() noexcept
+	{
+		this->last_vblank.reset();
+	}
+
+	/**
+	 * @brief Get time when rendering of the next frame should start.
+	 * @param now - current time.
+	 * @return Time point to start rendering at, not earlier than now.
+	 */
+	clock::time_point get_frame_start_time(clock::time_point now) const noexcept
+	{
+		if (this->period == clock::duration::zero() || !this->last_vblank.has_value()) {
+			return now;
+		}
+
+		auto last = this->last_vblank.value();
+		if (now - last > max_extrapolation) {
+			return now;
+		}
+
+		auto lead = this->frame_cost + safety_margin;
+		if (lead >= this->period) {
+			// frame rendering does not fit into the refresh period, render as soon as possible
+			return now;
+		}
+
+		// find the first vblank which can be made if starting rendering now
+		auto num_periods = (now + lead - last) / this->period + 1;
+		auto next_vblank = last + num_periods * this->period;
+
+		return std::max(next_vblank - lead, now);
+	}
+};
+} // namespace
@@ -0,0 +1,97 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+
+#include "../flight_recorder.hpp"
+#include "../frame_statistics.hpp"
+
+namespace {
+/**
+ * @brief Lap timer for main loop iteration phases.
+ * Each lap() call adds the time elapsed since the previous lap() or skip() call,
+ * or since construction, to the given phase duration.
+ * Main loop phases are also recorded to the flight recorder.
+ */
+class frame_timer
+{
+	using clock = std::chrono::steady_clock;
+
+	ruisapp::frame_statistics::sample loop_sample;
+
+	clock::time_point mark = clock::now();
+
+	static std::optional<ruisapp::trace_event> to_trace_event(ruisapp::frame_phase phase) noexcept
+	{
+		switch (phase) {
+			case ruisapp::frame_phase::update:
+				return ruisapp::trace_event::update;
+			case ruisapp::frame_phase::ui_queue_drain:
+				return ruisapp::trace_event::ui_queue_drain;
+			case ruisapp::frame_phase::event_dispatch:
+				return ruisapp::trace_event::event_dispatch;
+			default:
+				// render and swap are recorded by the window
+				return std::nullopt;
+		}
+	}
+
+public:
+	void lap(ruisapp::frame_phase phase) noexcept
+	{
+		auto now = clock::now();
+		this->loop_sample.durations[phase] +=
+			std::chrono::duration_cast<ruisapp::frame_statistics::duration_type>(now - this->mark);
+
+		if (auto event = to_trace_event(phase)) {
+			ruisapp::flight_recorder::inst().record(
+				event.value(), //
+				this->mark,
+				now
+			);
+		}
+
+		this->mark = now;
+	}
+
+	// record the duration if it is longer than already recorded one for the phase
+	void record_max(ruisapp::frame_phase phase, clock::duration duration) noexcept
+	{
+		auto& d = this->loop_sample.durations[phase];
+		d = std::max(d, std::chrono::duration_cast<ruisapp::frame_statistics::duration_type>(duration));
+	}
+
+	// restart lap time measurement without recording the elapsed time
+	void skip() noexcept
+	{
+		this->mark = clock::now();
+	}
+
+	const ruisapp::frame_statistics::sample& get_sample() const noexcept
+	{
+		return this->loop_sample;
+	}
+};
+} // namespace
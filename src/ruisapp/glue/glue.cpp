@@ -33,6 +33,9 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #	ifdef RUISAPP_BACKEND_WAYLAND
 // NOLINTNEXTLINE(bugprone-suspicious-include)
 #		include "linux/wayland/glue.cxx"
+#	elif defined(RUISAPP_BACKEND_HEADLESS)
+// NOLINTNEXTLINE(bugprone-suspicious-include)
+#		include "linux/headless/glue.cxx"
 #	else
 // NOLINTNEXTLINE(bugprone-suspicious-include)
 #		include "linux/xorg/glue.cxx"
@@ -0,0 +1,138 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+
+#include "wakeup_waitable.hxx"
+
+namespace {
+/**
+ * @brief Lock-free queue passing events from an input thread to the UI thread.
+ * Single producer, single consumer bounded ring buffer. Each event is stamped with
+ * the time it was received from the display server.
+ * The queue is a waitable which becomes ready to read when events are pushed to an empty queue,
+ * so the consumer is woken up once per batch of events rather than for each event.
+ * @tparam event_type - event type, must be default constructible and copyable.
+ * @tparam capacity - maximal number of events in the queue, must be a power of 2.
+ */
+template <typename event_type, size_t capacity = 1024> // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+class input_event_queue : public wakeup_waitable
+{
+	static_assert((capacity & (capacity - 1)) == 0, "capacity must be a power of 2");
+
+public:
+	using clock = std::chrono::steady_clock;
+
+	struct timestamped_event {
+		event_type event;
+		clock::time_point receive_time;
+	};
+
+private:
+	std::array<timestamped_event, capacity> ring;
+
+	// written by producer only
+	std::atomic_size_t tail{0};
+
+	// written by consumer only
+	std::atomic_size_t head{0};
+
+	// whether the waitable is signalled and not yet cleared by the consumer
+	std::atomic_bool wakeup_pending{false};
+
+public:
+	/**
+	 * @brief Check if the queue has space for another event.
+	 * To be called by the producer thread.
+	 * @return true if the next push() will succeed.
+	 */
+	bool is_full() const noexcept
+	{
+		return this->tail.load(std::memory_order_relaxed) - this->head.load(std::memory_order_acquire) == capacity;
+	}
+
+	/**
+	 * @brief Push event to the queue.
+	 * To be called by the producer thread.
+	 * @param event - event to push.
+	 * @param receive_time - time when the event was received from the display server.
+	 * @return true if the event was pushed.
+	 * @return false if the queue is full.
+	 */
+	bool push(const event_type& event, clock::time_point receive_time) noexcept
+	{
+		auto t = this->tail.load(std::memory_order_relaxed);
+		if (t - this->head.load(std::memory_order_acquire) == capacity) {
+			return false;
+		}
+
+		this->ring[t % capacity] = {
+			.event = event, //
+			.receive_time = receive_time
+		};
+		this->tail.store(t + 1, std::memory_order_release);
+
+		// signal the waitable only if consumer has not been signalled yet
+		if (!this->wakeup_pending.exchange(true, std::memory_order_seq_cst)) {
+			this->set();
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Acknowledge wakeup.
+	 * To be called by the consumer thread when the waitable was triggered, before popping the events.
+	 */
+	void acknowledge_wakeup() noexcept
+	{
+		// clear the waitable before resetting the flag, otherwise a wakeup signalled in between would be lost
+		this->clear();
+		this->wakeup_pending.store(false, std::memory_order_seq_cst);
+
+		// make sure the events pushed before the flag was reset are seen by the following pop_front() calls
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+	}
+
+	/**
+	 * @brief Pop event from the queue.
+	 * To be called by the consumer thread.
+	 * @return Popped event.
+	 * @return std::nullopt if the queue is empty.
+	 */
+	std::optional<timestamped_event> pop_front() noexcept
+	{
+		auto h = this->head.load(std::memory_order_relaxed);
+		if (h == this->tail.load(std::memory_order_acquire)) {
+			return std::nullopt;
+		}
+
+		auto ret = this->ring[h % capacity];
+		this->head.store(h + 1, std::memory_order_release);
+		return ret;
+	}
+};
+} // namespace
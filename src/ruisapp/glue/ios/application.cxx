@@ -21,6 +21,7 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #include "application.hxx"
 
+
 namespace {
 ruis::real get_dots_per_inch()
 {
@@ -90,12 +91,7 @@ app_window& application_glue::make_window(ruisapp::window_parameters window_para
 	auto ruis_context = utki::make_shared<ruis::context>(ruis::context::parameters{
 		.post_to_ui_thread_function =
 			[](std::function<void()> procedure) {
-				auto p = reinterpret_cast<NSInteger>(new std::function<void()>(std::move(procedure)));
-
-				dispatch_async(dispatch_get_main_queue(), ^{
-				  std::unique_ptr<std::function<void()>> m(reinterpret_cast<std::function<void()>*>(p));
-				  (*m)();
-				});
+				ruisapp::inst().post_to_ui_thread(std::move(procedure));
 			},
 		.updater = this->updater,
 		.renderer = utki::make_shared<ruis::render::renderer>(
@@ -149,12 +145,47 @@ void ruisapp::application::quit() noexcept
 	// TODO:
 }
 
+void ruisapp::application::post_to_ui_thread(
+	ui_procedure_type procedure, //
+	[[maybe_unused]] ui_priority priority
+)
+{
+	// this backend has a single UI queue lane, so the priority is ignored
+	auto p = reinterpret_cast<NSInteger>(new ui_procedure_type(std::move(procedure)));
+
+	dispatch_async(dispatch_get_main_queue(), ^{
+	  std::unique_ptr<ui_procedure_type> m(reinterpret_cast<ui_procedure_type*>(p));
+	  (*m)();
+	});
+}
+
+ruisapp::application::ui_queue_metrics ruisapp::application::get_ui_queue_metrics()
+{
+	// the metrics are not collected by this backend
+	return {};
+}
+
 ruisapp::window& ruisapp::application::make_window_internal(ruisapp::window_parameters window_params)
 {
 	auto& glue = get_glue(*this);
 	return glue.make_window(std::move(window_params));
 }
 
+ruisapp::window& ruisapp::application::make_window_async(
+	window_parameters window_params, //
+	on_window_ready_function_type on_ready
+)
+{
+	// window creation is synchronous on this backend, so the window is ready right away
+	auto& win = this->make_window(std::move(window_params));
+
+	if (on_ready) {
+		on_ready(win);
+	}
+
+	return win;
+}
+
 void ruisapp::application::destroy_window(ruisapp::window& w)
 {
 	utki::assert(
@@ -165,3 +196,12 @@ void ruisapp::application::destroy_window(ruisapp::window& w)
 		SL
 	);
 }
+
+void ruisapp::application::load_resources_async(
+	[[maybe_unused]] load_function_type load, //
+	[[maybe_unused]] on_loaded_function_type on_loaded
+)
+{
+	// this backend has no resource loading thread, loading synchronously instead would block the UI thread
+	throw std::logic_error("application::load_resources_async(): not supported on this backend");
+}
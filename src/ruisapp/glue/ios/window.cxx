@@ -38,7 +38,7 @@ void handle_mouse_button(
 		return;
 	}
 
-	win->gui.send_mouse_button(
+	win->send_mouse_button(
 		action, //
 		pos,
 		button,
@@ -60,7 +60,7 @@ void handle_mouse_move(
 		return;
 	}
 
-	win->gui.send_mouse_move(pos, pointer_id);
+	win->send_mouse_move(pos, pointer_id);
 }
 } // namespace
 
@@ -163,7 +163,7 @@ void handle_mouse_move(
 
 	// TODO: for optimization, check if rect has changed
 	// set the GL viewport
-	self->window->gui.set_viewport(content_rect);
+	self->window->set_viewport(content_rect);
 
 	auto& glue = get_glue();
 	glue.render();
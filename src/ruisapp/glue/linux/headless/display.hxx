@@ -0,0 +1,42 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include "../../egl_utils.hxx"
+
+namespace {
+struct display_wrapper {
+	egl_display_wrapper egl_display;
+
+	display_wrapper() :
+		egl_display(egl::headless_display_tag{})
+	{}
+
+	display_wrapper(const display_wrapper&) = delete;
+	display_wrapper& operator=(const display_wrapper&) = delete;
+
+	display_wrapper(display_wrapper&&) = delete;
+	display_wrapper& operator=(display_wrapper&&) = delete;
+
+	~display_wrapper() = default;
+};
+} // namespace
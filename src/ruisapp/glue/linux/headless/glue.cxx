@@ -0,0 +1,510 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include <atomic>
+#include <map>
+#include <vector>
+
+#include <opros/wait_set.hpp>
+#include <ruis/render/opengles/context.hpp>
+
+#include "../../../application.hpp"
+#include "../../../flight_recorder.hpp"
+#include "../../../startup_profile.hpp"
+#include "../../flight_recorder_dumper.hxx"
+#include "../../frame_readback.hxx"
+#include "../../frame_timer.hxx"
+#include "../../prioritized_procedure_queue.hxx"
+#include "../../resource_loading_thread.hxx"
+#include "../../shared_gl_resources.hxx"
+#include "../../unix_common.hxx"
+#include "../../update_deadline.hxx"
+#include "../../wakeup_waitable.hxx"
+
+#include "display.hxx"
+#include "window.hxx"
+
+using namespace ruisapp;
+
+namespace {
+class app_window : public ruisapp::window
+{
+public:
+	utki::shared_ref<native_window> ruis_native_window;
+
+	app_window(
+		utki::shared_ref<ruis::context> ruis_context, //
+		utki::shared_ref<native_window> ruis_native_window
+	) :
+		ruisapp::window(std::move(ruis_context)),
+		ruis_native_window(std::move(ruis_native_window))
+	{
+		utki::assert(
+			[&]() {
+				ruis::render::native_window& w1 = this->ruis_native_window.get();
+				ruis::render::native_window& w2 = this->gui.context.get().window();
+				return &w1 == &w2;
+			},
+			SL
+		);
+	}
+
+	app_window(const app_window&) = delete;
+	app_window& operator=(const app_window&) = delete;
+
+	app_window(app_window&&) = delete;
+	app_window& operator=(app_window&&) = delete;
+
+	~app_window() override
+	{
+		// the frame reader's buffers have to be deleted with the window's rendering context bound
+		if (this->readback.has_gl_objects()) {
+			this->gui.context.get().ren().ctx().apply([this]() {
+				this->readback.release();
+			});
+		}
+	}
+
+private:
+	frame_readback readback;
+
+	unsigned get_back_buffer_age() override
+	{
+		return this->ruis_native_window.get().get_buffer_age();
+	}
+
+	void set_repaint_region(const r4::rectangle<int>& region) override
+	{
+		this->ruis_native_window.get().set_repaint_region(region);
+	}
+
+	void swap_frame_buffers(utki::span<const r4::rectangle<int>> damage) override
+	{
+		this->ruis_native_window.get().swap_frame_buffers(damage);
+	}
+
+	bool is_frame_capture_supported() const noexcept override
+	{
+		return true;
+	}
+
+	bool start_frame_readback(
+		r4::vector2<int> dims, //
+		std::vector<ruisapp::frame_capture_request> requests
+	) override
+	{
+		return this->readback.read(
+			dims, //
+			std::move(requests)
+		);
+	}
+
+	bool poll_frame_readbacks() override
+	{
+		return this->readback.poll();
+	}
+};
+} // namespace
+
+namespace {
+class application_glue : public utki::destructable
+{
+public:
+	const utki::shared_ref<display_wrapper> display = []() {
+		ruisapp::startup_profile::scope profile_scope(ruisapp::startup_phase::display_open);
+		return utki::make_shared<display_wrapper>();
+	}();
+
+private:
+	utki::version_duplet gl_version;
+
+	utki::shared_ref<offscreen_context> shared_gl_context;
+	async_shared_gl_resources shared_gl_resources;
+
+	std::map<
+		native_window::window_id_type, //
+		utki::shared_ref<app_window> //
+		>
+		windows;
+
+public:
+	std::vector<utki::shared_ref<app_window>> windows_to_destroy;
+
+	application_glue(const utki::version_duplet& gl_version) :
+		gl_version(gl_version),
+		shared_gl_context( //
+			utki::make_shared<offscreen_context>(
+				this->display, //
+				this->gl_version,
+				nullptr // no shared gl context
+			)
+		),
+		shared_gl_resources(
+			[this]() -> utki::shared_ref<ruis::render::context> {
+				return utki::make_shared<ruis::render::opengles::context>(this->shared_gl_context);
+			},
+			[this]() {
+				this->shared_gl_context.get().unbind_rendering_context();
+			}
+		)
+	{}
+
+	prioritized_procedure_queue<wakeup_waitable> ui_queue;
+
+	std::atomic_bool quit_flag = false;
+
+	utki::shared_ref<ruis::updater> updater = utki::make_shared<ruis::updater>();
+
+private:
+	// Created on first use. Declared after ui_queue, because the loading thread posts to the ui_queue.
+	std::optional<resource_loading_thread> resource_loading;
+
+public:
+	resource_loading_thread& get_resource_loading_thread()
+	{
+		if (this->resource_loading.has_value()) {
+			return this->resource_loading.value();
+		}
+
+		// the loading thread's GL context, the context shares GL objects with all windows
+		auto c = utki::make_shared<offscreen_context>(
+			this->display, //
+			this->gl_version,
+			&this->shared_gl_context.get()
+		);
+
+		return this->resource_loading.emplace(
+			[c]() -> utki::shared_ref<ruis::render::context> {
+				return utki::make_shared<ruis::render::opengles::context>(c);
+			},
+			[c]() {
+				c.get().unbind_rendering_context();
+			},
+			[this](std::function<void()> proc) {
+				this->ui_queue.push_back(std::move(proc));
+			}
+		);
+	}
+
+	app_window& make_window(ruisapp::window_parameters window_params)
+	{
+		auto ruis_native_window = utki::make_shared<native_window>(
+			this->display, //
+			this->gl_version,
+			window_params,
+			this->shared_gl_context.get()
+		);
+
+		// the native window is created, now wait for the shared GL resources to be ready
+		const auto& shared_res = this->shared_gl_resources.get();
+
+		auto ruis_context = utki::make_shared<ruis::context>(ruis::context::parameters{
+			.post_to_ui_thread_function =
+				[this](std::function<void()> proc) {
+					this->ui_queue.push_back(std::move(proc));
+				},
+			.updater = this->updater,
+			.renderer = utki::make_shared<ruis::render::renderer>(
+				utki::make_shared<ruis::render::opengles::context>(ruis_native_window),
+				shared_res.common_shaders,
+				shared_res.common_render_objects
+			),
+			.style_provider = shared_res.ruis_style_provider
+		});
+
+		auto ruisapp_window = utki::make_shared<app_window>(
+			std::move(ruis_context), //
+			std::move(ruis_native_window)
+		);
+
+		ruisapp_window.get().set_viewport( //
+			ruis::rect(
+				0, //
+				0,
+				ruis::real(window_params.dims.x()),
+				ruis::real(window_params.dims.y())
+			)
+		);
+
+		auto res = this->windows.insert( //
+			std::make_pair(
+				ruisapp_window.get().ruis_native_window.get().get_id(), //
+				std::move(ruisapp_window)
+			)
+		);
+		utki::assert(res.second, SL);
+
+		return res.first->second.get();
+	}
+
+	void destroy_window(app_window& w)
+	{
+		auto i = this->windows.find(w.ruis_native_window.get().get_id());
+		utki::assert(i != this->windows.end(), SL);
+
+		// Defer actual window object destruction until next main loop cycle,
+		// for that put the window to the list of windows to destroy.
+		this->windows_to_destroy.push_back(i->second);
+
+		this->windows.erase(i);
+	}
+
+	void render()
+	{
+		for (const auto& w : this->windows) {
+			auto& win = w.second.get();
+			if (win.is_render_needed()) {
+				win.render();
+			}
+		}
+	}
+
+	void invalidate_all_implicitly()
+	{
+		for (const auto& w : this->windows) {
+			w.second.get().invalidate_implicitly();
+		}
+	}
+
+	// deliver captured frames whose readback has completed, returns true if there are readbacks still in flight
+	bool process_frame_captures()
+	{
+		bool in_flight = false;
+		for (const auto& w : this->windows) {
+			if (w.second.get().process_frame_captures()) {
+				in_flight = true;
+			}
+		}
+		return in_flight;
+	}
+
+	void push_frame_statistics(const ruisapp::frame_statistics::sample& loop_sample)
+	{
+		for (const auto& w : this->windows) {
+			w.second.get().push_frame_statistics(loop_sample);
+		}
+	}
+
+	// get time budget for executing posted procedures
+	ui_queue_budget get_ui_queue_budget() const
+	{
+		auto now = std::chrono::steady_clock::now();
+
+		// there is no display to synchronize to, so a pending frame is rendered on next main loop iteration
+		bool render_needed = std::any_of(
+			this->windows.begin(), //
+			this->windows.end(),
+			[](const auto& w) {
+				return w.second.get().is_render_needed();
+			}
+		);
+
+		if (render_needed) {
+			return {
+				.deadline = now + ui_queue_budget::frame_pending_duration, //
+				.run_idle = false
+			};
+		}
+
+		return {
+			.deadline = now + ui_queue_budget::max_duration, //
+			.run_idle = true
+		};
+	}
+};
+} // namespace
+
+namespace {
+application_glue& get_glue(ruisapp::application& app)
+{
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-static-cast-downcast, "false-positive")
+	return static_cast<application_glue&>(app.pimpl.get());
+}
+} // namespace
+
+application::application(parameters params) :
+	application(
+		{.pimpl = utki::make_unique<application_glue>(params.graphics_api_version), //
+		 .directories = get_application_directories(params.name),
+		 .params = std::move(params)}
+	)
+{}
+
+void application::quit() noexcept
+{
+	auto& glue = get_glue(*this);
+	glue.quit_flag.store(true);
+}
+
+ruisapp::window& application::make_window_internal(window_parameters window_params)
+{
+	auto& glue = get_glue(*this);
+	return glue.make_window(std::move(window_params));
+}
+
+ruisapp::window& application::make_window_async(
+	window_parameters window_params, //
+	on_window_ready_function_type on_ready
+)
+{
+	// window creation is synchronous on this backend, so the window is ready right away
+	auto& win = this->make_window(std::move(window_params));
+
+	if (on_ready) {
+		on_ready(win);
+	}
+
+	return win;
+}
+
+void application::destroy_window(ruisapp::window& w)
+{
+	auto& glue = get_glue(*this);
+
+	utki::assert(dynamic_cast<app_window*>(&w), SL);
+	glue.destroy_window(
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-static-cast-downcast, "assert(dynamic_cast) done")
+		static_cast<app_window&>(w)
+	);
+}
+
+void application::load_resources_async(
+	load_function_type load, //
+	on_loaded_function_type on_loaded
+)
+{
+	auto& glue = get_glue(*this);
+	glue.get_resource_loading_thread().push(
+		std::move(load), //
+		std::move(on_loaded)
+	);
+}
+
+void application::post_to_ui_thread(
+	ui_procedure_type procedure, //
+	ui_priority priority
+)
+{
+	auto& glue = get_glue(*this);
+	glue.ui_queue.push_back(
+		std::move(procedure), //
+		priority
+	);
+}
+
+application::ui_queue_metrics application::get_ui_queue_metrics()
+{
+	auto& glue = get_glue(*this);
+	return glue.ui_queue.get_metrics();
+}
+
+int main(int argc, const char** argv)
+{
+	// must be created before any other threads are started
+	flight_recorder_dumper recorder_dumper;
+
+	auto app = ruisapp::application_factory::make_application(argc, argv);
+	if (!app) {
+		// Not an error. The app just did not show any GUI to the user.
+		return 0;
+	}
+	utki::assert(app, SL);
+
+	auto& glue = get_glue(*app);
+
+	opros::wait_set wait_set(1);
+
+	wait_set.add(glue.ui_queue, {opros::ready::read}, &glue.ui_queue);
+	utki::scope_exit ui_queue_wait_set_scope_exit([&]() {
+		wait_set.remove(glue.ui_queue);
+	});
+
+	update_deadline updater_deadline;
+
+	while (!glue.quit_flag.load()) {
+		glue.windows_to_destroy.clear();
+
+		frame_timer timer;
+
+		// main loop cycle sequence as required by ruis:
+		// - update updateables
+		// - render windows which need it
+		// - wait for events and handle them
+
+		bool update_due = updater_deadline.is_due();
+		auto to_wait_ms = glue.updater.get().update();
+		updater_deadline.set(to_wait_ms);
+		if (update_due) {
+			// updated updateables can change appearance of any window
+			glue.invalidate_all_implicitly();
+		}
+		timer.lap(ruisapp::frame_phase::update);
+
+		glue.render();
+
+		if (glue.process_frame_captures()) {
+			// there is no display to wake up the loop, so poll the readbacks
+			to_wait_ms = std::min(to_wait_ms, frame_readback::idle_poll_interval_ms);
+		}
+
+		// procedures left in the queue due to exhausted time budget do not wake up the wait
+		if (glue.ui_queue.has_pending(glue.get_ui_queue_budget().run_idle)) {
+			to_wait_ms = 0;
+		}
+
+		{
+			ruisapp::flight_recorder::scope trace_scope(
+				ruisapp::trace_event::wait, //
+				to_wait_ms
+			);
+			wait_set.wait(to_wait_ms);
+		}
+		timer.skip();
+
+		auto triggered_events = wait_set.get_triggered();
+
+		bool ui_queue_ready_to_read = false;
+
+		for (auto& ei : triggered_events) {
+			if (ei.user_data == &glue.ui_queue) {
+				ui_queue_ready_to_read = true;
+			}
+		}
+
+		if (ui_queue_ready_to_read || glue.ui_queue.has_pending(true)) {
+			auto drained = glue.ui_queue.drain(glue.get_ui_queue_budget());
+			if (drained.num_executed != 0) {
+				timer.record_max(
+					ruisapp::frame_phase::ui_queue_latency, //
+					drained.max_latency
+				);
+
+				// posted procedures can change appearance of any window
+				glue.invalidate_all_implicitly();
+			}
+		}
+		timer.lap(ruisapp::frame_phase::ui_queue_drain);
+
+		glue.push_frame_statistics(timer.get_sample());
+	}
+
+	return 0;
+}
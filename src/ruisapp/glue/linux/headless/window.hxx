@@ -0,0 +1,196 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <GLES2/gl2.h>
+#include <ruis/render/native_window.hpp>
+
+#include "../../egl_offscreen_context.hxx"
+#include "../../egl_utils.hxx"
+
+#include "display.hxx"
+
+namespace {
+using offscreen_context = egl_offscreen_context<display_wrapper>;
+} // namespace
+
+namespace {
+class native_window : public ruis::render::native_window
+{
+	const utki::shared_ref<display_wrapper> display;
+
+	egl_config_wrapper egl_config;
+	egl_context_wrapper egl_context;
+
+	// offscreen surface the window is rendered to
+	egl_pbuffer_surface_wrapper egl_surface;
+
+public:
+	using window_id_type = unsigned;
+
+	const window_id_type sequence_number = []() {
+		static window_id_type next_sequence_number = 0;
+		auto ret = next_sequence_number;
+		++next_sequence_number;
+		return ret;
+	}();
+
+	native_window(
+		utki::shared_ref<display_wrapper> display, //
+		const utki::version_duplet& gl_version,
+		const ruisapp::window_parameters& window_params,
+		const offscreen_context& shared_context
+	) :
+		display(std::move(display)),
+		egl_config(
+			this->display.get().egl_display, //
+			gl_version,
+			window_params,
+			EGL_PBUFFER_BIT
+		),
+		egl_context(
+			this->display.get().egl_display, //
+			gl_version,
+			this->egl_config,
+			shared_context.get_egl_context()
+		),
+		egl_surface(
+			this->display.get().egl_display, //
+			this->egl_config,
+			window_params.dims
+		)
+	{}
+
+	native_window(const native_window&) = delete;
+	native_window& operator=(const native_window&) = delete;
+
+	native_window(native_window&&) = delete;
+	native_window& operator=(native_window&&) = delete;
+
+	~native_window() override = default;
+
+	window_id_type get_id() const noexcept
+	{
+		return this->sequence_number;
+	}
+
+	r4::vector2<unsigned> get_dims() const noexcept override
+	{
+		return this->egl_surface.dims;
+	}
+
+	void swap_frame_buffers() override
+	{
+		// eglSwapBuffers() has no effect on pbuffer surfaces,
+		// just submit the rendering commands to the GPU
+		glFlush();
+		this->surface_has_contents = true;
+	}
+
+	void swap_frame_buffers([[maybe_unused]] utki::span<const r4::rectangle<int>> damage)
+	{
+		// nobody to pass the damage to
+		this->swap_frame_buffers();
+	}
+
+private:
+	bool surface_has_contents = false;
+
+public:
+	unsigned get_buffer_age() const noexcept
+	{
+		// Pbuffer surface is single-buffered, it always has the contents of the last rendered frame.
+		return this->surface_has_contents ? 1 : 0;
+	}
+
+	void set_repaint_region([[maybe_unused]] const r4::rectangle<int>& region)
+	{
+		// pbuffer surface contents are preserved, no need to tell which region is going to be repainted
+	}
+
+	void bind_rendering_context() override
+	{
+		auto& egl_display = this->display.get().egl_display;
+
+		EGLSurface surface = this->egl_surface.surface;
+
+		if (eglMakeCurrent(
+				egl_display.display, //
+				surface,
+				surface,
+				this->egl_context.context
+			) == EGL_FALSE)
+		{
+			throw std::runtime_error(utki::cat(
+				"eglMakeCurrent() failed, error: ", //
+				egl_error_to_string(eglGetError())
+			));
+		}
+	}
+
+	bool is_rendering_context_bound() const noexcept override
+	{
+		return eglGetCurrentContext() == this->egl_context.context;
+	}
+
+	/**
+	 * @brief Unbind the window's rendering context from the calling thread.
+	 * Waits for all GL commands issued in the context to complete, so that GL objects
+	 * created in the context are ready to be used from shared contexts.
+	 * Does nothing if the window's rendering context is not bound on the calling thread.
+	 */
+	void unbind_rendering_context()
+	{
+		if (!this->is_rendering_context_bound()) {
+			return;
+		}
+		glFinish();
+		eglMakeCurrent(
+			this->display.get().egl_display.display,
+			EGL_NO_SURFACE,
+			EGL_NO_SURFACE,
+			EGL_NO_CONTEXT
+		);
+	}
+
+	void set_vsync_enabled_internal(bool enabled) override
+	{
+		// there is no display to synchronize with, swap interval is ignored for pbuffer surfaces
+		utki::logcat_debug("headless native_window::set_vsync_enabled_internal(", enabled, "): ignored", '\n');
+	}
+
+	void set_fullscreen_internal(bool enable) override
+	{
+		// no display, nothing to do
+	}
+
+	void set_mouse_cursor(ruis::mouse_cursor c) override
+	{
+		// no display, nothing to do
+	}
+
+	void set_mouse_cursor_visible(bool visible) override
+	{
+		// no display, nothing to do
+	}
+};
+} // namespace
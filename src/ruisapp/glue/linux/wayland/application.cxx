@@ -23,6 +23,8 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #include <ruis/widget/widget.hpp>
 
+#include "../../../flight_recorder.hpp"
+
 #ifdef RUISAPP_RENDER_OPENGL
 #	include <ruis/render/opengl/context.hpp>
 
@@ -39,6 +41,12 @@ void app_window::resize(const r4::vector2<uint32_t>& dims)
 		o << "resize window to " << std::dec << dims << std::endl;
 	});
 
+	ruisapp::flight_recorder::inst().record_instant(
+		ruisapp::trace_event::window_resize, //
+		dims.x(),
+		dims.y()
+	);
+
 	auto& natwin = this->ruis_native_window.get();
 
 	natwin.resize(dims);
@@ -47,12 +55,14 @@ void app_window::resize(const r4::vector2<uint32_t>& dims)
 	units.set_dots_per_pp(natwin.get_scale());
 	units.set_dots_per_inch(natwin.get_dpi());
 
-	this->gui.set_viewport( //
+	this->set_viewport( //
 		ruis::rect(
 			0, //
 			dims.to<ruis::real>() * natwin.get_scale()
 		)
 	);
+
+	this->invalidate();
 }
 
 void app_window::refresh_dimensions()
@@ -105,6 +115,12 @@ void app_window::wl_surface_frame_done(
 
 void app_window::schedule_rendering()
 {
+	if (!this->ruis_native_window.get().is_egl_surface_created()) {
+		// The window was created asynchronously and has not been configured yet.
+		// The first frame will be rendered after the configure event.
+		return;
+	}
+
 	if (this->frame_callback) {
 		// rendering is already scheduled, do nothing
 
@@ -116,7 +132,9 @@ void app_window::schedule_rendering()
 		return;
 	}
 
-	// TODO: render only if needed
+	if (!this->is_render_needed()) {
+		return;
+	}
 
 	this->frame_callback = this->ruis_native_window.get().make_frame_callback();
 
@@ -128,14 +146,17 @@ void app_window::schedule_rendering()
 
 	// After requesting frame callback we need to tell Wayland that our window is dirty,
 	// otherwise it will not call the frame callback.
-	this->ruis_native_window.get().mark_dirty();
+	this->ruis_native_window.get().mark_dirty(utki::make_span(this->get_damage()));
 
 	// utki::logcat_debug("app_window::schedule_rendering(): scheduled", '\n');
 }
 
 ruisapp::application::application(parameters params) :
 	application(
-		{.pimpl = utki::make_unique<application_glue>(params.graphics_api_version), //
+		{.pimpl = utki::make_unique<application_glue>(
+			 params.graphics_api_version, //
+			 params.dedicated_input_thread
+		 ), //
 		 .directories = get_application_directories(params.name),
 		 .params = std::move(params)}
 	)
@@ -153,6 +174,31 @@ ruisapp::window& ruisapp::application::make_window_internal(window_parameters wi
 	return glue.make_window(std::move(window_params));
 }
 
+ruisapp::window& ruisapp::application::make_window_async(
+	window_parameters window_params, //
+	on_window_ready_function_type on_ready
+)
+{
+	startup_profile::scope profile_scope(startup_phase::make_window);
+
+	auto& glue = get_glue(*this);
+	return glue.make_window_async(
+		std::move(window_params), //
+		[on_ready = std::move(on_ready)](app_window& w) {
+			// By choice, the VSYNC is enabled by default, same as for windows created with make_window().
+			// The window's EGL surface has to be bound for that.
+			auto& ren_ctx = w.gui.context.get().ren().ctx();
+			ren_ctx.apply([&]() {
+				ren_ctx.set_vsync_enabled(true);
+			});
+
+			if (on_ready) {
+				on_ready(w);
+			}
+		}
+	);
+}
+
 void ruisapp::application::destroy_window(ruisapp::window& w)
 {
 	auto& glue = get_glue(*this);
@@ -164,17 +210,32 @@ void ruisapp::application::destroy_window(ruisapp::window& w)
 	);
 }
 
-ruisapp::window& application_glue::make_window(ruisapp::window_parameters window_params)
+void ruisapp::application::load_resources_async(
+	load_function_type load, //
+	on_loaded_function_type on_loaded
+)
 {
-	utki::logcat_debug("application_glue::make_window(): enter", '\n');
+	auto& glue = get_glue(*this);
+	glue.get_resource_loading_thread().push(
+		std::move(load), //
+		std::move(on_loaded)
+	);
+}
+
+app_window& application_glue::create_window(ruisapp::window_parameters window_params)
+{
+	utki::logcat_debug("application_glue::create_window(): enter", '\n');
 
 	auto ruis_native_window = utki::make_shared<native_window>(
 		this->display, //
 		this->gl_version,
 		window_params,
-		&this->shared_gl_context_native_window.get()
+		this->shared_gl_context.get()
 	);
 
+	// the native window is created, now wait for the shared GL resources to be ready
+	const auto& shared_res = this->shared_gl_resources.get();
+
 	auto ruis_context = utki::make_shared<ruis::context>(ruis::context::parameters{
 		.post_to_ui_thread_function =
 			[this](std::function<void()> proc) {
@@ -189,10 +250,10 @@ ruisapp::window& application_glue::make_window(ruisapp::window_parameters window
 #else
 #	error "Unknown graphics API"
 #endif
-			this->common_shaders,
-			this->common_render_objects
+			shared_res.common_shaders,
+			shared_res.common_render_objects
 		),
-		.style_provider = this->ruis_style_provider
+		.style_provider = shared_res.ruis_style_provider
 	});
 
 	auto ruisapp_window = utki::make_shared<app_window>(
@@ -200,7 +261,7 @@ ruisapp::window& application_glue::make_window(ruisapp::window_parameters window
 		std::move(ruis_native_window)
 	);
 
-	ruisapp_window.get().gui.set_viewport( //
+	ruisapp_window.get().set_viewport( //
 		ruis::rect(
 			0, //
 			0,
@@ -217,7 +278,12 @@ ruisapp::window& application_glue::make_window(ruisapp::window_parameters window
 	);
 	utki::assert(res.second, SL);
 
-	auto& ret_win = res.first->second.get();
+	return res.first->second.get();
+}
+
+app_window& application_glue::make_window(ruisapp::window_parameters window_params)
+{
+	auto& ret_win = this->create_window(std::move(window_params));
 
 	// EGL surface for the window is not created yet at this point.
 	// In Wayland the EGL surface is created asynchronously.
@@ -238,6 +304,20 @@ ruisapp::window& application_glue::make_window(ruisapp::window_parameters window
 	return ret_win;
 }
 
+app_window& application_glue::make_window_async(
+	ruisapp::window_parameters window_params, //
+	std::function<void(app_window&)> on_ready
+)
+{
+	auto& ret_win = this->create_window(std::move(window_params));
+
+	// The EGL surface will be created by the xdg_surface configure event handler
+	// when the event arrives, which will also call the on_ready.
+	ret_win.on_ready = std::move(on_ready);
+
+	return ret_win;
+}
+
 void application_glue::destroy_window(app_window& w)
 {
 	auto i = this->windows.find(w.ruis_native_window.get().get_id());
@@ -261,4 +341,81 @@ void application_glue::render()
 		// guarantees that the eglSwapBuffers() will not be blocked.
 		w.second.get().schedule_rendering();
 	}
+}
+
+void application_glue::invalidate_all_implicitly()
+{
+	for (const auto& w : this->windows) {
+		w.second.get().invalidate_implicitly();
+	}
+}
+
+void application_glue::flush_coalesced_input()
+{
+	for (const auto& w : this->windows) {
+		w.second.get().flush_coalesced_input();
+	}
+}
+
+bool application_glue::process_frame_captures()
+{
+	bool in_flight = false;
+	for (const auto& w : this->windows) {
+		if (w.second.get().process_frame_captures()) {
+			in_flight = true;
+		}
+	}
+	return in_flight;
+}
+
+void application_glue::push_frame_statistics(const ruisapp::frame_statistics::sample& loop_sample)
+{
+	for (const auto& w : this->windows) {
+		w.second.get().push_frame_statistics(loop_sample);
+	}
+}
+
+ui_queue_budget application_glue::get_ui_queue_budget() const
+{
+	auto now = std::chrono::steady_clock::now();
+
+	// The compositor decides when the frame is to be rendered, so the frame deadline is not known.
+	// In case a frame is pending, keep the budget short to be ready for the frame callback.
+	bool frame_pending = std::any_of(
+		this->windows.begin(), //
+		this->windows.end(),
+		[](const auto& w) {
+			return w.second.get().is_frame_pending();
+		}
+	);
+
+	if (frame_pending) {
+		return {
+			.deadline = now + ui_queue_budget::frame_pending_duration, //
+			.run_idle = false
+		};
+	}
+
+	return {
+		.deadline = now + ui_queue_budget::max_duration, //
+		.run_idle = true
+	};
+}
+
+void ruisapp::application::post_to_ui_thread(
+	ui_procedure_type procedure, //
+	ui_priority priority
+)
+{
+	auto& glue = get_glue(*this);
+	glue.ui_queue.push_back(
+		std::move(procedure), //
+		priority
+	);
+}
+
+ruisapp::application::ui_queue_metrics ruisapp::application::get_ui_queue_metrics()
+{
+	auto& glue = get_glue(*this);
+	return glue.ui_queue.get_metrics();
 }
\ No newline at end of file
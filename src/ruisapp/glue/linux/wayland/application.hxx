@@ -24,12 +24,17 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #include <atomic>
 #include <map>
 
-#include <nitki/queue.hpp>
-
 #include "../../../application.hpp"
+#include "../../../startup_profile.hpp"
 #include "../../../window.hpp"
+#include "../../frame_readback.hxx"
+#include "../../prioritized_procedure_queue.hxx"
+#include "../../resource_loading_thread.hxx"
+#include "../../shared_gl_resources.hxx"
 #include "../../unix_common.hxx"
+#include "../../wakeup_waitable.hxx"
 
+#include "input_thread.hxx"
 #include "window.hxx"
 
 namespace {
@@ -46,6 +51,10 @@ public:
 
 	utki::shared_ref<native_window> ruis_native_window;
 
+	// Called once the window is ready, i.e. its EGL surface has been created
+	// by the first xdg_surface configure event. Set in case the window was created asynchronously.
+	std::function<void(app_window&)> on_ready;
+
 	app_window(
 		utki::shared_ref<ruis::context> ruis_context, //
 		utki::shared_ref<native_window> ruis_native_window
@@ -76,6 +85,14 @@ public:
 		if (this->frame_callback) {
 			wl_callback_destroy(this->frame_callback);
 		}
+
+		// GL objects of the window are released while the window's rendering context still exists
+		if (this->readback.has_gl_objects() || this->ruis_native_window.get().has_frame_fences()) {
+			this->gui.context.get().ren().ctx().apply([this]() {
+				this->readback.release();
+				this->ruis_native_window.get().release_frame_fences();
+			});
+		}
 	}
 
 	void resize(const r4::vector2<uint32_t>& dims);
@@ -86,9 +103,17 @@ public:
 
 	void schedule_rendering();
 
+	// whether the window is going to render a frame soon
+	bool is_frame_pending() const noexcept
+	{
+		return this->frame_callback || this->is_render_needed();
+	}
+
 private:
 	wl_callback* frame_callback = nullptr;
 
+	frame_readback readback;
+
 	static void wl_surface_frame_done(
 		void* data, //
 		struct wl_callback* callback,
@@ -96,6 +121,42 @@ private:
 	);
 
 	static const constexpr wl_callback_listener wl_surface_frame_listener = {.done = &wl_surface_frame_done};
+
+	unsigned get_back_buffer_age() override
+	{
+		return this->ruis_native_window.get().get_buffer_age();
+	}
+
+	void set_repaint_region(const r4::rectangle<int>& region) override
+	{
+		this->ruis_native_window.get().set_repaint_region(region);
+	}
+
+	void swap_frame_buffers(utki::span<const r4::rectangle<int>> damage) override
+	{
+		this->ruis_native_window.get().swap_frame_buffers(damage);
+	}
+
+	bool is_frame_capture_supported() const noexcept override
+	{
+		return true;
+	}
+
+	bool start_frame_readback(
+		r4::vector2<int> dims, //
+		std::vector<ruisapp::frame_capture_request> requests
+	) override
+	{
+		return this->readback.read(
+			dims, //
+			std::move(requests)
+		);
+	}
+
+	bool poll_frame_readbacks() override
+	{
+		return this->readback.poll();
+	}
 };
 } // namespace
 
@@ -103,11 +164,14 @@ namespace {
 class application_glue : public utki::destructable
 {
 public:
-	const utki::shared_ref<display_wrapper> display = utki::make_shared<display_wrapper>();
+	const utki::shared_ref<display_wrapper> display = []() {
+		ruisapp::startup_profile::scope profile_scope(ruisapp::startup_phase::display_open);
+		return utki::make_shared<display_wrapper>();
+	}();
 
 	std::atomic_bool quit_flag = false;
 
-	nitki::queue ui_queue;
+	prioritized_procedure_queue<wakeup_waitable> ui_queue;
 
 	class wayland_waitable : public opros::waitable
 	{
@@ -125,13 +189,8 @@ public:
 
 	const utki::version_duplet gl_version;
 
-	// TODO: make windowless shared egl context
-	const utki::shared_ref<native_window> shared_gl_context_native_window;
-	const utki::shared_ref<ruis::render::context> resource_loader_ruis_rendering_context;
-	const utki::shared_ref<const ruis::render::context::shaders> common_shaders;
-	const utki::shared_ref<const ruis::render::renderer::objects> common_render_objects;
-	const utki::shared_ref<ruis::resource_loader> ruis_resource_loader;
-	const utki::shared_ref<ruis::style_provider> ruis_style_provider;
+	const utki::shared_ref<offscreen_context> shared_gl_context;
+	async_shared_gl_resources shared_gl_resources;
 
 private:
 	std::map<
@@ -143,58 +202,92 @@ private:
 public:
 	std::vector<utki::shared_ref<app_window>> windows_to_destroy;
 
-	native_window::window_id_type get_shared_gl_context_window_id() const noexcept
-	{
-		return this->shared_gl_context_native_window.get().get_id();
-	}
+	// reads wayland events in case the dedicated input thread is enabled
+	std::optional<wayland_input_thread> input_thread;
+
+private:
+	// Created on first use. Declared last, so that the loading thread is stopped before anything else is destroyed.
+	std::optional<resource_loading_thread> resource_loading;
 
-	application_glue(const utki::version_duplet& gl_version) :
+public:
+	application_glue(
+		const utki::version_duplet& gl_version, //
+		bool dedicated_input_thread
+	) :
 		waitable(this->display.get().wayland_display),
 		gl_version(gl_version),
-		shared_gl_context_native_window( //
-			utki::make_shared<native_window>(
+		shared_gl_context( //
+			utki::make_shared<offscreen_context>(
 				this->display, //
 				this->gl_version,
-				ruisapp::window_parameters{
-					.dims = {1, 1},
-					.title = {},
-					.fullscreen = false
-    },
 				nullptr // no shared gl context
 			)
 		),
-		resource_loader_ruis_rendering_context(
+		shared_gl_resources(
+			[this]() -> utki::shared_ref<ruis::render::context> {
 #ifdef RUISAPP_RENDER_OPENGL
-			utki::make_shared<ruis::render::opengl::context>(this->shared_gl_context_native_window)
+				return utki::make_shared<ruis::render::opengl::context>(this->shared_gl_context);
 #elif defined(RUISAPP_RENDER_OPENGLES)
-			utki::make_shared<ruis::render::opengles::context>(this->shared_gl_context_native_window)
+				return utki::make_shared<ruis::render::opengles::context>(this->shared_gl_context);
 #else
 #	error "Unknown graphics API"
 #endif
-		),
-		common_shaders( //
-			[&]() {
-				utki::assert(this->resource_loader_ruis_rendering_context.to_shared_ptr(), SL);
-				return this->resource_loader_ruis_rendering_context.get().make_shaders();
-			}()
-		),
-		common_render_objects( //
-			utki::make_shared<ruis::render::renderer::objects>(this->resource_loader_ruis_rendering_context)
-		),
-		ruis_resource_loader( //
-			utki::make_shared<ruis::resource_loader>(
-				this->resource_loader_ruis_rendering_context, //
-				this->common_render_objects
-			)
-		),
-		ruis_style_provider( //
-			utki::make_shared<ruis::style_provider>(this->ruis_resource_loader)
+			},
+			[this]() {
+				this->shared_gl_context.get().unbind_rendering_context();
+			}
 		)
-	{}
+	{
+		if (dedicated_input_thread) {
+			this->input_thread.emplace(this->display.get().wayland_display.display);
+		}
+	}
+
+	app_window& make_window(ruisapp::window_parameters window_params);
+
+	// create window without waiting for its EGL surface to be created, see app_window::on_ready
+	app_window& make_window_async(
+		ruisapp::window_parameters window_params, //
+		std::function<void(app_window&)> on_ready
+	);
+
+	// common part of make_window() and make_window_async()
+	app_window& create_window(ruisapp::window_parameters window_params);
 
-	ruisapp::window& make_window(ruisapp::window_parameters window_params);
 	void destroy_window(app_window& w);
 
+	resource_loading_thread& get_resource_loading_thread()
+	{
+		if (this->resource_loading.has_value()) {
+			return this->resource_loading.value();
+		}
+
+		// the loading thread's GL context, the context shares GL objects with all windows
+		auto c = utki::make_shared<offscreen_context>(
+			this->display, //
+			this->gl_version,
+			&this->shared_gl_context.get()
+		);
+
+		return this->resource_loading.emplace(
+			[c]() -> utki::shared_ref<ruis::render::context> {
+#ifdef RUISAPP_RENDER_OPENGL
+				return utki::make_shared<ruis::render::opengl::context>(c);
+#elif defined(RUISAPP_RENDER_OPENGLES)
+				return utki::make_shared<ruis::render::opengles::context>(c);
+#else
+#	error "Unknown graphics API"
+#endif
+			},
+			[c]() {
+				c.get().unbind_rendering_context();
+			},
+			[this](std::function<void()> proc) {
+				this->ui_queue.push_back(std::move(proc));
+			}
+		);
+	}
+
 	app_window* get_window(native_window::window_id_type id)
 	{
 		auto i = this->windows.find(id);
@@ -206,6 +299,19 @@ public:
 
 	// render all windows if needed
 	void render();
+
+	void invalidate_all_implicitly();
+
+	// send input events coalesced within the last batch of wayland events to the windows' GUI
+	void flush_coalesced_input();
+
+	// deliver captured frames whose readback has completed, returns true if there are readbacks still in flight
+	bool process_frame_captures();
+
+	void push_frame_statistics(const ruisapp::frame_statistics::sample& loop_sample);
+
+	// get time budget for executing posted procedures
+	ui_queue_budget get_ui_queue_budget() const;
 };
 } // namespace
 
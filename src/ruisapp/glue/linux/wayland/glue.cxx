@@ -20,10 +20,10 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 /* ================ LICENSE END ================ */
 
 #include <atomic>
+#include <chrono>
 #include <map>
 
 #include <fsif/native_file.hpp>
-#include <nitki/queue.hpp>
 #include <opros/wait_set.hpp>
 #include <wayland-client-core.h>
 #include <wayland-client-protocol.h>
@@ -43,7 +43,11 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #endif
 
 #include "../../../application.hpp"
+#include "../../../flight_recorder.hpp"
+#include "../../flight_recorder_dumper.hxx"
+#include "../../frame_timer.hxx"
 #include "../../unix_common.hxx"
+#include "../../update_deadline.hxx"
 
 #include "application.hxx"
 
@@ -66,6 +70,9 @@ using namespace ruisapp;
 // NOLINTNEXTLINE(bugprone-exception-escape, "it's what we want")
 int main(int argc, const char** argv)
 {
+	// must be created before any other threads are started
+	flight_recorder_dumper recorder_dumper;
+
 	auto application = ruisapp::application_factory::make_application(argc, argv);
 	if (!application) {
 		// Not an error. The app just did not show any GUI to the user.
@@ -93,6 +100,8 @@ int main(int argc, const char** argv)
 		wait_set.remove(glue.waitable);
 	});
 
+	update_deadline updater_deadline;
+
 	while (!glue.quit_flag.load()) {
 		// utki::log_debug([](auto&o){
 		// 	static unsigned counter = 0;
@@ -102,18 +111,46 @@ int main(int argc, const char** argv)
 
 		glue.windows_to_destroy.clear();
 
+		frame_timer timer;
+
 		// main loop cycle sequence as required by ruis:
 		// - update updateables
-		// - render
+		// - render windows which need it
 		// - wait for events and handle them
 
+		bool update_due = updater_deadline.is_due();
 		auto to_wait_ms = glue.updater.get().update();
+		updater_deadline.set(to_wait_ms);
+		if (update_due) {
+			// updated updateables can change appearance of any window
+			glue.invalidate_all_implicitly();
+		}
+		timer.lap(ruisapp::frame_phase::update);
 		// std::cout << "updated" << std::endl;
 		glue.render();
 		// std::cout << "rendered" << std::endl;
 
+		if (glue.process_frame_captures()) {
+			// captured frames are delivered even if no more frames are rendered
+			to_wait_ms = std::min(to_wait_ms, frame_readback::idle_poll_interval_ms);
+		}
+		timer.skip();
+
 		auto& disp = glue.display.get().wayland_display.display;
 
+		auto on_dispatched = [&]() {
+			if (!glue.input_thread.has_value()) {
+				return;
+			}
+			// let the input thread continue reading events and account for the events it has read
+			if (auto read_time = glue.input_thread.value().on_dispatched()) {
+				timer.record_max(
+					ruisapp::frame_phase::input_latency, //
+					std::chrono::steady_clock::now() - read_time.value()
+				);
+			}
+		};
+
 		// prepare wayland queue for waiting for events
 		while (wl_display_prepare_read(disp) != 0) {
 			// utki::log_debug([](auto&o){
@@ -130,7 +167,11 @@ int main(int argc, const char** argv)
 					strerror(errno)
 				));
 			}
+			on_dispatched();
 		}
+		// in case the seat does not send pointer frame events
+		glue.flush_coalesced_input();
+		timer.lap(ruisapp::frame_phase::event_dispatch);
 
 		{
 			utki::scope_exit scope_exit_wayland_prepare_read([&]() {
@@ -161,9 +202,21 @@ int main(int argc, const char** argv)
 				);
 			}
 
+			// procedures left in the queue due to exhausted time budget do not wake up the wait
+			if (glue.ui_queue.has_pending(glue.get_ui_queue_budget().run_idle)) {
+				to_wait_ms = 0;
+			}
+
 			// std::cout << "wait for " << to_wait_ms << "ms" << std::endl;
 
-			wait_set.wait(to_wait_ms);
+			{
+				ruisapp::flight_recorder::scope trace_scope(
+					ruisapp::trace_event::wait, //
+					to_wait_ms
+				);
+				wait_set.wait(to_wait_ms);
+			}
+			timer.skip();
 
 			// std::cout << "waited" << std::endl;
 
@@ -198,14 +251,19 @@ int main(int argc, const char** argv)
 				}
 			}
 
-			if (ui_queue_ready_to_read) {
-				while (auto m = glue.ui_queue.pop_front()) {
-					utki::log_debug([](auto& o) {
-						o << "loop proc" << std::endl;
-					});
-					m();
+			if (ui_queue_ready_to_read || glue.ui_queue.has_pending(true)) {
+				auto drained = glue.ui_queue.drain(glue.get_ui_queue_budget());
+				if (drained.num_executed != 0) {
+					timer.record_max(
+						ruisapp::frame_phase::ui_queue_latency, //
+						drained.max_latency
+					);
+
+					// posted procedures can change appearance of any window
+					glue.invalidate_all_implicitly();
 				}
 			}
+			timer.lap(ruisapp::frame_phase::ui_queue_drain);
 
 			if (wayland_queue_ready_to_read) {
 				scope_exit_wayland_prepare_read.release();
@@ -225,8 +283,13 @@ int main(int argc, const char** argv)
 						strerror(errno)
 					));
 				}
+				on_dispatched();
+				glue.flush_coalesced_input();
 			}
+			timer.lap(ruisapp::frame_phase::event_dispatch);
 		}
+
+		glue.push_frame_statistics(timer.get_sample());
 	}
 
 	return 0;
@@ -0,0 +1,171 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include <poll.h>
+#include <utki/debug.hpp>
+#include <utki/util.hpp>
+#include <wayland-client-core.h>
+
+#include "../../input_event_queue.hxx"
+
+namespace {
+/**
+ * @brief Thread reading Wayland events as soon as they arrive.
+ * The thread takes part in the libwayland's multithreaded reading protocol, see wl_display_prepare_read().
+ * So, the events are read from the connection even when the UI thread is busy, e.g. rendering a long frame.
+ * The read events are queued to the display's default event queue and are dispatched
+ * by the UI thread as usual, because the event handlers are to be run on the UI thread.
+ */
+class wayland_input_thread
+{
+public:
+	using clock = std::chrono::steady_clock;
+
+private:
+	wl_display* const display;
+
+	wakeup_waitable stop_signal;
+	std::atomic_bool quit{false};
+
+	std::mutex mutex;
+	std::condition_variable cond_var;
+
+	// set by the UI thread when it has dispatched the queued events
+	bool dispatched = false;
+
+	// time when the oldest not yet dispatched events were read by the input thread
+	std::optional<clock::time_point> read_time;
+
+	std::thread thread;
+
+	void run()
+	{
+		std::array<pollfd, 2> fds{};
+		fds[0] = {.fd = wl_display_get_fd(this->display), .events = POLLIN, .revents = 0};
+		fds[1] = {.fd = this->stop_signal.get_fd(), .events = POLLIN, .revents = 0};
+
+		while (!this->quit.load()) {
+			if (wl_display_prepare_read(this->display) != 0) {
+				// there are read events in the queue, wait until the UI thread dispatches them
+				std::unique_lock lock(this->mutex);
+				this->cond_var.wait(lock, [this]() {
+					return this->dispatched || this->quit.load();
+				});
+				this->dispatched = false;
+				continue;
+			}
+
+			utki::scope_exit cancel_read_scope_exit([this]() {
+				wl_display_cancel_read(this->display);
+			});
+
+			if (poll(
+					fds.data(), //
+					fds.size(),
+					-1 // wait infinitely
+				) < 0)
+			{
+				utki::assert(errno == EINTR, SL);
+				continue;
+			}
+
+			if (fds[1].revents != 0) {
+				// stop requested
+				return;
+			}
+
+			if (fds[0].revents == 0) {
+				continue;
+			}
+
+			{
+				// stamp the events before reading, so that the UI thread cannot dispatch them before they are stamped
+				std::lock_guard lock(this->mutex);
+				if (!this->read_time.has_value()) {
+					this->read_time = clock::now();
+				}
+			}
+
+			cancel_read_scope_exit.release();
+
+			// In case the UI thread has also prepared to read, this call blocks until the UI thread reads the events.
+			if (wl_display_read_events(this->display) < 0) {
+				// connection error, the UI thread will find that out when dispatching the events
+				return;
+			}
+		}
+	}
+
+public:
+	wayland_input_thread(wl_display* display) :
+		display(display),
+		thread([this]() {
+			this->run();
+		})
+	{}
+
+	wayland_input_thread(const wayland_input_thread&) = delete;
+	wayland_input_thread& operator=(const wayland_input_thread&) = delete;
+
+	wayland_input_thread(wayland_input_thread&&) = delete;
+	wayland_input_thread& operator=(wayland_input_thread&&) = delete;
+
+	~wayland_input_thread()
+	{
+		{
+			std::lock_guard lock(this->mutex);
+			this->quit.store(true);
+		}
+		this->cond_var.notify_one();
+		this->stop_signal.set();
+		this->thread.join();
+	}
+
+	/**
+	 * @brief Notify the input thread that the queued events have been dispatched.
+	 * To be called by the UI thread after dispatching the display's default event queue.
+	 * @return Time when the oldest of the dispatched events was read by the input thread.
+	 * @return std::nullopt if none of the dispatched events were read by the input thread.
+	 */
+	std::optional<clock::time_point> on_dispatched()
+	{
+		std::optional<clock::time_point> ret;
+		{
+			std::lock_guard lock(this->mutex);
+			std::swap(ret, this->read_time);
+			this->dispatched = true;
+		}
+		this->cond_var.notify_one();
+		return ret;
+	}
+};
+} // namespace
@@ -64,7 +64,8 @@ void wayland_keyboard_wrapper::wl_keyboard_enter(
 	{
 		// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
 		ruis::key ruis_key = key_code_map[std::uint8_t(key)];
-		win.gui.send_key(
+		win.invalidate_implicitly();
+		win.send_key(
 			ruis::button_action::press, //
 			ruis_key
 		);
@@ -143,7 +144,9 @@ void wayland_keyboard_wrapper::wl_keyboard_key(
 	// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
 	ruis::key ruis_key = key_code_map[std::uint8_t(key)];
 
-	win.gui.send_key(
+	win.flush_coalesced_input();
+	win.invalidate_implicitly();
+	win.send_key(
 		is_pressed ? ruis::button_action::press : ruis::button_action::release, //
 		ruis_key
 	);
@@ -186,7 +189,7 @@ void wayland_keyboard_wrapper::wl_keyboard_key(
 	};
 
 	if (is_pressed) {
-		win.gui.send_character_input(
+		win.send_character_input(
 			unicode_provider(
 				key, //
 				self.xkb
@@ -21,6 +21,8 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #include "wayland_pointer.hxx"
 
+#include <cstdlib>
+
 #include "application.hxx"
 
 namespace {
@@ -129,7 +131,8 @@ void wayland_pointer_wrapper::wl_pointer_enter(
 
 	natwin.update_mouse_cursor();
 
-	win.gui.send_mouse_hover(
+	win.invalidate_implicitly();
+	win.send_mouse_hover(
 		true, //
 		0
 	);
@@ -137,7 +140,7 @@ void wayland_pointer_wrapper::wl_pointer_enter(
 		wl_fixed_to_int(x), //
 		wl_fixed_to_int(y)
 	);
-	win.gui.send_mouse_move(
+	win.send_mouse_move(
 		self.cur_pointer_pos, //
 		0
 	);
@@ -174,7 +177,9 @@ void wayland_pointer_wrapper::wl_pointer_leave(
 		return;
 	}
 
-	window->gui.send_mouse_hover(
+	window->flush_coalesced_input();
+	window->invalidate_implicitly();
+	window->send_mouse_hover(
 		false, //
 		0
 	);
@@ -210,7 +215,9 @@ void wayland_pointer_wrapper::wl_pointer_button(
 		return;
 	}
 
-	window->gui.send_mouse_button(
+	window->flush_coalesced_input();
+	window->invalidate_implicitly();
+	window->send_mouse_button(
 		state == WL_POINTER_BUTTON_STATE_PRESSED ? ruis::button_action::press : ruis::button_action::release, //
 		self.cur_pointer_pos,
 		button_number_to_enum(button),
@@ -229,46 +236,124 @@ void wayland_pointer_wrapper::wl_pointer_axis(
 	utki::assert(data, SL);
 	auto& self = *static_cast<wayland_pointer_wrapper*>(data);
 
-	auto& glue = get_glue();
+	// std::cout << "mouse axis: " << std::dec << axis << ", val = " << wl_fixed_to_double(value) << std::endl;
+
+	if (axis >= self.scroll_axes.size()) {
+		return;
+	}
 
-	// TODO: is it a valid situation that there is no current surface?
-	utki::assert(self.cur_surface, SL);
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+	self.scroll_axes[axis].value += wl_fixed_to_double(value);
 
-	auto window = glue.get_window(self.cur_surface);
+	if (wl_pointer_get_version(pointer) < WL_POINTER_FRAME_SINCE_VERSION) {
+		// no frame events, deliver right away
+		self.flush_frame();
+	}
+}
+
+void wayland_pointer_wrapper::wl_pointer_axis_discrete(
+	void* data, //
+	wl_pointer* pointer,
+	uint32_t axis,
+	int32_t discrete
+)
+{
+	utki::log_debug([&](auto& o) {
+		o << "axis discrete: axis = " << std::dec << axis << ", discrete = " << discrete << std::endl;
+	});
+
+	utki::assert(data, SL);
+	auto& self = *static_cast<wayland_pointer_wrapper*>(data);
+
+	if (axis >= self.scroll_axes.size()) {
+		return;
+	}
+
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+	auto& a = self.scroll_axes[axis];
+	a.discrete += discrete;
+	a.discrete_received = true;
+}
+
+void wayland_pointer_wrapper::wl_pointer_frame(
+	void* data, //
+	wl_pointer* pointer
+)
+{
+	utki::log_debug([](auto& o) {
+		o << "pointer frame" << std::endl;
+	});
+
+	utki::assert(data, SL);
+	auto& self = *static_cast<wayland_pointer_wrapper*>(data);
+
+	self.flush_frame();
+}
+
+void wayland_pointer_wrapper::flush_frame()
+{
+	auto& glue = get_glue();
+
+	auto window = glue.get_window(this->cur_surface);
 	if (!window) {
-		utki::log_debug([](auto& o) {
-			o << "wayland_pointer_wrapper::wl_pointer_axis(): no window for current surface, ignore" << std::endl;
-		});
+		this->scroll_axes = {};
 		return;
 	}
 	auto& win = *window;
 
+	win.flush_coalesced_input();
+
 	// we get +-10 for each mouse wheel step
-	auto val = wl_fixed_to_int(value);
-
-	// std::cout << "mouse axis: " << std::dec << axis << ", val = " << val << std::endl;
-
-	for (unsigned i = 0; i != 2; ++i) {
-		win.gui.send_mouse_button(
-			i == 0 ? ruis::button_action::press : ruis::button_action::release, //
-			self.cur_pointer_pos,
-			[axis, val]() {
-				if (axis == WL_POINTER_AXIS_VERTICAL_SCROLL) {
-					if (val >= 0) {
-						return ruis::mouse_button::wheel_down;
-					} else {
-						return ruis::mouse_button::wheel_up;
-					}
+	constexpr auto wheel_step = 10.0;
+
+	for (unsigned axis = 0; axis != this->scroll_axes.size(); ++axis) {
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+		auto& a = this->scroll_axes[axis];
+
+		int32_t num_steps = 0;
+		if (a.discrete_received) {
+			// wheel steps are reported by the compositor
+			num_steps = a.discrete;
+			a.value = 0;
+		} else {
+			// touchpad or similar, a number of small continuous scroll events make up one wheel step
+			num_steps = int32_t(a.value / wheel_step);
+			a.value -= num_steps * wheel_step;
+		}
+		a.discrete = 0;
+		a.discrete_received = false;
+
+		if (num_steps == 0) {
+			continue;
+		}
+
+		auto button = [&]() {
+			if (axis == WL_POINTER_AXIS_VERTICAL_SCROLL) {
+				if (num_steps > 0) {
+					return ruis::mouse_button::wheel_down;
 				} else {
-					if (val >= 0) {
-						return ruis::mouse_button::wheel_right;
-					} else {
-						return ruis::mouse_button::wheel_left;
-					}
+					return ruis::mouse_button::wheel_up;
 				}
-			}(),
-			0 // pointer id
-		);
+			} else {
+				if (num_steps > 0) {
+					return ruis::mouse_button::wheel_right;
+				} else {
+					return ruis::mouse_button::wheel_left;
+				}
+			}
+		}();
+
+		win.invalidate_implicitly();
+		for (int32_t step = 0; step != std::abs(num_steps); ++step) {
+			for (unsigned i = 0; i != 2; ++i) {
+				win.send_mouse_button(
+					i == 0 ? ruis::button_action::press : ruis::button_action::release, //
+					this->cur_pointer_pos,
+					button,
+					0 // pointer id
+				);
+			}
+		}
 	}
 }
 
@@ -300,7 +385,9 @@ void wayland_pointer_wrapper::wl_pointer_motion(
 	self.cur_pointer_pos = round(pos);
 
 	// std::cout << "mouse move: x,y = " << std::dec << self.cur_pointer_pos << std::endl;
-	win.gui.send_mouse_move(
+
+	// delivered on pointer frame event, or after dispatching wayland events in case there are no frame events
+	win.coalesce_mouse_move(
 		self.cur_pointer_pos, //
 		0
 	);
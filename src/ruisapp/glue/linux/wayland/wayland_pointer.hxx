@@ -21,6 +21,8 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <array>
+
 #include <ruis/config.hpp>
 #include <ruis/util/events.hpp>
 
@@ -36,6 +38,18 @@ struct wayland_pointer_wrapper {
 	// Current pointer position within current surface.
 	ruis::vec2 cur_pointer_pos{0, 0};
 
+	struct scroll_axis {
+		// continuous scroll amount not yet delivered as wheel steps
+		double value = 0;
+
+		// discrete wheel steps received since last pointer frame
+		int32_t discrete = 0;
+		bool discrete_received = false;
+	};
+
+	// scroll state of vertical and horizontal axes, indexed by wl_pointer_axis
+	std::array<scroll_axis, 2> scroll_axes;
+
 	void connect(wl_seat* seat);
 	void disconnect() noexcept;
 
@@ -113,19 +127,28 @@ private:
 		wl_fixed_t value
 	);
 
+	static void wl_pointer_axis_discrete(
+		void* data, //
+		wl_pointer* pointer,
+		uint32_t axis,
+		int32_t discrete
+	);
+
+	static void wl_pointer_frame(
+		void* data, //
+		wl_pointer* pointer
+	);
+
+	// deliver pointer events accumulated since last pointer frame
+	void flush_frame();
+
 	constexpr static const wl_pointer_listener listener = {
 		.enter = &wl_pointer_enter,
 		.leave = &wl_pointer_leave,
 		.motion = &wl_pointer_motion,
 		.button = &wl_pointer_button,
 		.axis = &wl_pointer_axis,
-		.frame =
-			[](void* data, //
-			   wl_pointer* pointer) {
-				utki::log_debug([](auto& o) {
-					o << "pointer frame" << std::endl;
-				});
-			},
+		.frame = &wl_pointer_frame,
 		.axis_source =
 			[](void* data, //
 			   wl_pointer* pointer,
@@ -143,15 +166,7 @@ private:
 					o << "axis stop: axis = " << std::dec << axis << std::endl;
 				});
 			},
-		.axis_discrete =
-			[](void* data, //
-			   wl_pointer* pointer,
-			   uint32_t axis,
-			   int32_t discrete) {
-				utki::log_debug([&](auto& o) {
-					o << "axis discrete: axis = " << std::dec << axis << ", discrete = " << discrete << std::endl;
-				});
-			}
+		.axis_discrete = &wl_pointer_axis_discrete
 	};
 
 	unsigned num_connected = 0;
@@ -54,7 +54,8 @@ public:
 				wayland_registry.registry, //
 				wayland_registry.seat_name.value().name,
 				&wl_seat_interface,
-				std::min(wayland_registry.seat_name.value().version, 1u)
+				// version 5 is needed for wl_pointer.frame events which delimit batches of pointer events
+				std::min(wayland_registry.seat_name.value().version, 5u)
 			);
 			utki::assert(seat, SL);
 			return static_cast<wl_seat*>(seat);
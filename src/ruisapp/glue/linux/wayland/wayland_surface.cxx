@@ -50,7 +50,6 @@ void wayland_surface_wrapper::wl_surface_enter(
 			  << std::endl;
 		});
 		// TODO: this callback is called for some surface, try to figure out what is that surface
-		// utki::assert(surface == glue.get_shared_gl_context_window_id(), SL);
 		return;
 	}
 
@@ -162,16 +161,20 @@ void wayland_surface_wrapper::set_opaque_region(const wayland_region_wrapper& wa
 	);
 }
 
-void wayland_surface_wrapper::damage(const r4::vector2<int32_t>& dims)
+void wayland_surface_wrapper::damage(utki::span<const r4::rectangle<int32_t>> rects)
 {
 	// Use wl_surface_damage_buffer() over wl_surface_damage() as it is the
 	// the modern preferred way fo marking a surface dirty.
-	wl_surface_damage_buffer(
-		this->surface, //
-		0,
-		0,
-		dims.x(),
-		dims.y()
-	);
+	// Damage only the changed regions, so that compositor does not need to
+	// re-composite the whole surface.
+	for (const auto& r : rects) {
+		wl_surface_damage_buffer(
+			this->surface, //
+			r.p.x(),
+			r.p.y(),
+			r.d.x(),
+			r.d.y()
+		);
+	}
 	this->commit();
 }
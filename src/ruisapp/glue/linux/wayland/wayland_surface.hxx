@@ -23,6 +23,9 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #include <set>
 
+#include <r4/rectangle.hpp>
+#include <utki/span.hpp>
+
 #include "wayland_compositor.hxx"
 #include "wayland_region.hxx"
 
@@ -60,7 +63,7 @@ struct wayland_surface_wrapper {
 		wl_surface_commit(this->surface);
 	}
 
-	void damage(const r4::vector2<int32_t>& dims);
+	void damage(utki::span<const r4::rectangle<int32_t>> rects);
 
 	void set_buffer_scale(uint32_t scale);
 	void set_opaque_region(const wayland_region_wrapper& wayland_region);
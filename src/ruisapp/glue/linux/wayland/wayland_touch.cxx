@@ -74,7 +74,9 @@ void wayland_touch_wrapper::wl_touch_down(
 
 	const touch_point& tp = insert_result.first->second;
 
-	win.gui.send_mouse_button(
+	win.flush_coalesced_input();
+	win.invalidate_implicitly();
+	win.send_mouse_button(
 		ruis::button_action::press, //
 		tp.pos,
 		ruis::mouse_button::left,
@@ -105,7 +107,9 @@ void wayland_touch_wrapper::wl_touch_up(
 
 	auto& glue = get_glue();
 	if (auto window = glue.get_window(tp.surface)) {
-		window->gui.send_mouse_button(
+		window->flush_coalesced_input();
+		window->invalidate_implicitly();
+		window->send_mouse_button(
 			ruis::button_action::release, //
 			tp.pos,
 			ruis::mouse_button::left,
@@ -148,13 +152,28 @@ void wayland_touch_wrapper::wl_touch_motion(
 
 		tp.pos = pos;
 
-		window->gui.send_mouse_move(
+		// delivered on touch frame event
+		window->coalesce_mouse_move(
 			tp.pos, //
 			tp.ruis_id
 		);
 	}
 }
 
+// sent after a set of touch events which logically belong together,
+// e.g. motions of all touch points, so the coalesced motions are delivered here
+void wayland_touch_wrapper::wl_touch_frame(
+	void* data, //
+	wl_touch* touch
+)
+{
+	utki::log_debug([](auto& o) {
+		o << "wayland: touch frame event" << std::endl;
+	});
+
+	get_glue().flush_coalesced_input();
+}
+
 // sent when compositor desides that touch gesture is going on, so
 // all touch points become invalid and must be cancelled. No further
 // events will be sent by wayland for current touch points.
@@ -182,7 +201,9 @@ void wayland_touch_wrapper::wl_touch_cancel(
 			continue;
 		}
 
-		window->gui.send_mouse_button(
+		window->flush_coalesced_input();
+		window->invalidate_implicitly();
+		window->send_mouse_button(
 			ruis::button_action::release, //
 			{-1, -1},
 			ruis::mouse_button::left,
@@ -84,12 +84,7 @@ class wayland_touch_wrapper
 	static void wl_touch_frame(
 		void* data, //
 		wl_touch* touch
-	)
-	{
-		utki::log_debug([](auto& o) {
-			o << "wayland: touch frame event" << std::endl;
-		});
-	}
+	);
 
 	static void wl_touch_cancel(
 		void* data, //
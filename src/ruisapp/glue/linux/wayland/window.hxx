@@ -21,10 +21,13 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <GLES2/gl2.h>
 #include <ruis/render/native_window.hpp>
 #include <wayland-egl.h> // Wayland EGL MUST be included before EGL headers
 
+#include "../../egl_offscreen_context.hxx"
 #include "../../egl_utils.hxx"
+#include "../../frame_fences.hxx"
 
 #include "display.hxx"
 #include "wayland_egl_window.hxx"
@@ -32,6 +35,10 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #include "xdg_surface.hxx"
 #include "xdg_toplevel.hxx"
 
+namespace {
+using offscreen_context = egl_offscreen_context<display_wrapper>;
+} // namespace
+
 namespace {
 class native_window : public ruis::render::native_window
 {
@@ -50,6 +57,11 @@ class native_window : public ruis::render::native_window
 
 	wayland_surface_wrapper::scale_and_dpi scale_and_dpi;
 
+	const ruisapp::presentation_mode presentation;
+	const unsigned max_frames_in_flight;
+
+	frame_fences<egl_fence_api> fences;
+
 public:
 	const unsigned sequence_number = []() {
 		static unsigned next_sequence_number = 0;
@@ -71,7 +83,7 @@ public:
 		utki::shared_ref<display_wrapper> display,
 		const utki::version_duplet& gl_version,
 		const ruisapp::window_parameters& window_params,
-		native_window* shared_gl_context_native_window
+		const offscreen_context& shared_context
 	) :
 		display(std::move(display)),
 		wayland_surface(this->display.get().wayland_compositor),
@@ -97,8 +109,11 @@ public:
 			this->display.get().egl_display, //
 			gl_version,
 			this->egl_config,
-			shared_gl_context_native_window ? shared_gl_context_native_window->egl_context.context : EGL_NO_CONTEXT
+			shared_context.get_egl_context()
 		),
+		presentation(window_params.presentation),
+		max_frames_in_flight(window_params.max_frames_in_flight),
+		fences(egl_fence_api{.egl_display = this->display.get().egl_display}),
 		cur_window_dims(window_params.dims)
 	{
 		utki::log_debug([](auto& o) {
@@ -148,6 +163,48 @@ public:
 		}
 	}
 
+	// on Wayland EGL passes the damage to the compositor via wl_surface_damage_buffer()
+	void swap_frame_buffers(utki::span<const r4::rectangle<int>> damage)
+	{
+		if (this->egl_surface.has_value()) {
+			this->egl_surface.value().swap_frame_buffers(damage);
+
+			// in case fences are not supported, the frames in flight are limited by the EGL implementation only
+			if (this->presentation == ruisapp::presentation_mode::throughput) {
+				this->fences.on_frame_presented(this->max_frames_in_flight);
+			}
+		}
+	}
+
+	bool has_frame_fences() const noexcept
+	{
+		return this->fences.has_fences();
+	}
+
+	/**
+	 * @brief Destroy fences of the presented frames.
+	 * Must be called with the window's rendering context bound.
+	 */
+	void release_frame_fences()
+	{
+		this->fences.release();
+	}
+
+	unsigned get_buffer_age()
+	{
+		if (this->egl_surface.has_value()) {
+			return this->egl_surface.value().get_buffer_age();
+		}
+		return 0;
+	}
+
+	void set_repaint_region(const r4::rectangle<int>& region)
+	{
+		if (this->egl_surface.has_value()) {
+			this->egl_surface.value().set_repaint_region(region);
+		}
+	}
+
 	void bind_rendering_context() override
 	{
 		auto& egl_display = this->display.get().egl_display;
@@ -193,6 +250,26 @@ public:
 		return eglGetCurrentContext() == this->egl_context.context;
 	}
 
+	/**
+	 * @brief Unbind the window's rendering context from the calling thread.
+	 * Waits for all GL commands issued in the context to complete, so that GL objects
+	 * created in the context are ready to be used from shared contexts.
+	 * Does nothing if the window's rendering context is not bound on the calling thread.
+	 */
+	void unbind_rendering_context()
+	{
+		if (!this->is_rendering_context_bound()) {
+			return;
+		}
+		glFinish();
+		eglMakeCurrent(
+			this->display.get().egl_display.display,
+			EGL_NO_SURFACE,
+			EGL_NO_SURFACE,
+			EGL_NO_CONTEXT
+		);
+	}
+
 	void set_fullscreen_internal(bool enable) override
 	{
 		if (enable) {
@@ -254,9 +331,13 @@ public:
 		return wl_surface_frame(this->wayland_surface.surface);
 	}
 
-	void mark_dirty()
+	/**
+	 * @brief Mark regions of the window surface as dirty.
+	 * @param damage - dirty regions in buffer pixels with origin at top left corner.
+	 */
+	void mark_dirty(utki::span<const r4::rectangle<int>> damage)
 	{
-		this->wayland_surface.damage(this->cur_window_dims.to<int32_t>());
+		this->wayland_surface.damage(damage);
 	}
 };
 } // namespace
@@ -82,8 +82,7 @@ void xdg_surface_wrapper::xdg_surface_configure(
 
 	auto window = glue.get_window(self.wayland_surface.surface);
 	if (!window) {
-		utki::logcat_debug("  could not find window object, perhaps called for shared gl context window", '\n');
-		utki::assert(self.wayland_surface.surface == glue.get_shared_gl_context_window_id(), SL);
+		utki::logcat_debug("  could not find window object, ignoring configure event", '\n');
 		return;
 	}
 
@@ -95,7 +94,8 @@ void xdg_surface_wrapper::xdg_surface_configure(
 	// and each commit can trigger a configure event.
 	// So, check if the EGL surface is already created, and if not, then create it and do the initial surface commit.
 	// Otherwise, if the EGL surface is already created, then just do the surface commit.
-	if (!natwin.is_egl_surface_created()) {
+	bool first_configure = !natwin.is_egl_surface_created();
+	if (first_configure) {
 		natwin.create_egl_surface();
 	}
 
@@ -110,4 +110,25 @@ void xdg_surface_wrapper::xdg_surface_configure(
 
 	// on some Wayland implementations just swapping EGL buffers is not enough and surface commit is needed
 	self.wayland_surface.commit();
+
+	// the swapped buffer does not have the actual window contents, so the window needs re-rendering
+	win.invalidate();
+
+	if (first_configure && win.on_ready) {
+		// The window was created asynchronously, notify that it is ready now.
+		// Do not call user code from within Wayland event dispatching, post it to the UI queue instead.
+		// The window can be destroyed before the procedure is executed, so look it up by id and check that
+		// it is the same window and not another one which happens to have the same id.
+		glue.ui_queue.push_back( //
+			[id = natwin.get_id(),
+			 sequence_number = natwin.sequence_number,
+			 on_ready = std::exchange(win.on_ready, nullptr)]() {
+				auto w = get_glue().get_window(id);
+				if (!w || w->ruis_native_window.get().sequence_number != sequence_number) {
+					return;
+				}
+				on_ready(*w);
+			}
+		);
+	}
 }
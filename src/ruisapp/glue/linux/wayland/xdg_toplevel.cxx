@@ -21,6 +21,8 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #include "xdg_toplevel.hxx"
 
+#include "../../../flight_recorder.hpp"
+
 #include "application.hxx"
 
 xdg_toplevel_wrapper::xdg_toplevel_wrapper(
@@ -87,6 +89,12 @@ void xdg_toplevel_wrapper::xdg_toplevel_configure(
 		o << "  width = " << std::dec << width << ", height = " << height << std::endl;
 	});
 
+	ruisapp::flight_recorder::inst().record_instant(
+		ruisapp::trace_event::window_configure, //
+		uint32_t(width),
+		uint32_t(height)
+	);
+
 	app_window::window_state state;
 
 	utki::assert(states, SL);
@@ -156,8 +164,7 @@ void xdg_toplevel_wrapper::xdg_toplevel_configure(
 
 	auto window = glue.get_window(self.wayland_surface.surface);
 	if (!window) {
-		utki::logcat_debug("  could not find window object, perhaps called for shared gl context window", '\n');
-		utki::assert(self.wayland_surface.surface == glue.get_shared_gl_context_window_id(), SL);
+		utki::logcat_debug("  could not find window object, ignoring configure event", '\n');
 		return;
 	}
 	auto& win = *window;
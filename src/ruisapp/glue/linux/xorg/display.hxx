@@ -21,7 +21,16 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #pragma once
 
-#include <gtk/gtk.h>
+#include <algorithm>
+#include <array>
+#include <map>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include <r4/rectangle.hpp>
+#include <utki/flags.hpp>
+#include <utki/string.hpp>
 
 #ifdef RUISAPP_RENDER_OPENGL
 #	include <GL/glx.h>
@@ -30,7 +39,11 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #	include "../../egl_utils.hxx"
 #endif
 
+#include <X11/extensions/Xrandr.h>
+
 #include "cursor.hxx"
+#include "scale_factor.hxx"
+#include "window_visual.hxx"
 #include "xorg_display_wrapper.hxx"
 
 namespace {
@@ -39,6 +52,54 @@ class display_wrapper
 public:
 	xorg_display_wrapper xorg_display;
 
+	/**
+	 * @brief X atoms used by windows.
+	 * Interned once per display with a single round trip to the X server.
+	 */
+	struct xorg_atoms {
+		Atom wm_protocols;
+		Atom wm_delete_window;
+		Atom net_wm_state;
+		Atom net_wm_state_skip_taskbar;
+		Atom net_wm_state_fullscreen;
+	};
+
+	const xorg_atoms atoms;
+
+private:
+	const scale_factor_settings scale_settings;
+
+	// XRandR event base, or -1 if XRandR extension is not available
+	int xrandr_event_base = -1;
+
+public:
+	struct monitor_density {
+		ruis::real dots_per_inch;
+		ruis::real dots_per_pp;
+
+		bool operator==(const monitor_density&) const = default;
+
+		ruis::units to_units() const
+		{
+			return ruis::units(
+				this->dots_per_inch, //
+				this->dots_per_pp
+			);
+		}
+	};
+
+	struct monitor {
+		// monitor position and size on the root window, in pixels
+		r4::rectangle<int> rect;
+		ruis::real scale_factor;
+		monitor_density density;
+	};
+
+private:
+	// never empty, primary monitor goes first
+	std::vector<monitor> monitors;
+
+public:
 	struct xorg_input_method_wrapper {
 		const XIM xim;
 
@@ -69,36 +130,46 @@ public:
 		}
 	} xorg_input_method;
 
-#if defined(RUISAPP_RENDER_OPENGLES)
+#if defined(RUISAPP_RENDER_OPENGL)
+	enum class glx_extension {
+		glx_arb_create_context,
+		glx_ext_swap_control,
+		glx_mesa_swap_control,
+		glx_ext_buffer_age,
+		glx_oml_sync_control,
+
+		enum_size
+	};
+
+	/**
+	 * @brief GLX extension functions.
+	 * Resolved once per display, null if the extension is not supported.
+	 */
+	struct glx_functions_table {
+		PFNGLXCREATECONTEXTATTRIBSARBPROC create_context_attribs_arb = nullptr;
+		PFNGLXSWAPINTERVALEXTPROC swap_interval_ext = nullptr;
+		PFNGLXSWAPINTERVALMESAPROC swap_interval_mesa = nullptr;
+		PFNGLXGETMSCRATEOMLPROC get_msc_rate_oml = nullptr;
+	};
+
+private:
+	// glXGetProcAddressARB() will return non-null pointer even if extension is
+	// not supported, so we need to explicitly check for supported extensions.
+	// SOURCE:
+	// https://dri.freedesktop.org/wiki/glXGetProcAddressNeverReturnsNULL/
+	utki::flags<glx_extension> supported_glx_extensions = false;
+
+	glx_functions_table glx_functions;
+
+public:
+#elif defined(RUISAPP_RENDER_OPENGLES)
 	egl_display_wrapper egl_display;
 #endif
 
-	const ruis::real scale_factor;
-
 	display_wrapper() :
-		xorg_input_method(this->xorg_display),
-		scale_factor([]() {
-			gtk_init();
-
-			auto disp = gdk_display_open(
-				// We have to use nullptr here because on Wayland it cannot connect to :0 X display even if XWayland is enabled,
-				// because the display name in that case is 'wayland-0'.
-				// Using nullptr here makes it detect the correct display automatically.
-				nullptr
-			);
-			utki::assert(disp, SL);
-			std::cout << "gdk display name = " << gdk_display_get_name(disp) << std::endl;
-			auto surf = gdk_surface_new_toplevel(disp);
-			utki::assert(surf, SL);
-			auto mon = gdk_display_get_monitor_at_surface(disp, surf);
-			utki::assert(mon, SL);
-			int sf = gdk_monitor_get_scale_factor(mon);
-
-			auto scale_factor = ruis::real(sf);
-
-			std::cout << "display scale factor = " << scale_factor << std::endl;
-			return scale_factor;
-		}())
+		atoms(intern_atoms(this->xorg_display)),
+		scale_settings(this->xorg_display.display),
+		xorg_input_method(this->xorg_display)
 	{
 #if defined(RUISAPP_RENDER_OPENGL)
 		{
@@ -121,7 +192,30 @@ public:
 				throw std::runtime_error("GLX version 1.3 or above is required");
 			}
 		}
+
+		this->init_glx_extensions();
 #endif
+
+		{
+			int error_base = 0;
+			if (XRRQueryExtension(
+					this->xorg_display.display, //
+					&this->xrandr_event_base,
+					&error_base
+				))
+			{
+				// get notified about monitors being plugged, unplugged or reconfigured
+				XRRSelectInput(
+					this->xorg_display.display,
+					this->xorg_display.get_default_root_window(),
+					RRScreenChangeNotifyMask | RRCrtcChangeNotifyMask | RROutputChangeNotifyMask
+				);
+			} else {
+				this->xrandr_event_base = -1;
+			}
+		}
+
+		this->update_monitors();
 	}
 
 	display_wrapper(const xorg_display_wrapper&) = delete;
@@ -130,50 +224,100 @@ public:
 	display_wrapper(xorg_display_wrapper&&) = delete;
 	display_wrapper& operator=(xorg_display_wrapper&&) = delete;
 
-	ruis::real get_dots_per_inch()
+	/**
+	 * @brief Handle XRandR event.
+	 * @param event - X event to handle.
+	 * @return true if the event was XRandR event and the monitors configuration was updated.
+	 * @return false if the event is not an XRandR event.
+	 */
+	bool handle_xrandr_event(XEvent& event)
 	{
-		int src_num = 0;
+		if (this->xrandr_event_base < 0) {
+			return false;
+		}
 
-		constexpr auto mm_per_cm = 10;
+		if (event.type == this->xrandr_event_base + RRScreenChangeNotify) {
+			XRRUpdateConfiguration(&event);
+		} else if (event.type != this->xrandr_event_base + RRNotify) {
+			return false;
+		}
 
-		ruis::real value =
-			// NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast, cppcoreguidelines-pro-bounds-pointer-arithmetic)
-			((ruis::real(DisplayWidth(this->xorg_display.display, src_num))
-			  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast, cppcoreguidelines-pro-bounds-pointer-arithmetic)
-			  / (ruis::real(DisplayWidthMM(this->xorg_display.display, src_num)) / ruis::real(mm_per_cm)))
-			 // NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast, cppcoreguidelines-pro-bounds-pointer-arithmetic)
-			 +
-			 // NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast, cppcoreguidelines-pro-bounds-pointer-arithmetic)
-			 (ruis::real(DisplayHeight(this->xorg_display.display, src_num))
-			  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast, cppcoreguidelines-pro-bounds-pointer-arithmetic)
-			  / (ruis::real(DisplayHeightMM(this->xorg_display.display, src_num)) / ruis::real(mm_per_cm)))) /
-			2;
-		value *= ruis::real(utki::cm_per_inch);
-		return value;
+		this->update_monitors();
+		return true;
 	}
 
-	ruis::real get_dots_per_pp()
+	/**
+	 * @brief Find the monitor which the given rectangle mostly overlaps.
+	 * @param rect - rectangle on the root window, in pixels.
+	 * @return The monitor with the largest overlap area,
+	 *         or primary monitor if the rectangle does not overlap any monitor.
+	 */
+	const monitor& find_monitor(const r4::rectangle<int>& rect) const
 	{
-		// TODO: use scale factor only for desktop monitors
-		if (auto scale_factor = this->scale_factor; scale_factor != ruis::real(1)) {
-			return scale_factor;
+		utki::assert(!this->monitors.empty(), SL);
+
+		const monitor* ret = &this->monitors.front();
+		long max_area = 0;
+
+		for (const auto& m : this->monitors) {
+			using std::max;
+			using std::min;
+			auto left = max(rect.p.x(), m.rect.p.x());
+			auto top = max(rect.p.y(), m.rect.p.y());
+			auto right = min(rect.p.x() + rect.d.x(), m.rect.p.x() + m.rect.d.x());
+			auto bottom = min(rect.p.y() + rect.d.y(), m.rect.p.y() + m.rect.d.y());
+
+			if (right <= left || bottom <= top) {
+				continue;
+			}
+
+			auto area = long(right - left) * long(bottom - top);
+			if (area > max_area) {
+				max_area = area;
+				ret = &m;
+			}
 		}
 
-		int src_num = 0;
-		r4::vector2<unsigned> resolution(
-			// NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast, cppcoreguidelines-pro-bounds-pointer-arithmetic)
-			DisplayWidth(this->xorg_display.display, src_num),
-			// NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast, cppcoreguidelines-pro-bounds-pointer-arithmetic)
-			DisplayHeight(this->xorg_display.display, src_num)
-		);
-		r4::vector2<unsigned> screen_size_mm(
-			// NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast, cppcoreguidelines-pro-bounds-pointer-arithmetic)
-			DisplayWidthMM(this->xorg_display.display, src_num),
-			// NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast, cppcoreguidelines-pro-bounds-pointer-arithmetic)
-			DisplayHeightMM(this->xorg_display.display, src_num)
-		);
-
-		return ruisapp::application::get_pixels_per_pp(resolution, screen_size_mm);
+		return *ret;
+	}
+
+#if defined(RUISAPP_RENDER_OPENGL)
+	const utki::flags<glx_extension>& get_supported_glx_extensions() const noexcept
+	{
+		return this->supported_glx_extensions;
+	}
+
+	const glx_functions_table& get_glx_functions() const noexcept
+	{
+		return this->glx_functions;
+	}
+#endif
+
+	/**
+	 * @brief Get framebuffer config, X visual and colormap for a window.
+	 * Those are created on first request and then reused for all windows
+	 * with the same graphics API version and framebuffer related window parameters.
+	 * @param gl_version - graphics API version.
+	 * @param window_params - window parameters.
+	 * @return Window visual.
+	 */
+	const window_visual& get_window_visual(
+		const utki::version_duplet& gl_version, //
+		const ruisapp::window_parameters& window_params
+	)
+	{
+		auto& v = this->window_visuals[window_visual::make_key(gl_version, window_params)];
+		if (!v) {
+			v = std::make_unique<window_visual>(
+				this->xorg_display, //
+#if defined(RUISAPP_RENDER_OPENGLES)
+				this->egl_display,
+#endif
+				gl_version,
+				window_params
+			);
+		}
+		return *v;
 	}
 
 	cursor_wrapper& get_cursor(ruis::mouse_cursor c)
@@ -187,5 +331,203 @@ public:
 
 private:
 	utki::enum_array<std::unique_ptr<cursor_wrapper>, ruis::mouse_cursor> cursors;
+
+	// declared after the displays to be destroyed before those
+	std::map<window_visual::key_type, std::unique_ptr<window_visual>> window_visuals;
+
+	static xorg_atoms intern_atoms(xorg_display_wrapper& display)
+	{
+		std::array<const char*, 5> names = {
+			"WM_PROTOCOLS",
+			"WM_DELETE_WINDOW",
+			"_NET_WM_STATE",
+			"_NET_WM_STATE_SKIP_TASKBAR",
+			"_NET_WM_STATE_FULLSCREEN"
+		};
+
+		std::array<Atom, names.size()> atoms{};
+
+		// XInternAtoms() does only one round trip to the X server for all the atoms
+		if (!XInternAtoms(
+				display.display, //
+				// NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast, "Xlib does not modify the names")
+				const_cast<char**>(names.data()),
+				int(names.size()),
+				False, // create atoms if those do not exist
+				atoms.data()
+			))
+		{
+			throw std::runtime_error("XInternAtoms() failed");
+		}
+
+		return {
+			.wm_protocols = atoms[0],
+			.wm_delete_window = atoms[1],
+			.net_wm_state = atoms[2],
+			.net_wm_state_skip_taskbar = atoms[3],
+			.net_wm_state_fullscreen = atoms[4]
+		};
+	}
+
+#if defined(RUISAPP_RENDER_OPENGL)
+	void init_glx_extensions()
+	{
+		auto glx_extensions_string = std::string_view(glXQueryExtensionsString(
+			this->xorg_display.display, //
+			this->xorg_display.get_default_screen()
+		));
+		utki::log_debug([&](auto& o) {
+			o << "glx_extensions_string = " << glx_extensions_string << std::endl;
+		});
+
+		auto glx_extensions = utki::split(glx_extensions_string);
+
+		auto is_supported = [&](std::string_view name) {
+			return std::ranges::find(
+					   glx_extensions, //
+					   name
+				   ) != glx_extensions.end();
+		};
+
+		using namespace std::string_view_literals;
+
+		auto& supported = this->supported_glx_extensions;
+
+		if (is_supported("GLX_ARB_create_context"sv)) {
+			supported.set(glx_extension::glx_arb_create_context);
+		}
+		if (is_supported("GLX_EXT_swap_control"sv)) {
+			supported.set(glx_extension::glx_ext_swap_control);
+		}
+		if (is_supported("GLX_MESA_swap_control"sv)) {
+			supported.set(glx_extension::glx_mesa_swap_control);
+		}
+		if (is_supported("GLX_EXT_buffer_age"sv)) {
+			supported.set(glx_extension::glx_ext_buffer_age);
+		}
+		if (is_supported("GLX_OML_sync_control"sv)) {
+			supported.set(glx_extension::glx_oml_sync_control);
+		}
+
+		// NOTE: glXGetProcAddressARB() is guaranteed to be present in all GLX versions,
+		//       glXGetProcAddress() is not guaranteed.
+		// SOURCE:
+		// https://dri.freedesktop.org/wiki/glXGetProcAddressNeverReturnsNULL/
+		auto get_proc_address = [](const char* name) {
+			// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast, "using C API")
+			return glXGetProcAddressARB(reinterpret_cast<const GLubyte*>(name));
+		};
+
+		auto& funcs = this->glx_functions;
+
+		if (supported.get(glx_extension::glx_arb_create_context)) {
+			funcs.create_context_attribs_arb =
+				PFNGLXCREATECONTEXTATTRIBSARBPROC(get_proc_address("glXCreateContextAttribsARB"));
+		}
+		if (supported.get(glx_extension::glx_ext_swap_control)) {
+			funcs.swap_interval_ext = PFNGLXSWAPINTERVALEXTPROC(get_proc_address("glXSwapIntervalEXT"));
+		}
+		if (supported.get(glx_extension::glx_mesa_swap_control)) {
+			funcs.swap_interval_mesa = PFNGLXSWAPINTERVALMESAPROC(get_proc_address("glXSwapIntervalMESA"));
+		}
+		if (supported.get(glx_extension::glx_oml_sync_control)) {
+			funcs.get_msc_rate_oml = PFNGLXGETMSCRATEOMLPROC(get_proc_address("glXGetMscRateOML"));
+		}
+	}
+#endif
+
+	monitor make_monitor(
+		const r4::rectangle<int>& rect, //
+		const r4::vector2<unsigned>& size_mm
+	) const
+	{
+		auto resolution = rect.d.to<unsigned>();
+
+		auto scale_factor = this->scale_settings.get_scale_factor(resolution, size_mm);
+
+		auto dots_per_inch = [&]() {
+			if (size_mm.x() == 0 || size_mm.y() == 0) {
+				// physical size is unknown, assume standard DPI
+				constexpr auto default_dpi = 96;
+				return ruis::real(default_dpi) * scale_factor;
+			}
+			auto dpi = (resolution.to<ruis::real>() * ruis::real(utki::mm_per_inch)).comp_div(size_mm.to<ruis::real>());
+			return (dpi.x() + dpi.y()) / 2;
+		}();
+
+		auto dots_per_pp = [&]() {
+			// TODO: use scale factor only for desktop monitors
+			if (scale_factor != ruis::real(1)) {
+				return scale_factor;
+			}
+			return ruisapp::application::get_pixels_per_pp(resolution, size_mm);
+		}();
+
+		return {
+			.rect = rect,
+			.scale_factor = scale_factor,
+			.density =
+				{
+					.dots_per_inch = dots_per_inch, //
+					.dots_per_pp = dots_per_pp
+				}
+		};
+	}
+
+	void update_monitors()
+	{
+		this->monitors.clear();
+
+		if (this->xrandr_event_base >= 0) {
+			int num_monitors = 0;
+			XRRMonitorInfo* infos = XRRGetMonitors(
+				this->xorg_display.display,
+				this->xorg_display.get_default_root_window(),
+				True, // only active monitors
+				&num_monitors
+			);
+			if (infos) {
+				utki::scope_exit infos_scope_exit([&infos]() {
+					XRRFreeMonitors(infos);
+				});
+
+				for (const auto& info : utki::make_span(infos, size_t(std::max(num_monitors, 0)))) {
+					auto m = this->make_monitor(
+						{
+							{info.x, info.y},
+							{info.width, info.height}
+						},
+						{unsigned(info.mwidth), unsigned(info.mheight)}
+					);
+
+					if (info.primary) {
+						this->monitors.insert(this->monitors.begin(), m);
+					} else {
+						this->monitors.push_back(m);
+					}
+				}
+			}
+		}
+
+		if (!this->monitors.empty()) {
+			return;
+		}
+
+		// XRandR is not available, treat the whole screen as one monitor
+		int src_num = 0;
+		this->monitors.push_back(this->make_monitor(
+			{
+				{0, 0},
+				{// NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast, cppcoreguidelines-pro-bounds-pointer-arithmetic)
+				 DisplayWidth(this->xorg_display.display, src_num),
+				 // NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast, cppcoreguidelines-pro-bounds-pointer-arithmetic)
+				 DisplayHeight(this->xorg_display.display, src_num)}
+		},
+			{// NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast, cppcoreguidelines-pro-bounds-pointer-arithmetic)
+			 unsigned(DisplayWidthMM(this->xorg_display.display, src_num)),
+			 // NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast, cppcoreguidelines-pro-bounds-pointer-arithmetic)
+			 unsigned(DisplayHeightMM(this->xorg_display.display, src_num))}
+		));
+	}
 };
 } // namespace
@@ -19,11 +19,12 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 /* ================ LICENSE END ================ */
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <string_view>
 #include <vector>
 
-#include <nitki/queue.hpp>
 #include <opros/wait_set.hpp>
 #include <utki/unicode.hpp>
 
@@ -38,11 +39,25 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #endif
 
 #include "../../../application.hpp"
+#include "../../../flight_recorder.hpp"
+#include "../../../startup_profile.hpp"
+#include "../../flight_recorder_dumper.hxx"
+#include "../../frame_readback.hxx"
+#include "../../frame_scheduler.hxx"
+#include "../../frame_timer.hxx"
+#include "../../prioritized_procedure_queue.hxx"
+#include "../../resource_loading_thread.hxx"
+#include "../../shared_gl_resources.hxx"
 #include "../../unix_common.hxx"
+#include "../../update_deadline.hxx"
+#include "../../vblank_pacing.hxx"
+#include "../../wakeup_waitable.hxx"
 
 #include "cursor.hxx"
 #include "display.hxx"
+#include "input_thread.hxx"
 #include "key_code_map.hxx"
+#include "offscreen_context.hxx"
 #include "window.hxx"
 
 using namespace std::string_literals;
@@ -74,6 +89,68 @@ public:
 	}
 
 	ruis::vec2 new_win_dims{-1, -1};
+
+	// dimensions the window's viewport was last set to
+	ruis::vec2 cur_win_dims{-1, -1};
+
+	// density of the monitor the window mostly overlaps, ruis::context::units are set from it
+	display_wrapper::monitor_density density{};
+
+	app_window(const app_window&) = delete;
+	app_window& operator=(const app_window&) = delete;
+
+	app_window(app_window&&) = delete;
+	app_window& operator=(app_window&&) = delete;
+
+	~app_window() override
+	{
+		// GL objects of the window are released while the window's rendering context still exists
+		if (this->readback.has_gl_objects() || this->ruis_native_window.get().has_frame_fences()) {
+			this->gui.context.get().ren().ctx().apply([this]() {
+				this->readback.release();
+				this->ruis_native_window.get().release_frame_fences();
+			});
+		}
+	}
+
+private:
+	frame_readback readback;
+
+	unsigned get_back_buffer_age() override
+	{
+		return this->ruis_native_window.get().get_buffer_age();
+	}
+
+	void set_repaint_region(const r4::rectangle<int>& region) override
+	{
+		this->ruis_native_window.get().set_repaint_region(region);
+	}
+
+	void swap_frame_buffers(utki::span<const r4::rectangle<int>> damage) override
+	{
+		this->ruis_native_window.get().swap_frame_buffers(damage);
+	}
+
+	bool is_frame_capture_supported() const noexcept override
+	{
+		return true;
+	}
+
+	bool start_frame_readback(
+		r4::vector2<int> dims, //
+		std::vector<ruisapp::frame_capture_request> requests
+	) override
+	{
+		return this->readback.read(
+			dims, //
+			std::move(requests)
+		);
+	}
+
+	bool poll_frame_readbacks() override
+	{
+		return this->readback.poll();
+	}
 };
 } // namespace
 
@@ -81,17 +158,16 @@ namespace {
 class application_glue : public utki::destructable
 {
 public:
-	const utki::shared_ref<display_wrapper> display = utki::make_shared<display_wrapper>();
+	const utki::shared_ref<display_wrapper> display = []() {
+		ruisapp::startup_profile::scope profile_scope(ruisapp::startup_phase::display_open);
+		return utki::make_shared<display_wrapper>();
+	}();
 
 private:
 	utki::version_duplet gl_version;
 
-	utki::shared_ref<native_window> shared_gl_context_native_window;
-	utki::shared_ref<ruis::render::context> resource_loader_ruis_rendering_context;
-	utki::shared_ref<const ruis::render::context::shaders> common_shaders;
-	utki::shared_ref<const ruis::render::renderer::objects> common_render_objects;
-	utki::shared_ref<ruis::resource_loader> ruis_resource_loader;
-	utki::shared_ref<ruis::style_provider> ruis_style_provider;
+	utki::shared_ref<offscreen_context> shared_gl_context;
+	async_shared_gl_resources shared_gl_resources;
 
 	std::map<
 		native_window::window_id_type, //
@@ -99,67 +175,116 @@ private:
 		>
 		windows;
 
+	// reused between main loop iterations to avoid memory allocations
+	std::vector<app_window*> windows_to_render;
+
+	frame_scheduler scheduler;
+
 public:
 	std::vector<utki::shared_ref<app_window>> windows_to_destroy;
 
-	application_glue(const utki::version_duplet& gl_version) :
+	application_glue(
+		const utki::version_duplet& gl_version, //
+		bool dedicated_input_thread
+	) :
 		gl_version(gl_version),
-		shared_gl_context_native_window( //
-			utki::make_shared<native_window>(
-				this->display, //
-				this->gl_version,
-				ruisapp::window_parameters{
-					.dims = {1, 1},
-					.title = {},
-					.fullscreen = false
-    },
-				nullptr
-			)
+		shared_gl_context( //
+			[&]() {
+				auto c = utki::make_shared<offscreen_context>(
+					this->display, //
+					this->gl_version,
+					nullptr // no shared gl context
+				);
+				// the shared GL context is going to be bound on the shared GL resources initialization thread
+				c.get().unbind_rendering_context();
+				return c;
+			}()
 		),
-		resource_loader_ruis_rendering_context(
+		shared_gl_resources(
+			[this]() -> utki::shared_ref<ruis::render::context> {
 #ifdef RUISAPP_RENDER_OPENGL
-			utki::make_shared<ruis::render::opengl::context>(this->shared_gl_context_native_window)
+				return utki::make_shared<ruis::render::opengl::context>(this->shared_gl_context);
 #elif defined(RUISAPP_RENDER_OPENGLES)
-			utki::make_shared<ruis::render::opengles::context>(this->shared_gl_context_native_window)
+				return utki::make_shared<ruis::render::opengles::context>(this->shared_gl_context);
 #else
 #	error "Unknown graphics API"
 #endif
-		),
-		common_shaders( //
-			[&]() {
-				utki::assert(this->resource_loader_ruis_rendering_context.to_shared_ptr(), SL);
-				return this->resource_loader_ruis_rendering_context.get().make_shaders();
-			}()
-		),
-		common_render_objects( //
-			utki::make_shared<ruis::render::renderer::objects>(this->resource_loader_ruis_rendering_context)
-		),
-		ruis_resource_loader( //
-			utki::make_shared<ruis::resource_loader>(
-				this->resource_loader_ruis_rendering_context, //
-				this->common_render_objects
-			)
-		),
-		ruis_style_provider( //
-			utki::make_shared<ruis::style_provider>(this->ruis_resource_loader)
+			},
+			[this]() {
+				this->shared_gl_context.get().unbind_rendering_context();
+			}
 		)
-	{}
+	{
+		if (dedicated_input_thread) {
+			this->input_thread.emplace(this->display.get().xorg_display.display);
+		}
+	}
 
-	nitki::queue ui_queue;
+	prioritized_procedure_queue<wakeup_waitable> ui_queue;
 
 	std::atomic_bool quit_flag = false;
 
 	utki::shared_ref<ruis::updater> updater = utki::make_shared<ruis::updater>();
 
+private:
+	// Created on first use. Declared after ui_queue, because the loading thread posts to the ui_queue.
+	std::optional<resource_loading_thread> resource_loading;
+
+public:
+	// reads X events in case the dedicated input thread is enabled
+	std::optional<xorg_input_thread> input_thread;
+
+	resource_loading_thread& get_resource_loading_thread()
+	{
+		if (this->resource_loading.has_value()) {
+			return this->resource_loading.value();
+		}
+
+		// the loading thread's GL context, the context shares GL objects with all windows
+		auto c = utki::make_shared<offscreen_context>(
+			this->display, //
+			this->gl_version,
+			&this->shared_gl_context.get()
+		);
+
+		return this->resource_loading.emplace(
+			[c]() -> utki::shared_ref<ruis::render::context> {
+#ifdef RUISAPP_RENDER_OPENGL
+				return utki::make_shared<ruis::render::opengl::context>(c);
+#elif defined(RUISAPP_RENDER_OPENGLES)
+				return utki::make_shared<ruis::render::opengles::context>(c);
+#else
+#	error "Unknown graphics API"
+#endif
+			},
+			[c]() {
+				c.get().unbind_rendering_context();
+			},
+			[this](std::function<void()> proc) {
+				this->ui_queue.push_back(std::move(proc));
+			}
+		);
+	}
+
 	app_window& make_window(ruisapp::window_parameters window_params)
 	{
 		auto ruis_native_window = utki::make_shared<native_window>(
 			this->display, //
 			this->gl_version,
 			window_params,
-			&this->shared_gl_context_native_window.get()
+			this->shared_gl_context.get()
 		);
 
+		if (auto refresh_period = ruis_native_window.get().get_refresh_period()) {
+			this->scheduler.set_refresh_period(refresh_period.value());
+		}
+
+		// the native window is created, now wait for the shared GL resources to be ready
+		const auto& shared_res = this->shared_gl_resources.get();
+
+		// the window is created at (0, 0), its actual position will be known from ConfigureNotify
+		auto density = this->display.get().find_monitor({{0, 0}, window_params.dims.to<int>()}).density;
+
 		auto ruis_context = utki::make_shared<ruis::context>(ruis::context::parameters{
 			.post_to_ui_thread_function =
 				[this](std::function<void()> proc) {
@@ -174,17 +299,11 @@ public:
 #else
 #	error "Unknown graphics API"
 #endif
-				this->common_shaders,
-				this->common_render_objects
+				shared_res.common_shaders,
+				shared_res.common_render_objects
 			),
-			.style_provider = this->ruis_style_provider,
-			.units =
-				[this]() {
-					return ruis::units(
-						this->display.get().get_dots_per_inch(), //
-						this->display.get().get_dots_per_pp()
-					);
-				}()
+			.style_provider = shared_res.ruis_style_provider,
+			.units = density.to_units()
 		});
 
 		auto ruisapp_window = utki::make_shared<app_window>(
@@ -192,12 +311,15 @@ public:
 			std::move(ruis_native_window)
 		);
 
-		ruisapp_window.get().gui.set_viewport( //
+		ruisapp_window.get().density = density;
+		ruisapp_window.get().cur_win_dims = {
+			ruis::real(window_params.dims.x()), //
+			ruis::real(window_params.dims.y())
+		};
+		ruisapp_window.get().set_viewport( //
 			ruis::rect(
 				0, //
-				0,
-				ruis::real(window_params.dims.x()),
-				ruis::real(window_params.dims.y())
+				ruisapp_window.get().cur_win_dims
 			)
 		);
 
@@ -235,8 +357,130 @@ public:
 
 	void render()
 	{
+		auto frame_start = std::chrono::steady_clock::now();
+
 		for (const auto& w : this->windows) {
-			w.second.get().render();
+			auto& win = w.second.get();
+			if (win.is_render_needed()) {
+				this->windows_to_render.push_back(&win);
+			}
+		}
+
+		if (this->windows_to_render.empty()) {
+			return;
+		}
+
+		auto pacer = render_with_single_vblank_wait(this->windows_to_render);
+
+		if (!pacer) {
+			this->scheduler.reset_phase();
+			return;
+		}
+
+		const auto& swap = pacer->ruis_native_window.get().get_last_swap_timings();
+		if (swap.vblank.has_value()) {
+			this->scheduler.on_frame_presented(
+				frame_start, //
+				swap.start,
+				swap.vblank.value()
+			);
+		} else {
+			this->scheduler.reset_phase();
+		}
+	}
+
+	bool is_render_needed() const
+	{
+		return std::any_of(
+			this->windows.begin(), //
+			this->windows.end(),
+			[](const auto& w) {
+				return w.second.get().is_render_needed();
+			}
+		);
+	}
+
+	/**
+	 * @brief Get time left until rendering of the next frame should start.
+	 * @return Zero if there is nothing to render or rendering should start right away.
+	 */
+	std::chrono::steady_clock::duration get_time_until_frame_start() const
+	{
+		if (!this->is_render_needed()) {
+			return std::chrono::steady_clock::duration::zero();
+		}
+
+		auto now = std::chrono::steady_clock::now();
+		return this->scheduler.get_frame_start_time(now) - now;
+	}
+
+	/**
+	 * @brief Get time budget for executing posted procedures.
+	 * In case a frame is due, the procedures are executed until the frame has to be started.
+	 */
+	ui_queue_budget get_ui_queue_budget() const
+	{
+		auto now = std::chrono::steady_clock::now();
+
+		if (!this->is_render_needed()) {
+			return {
+				.deadline = now + ui_queue_budget::max_duration, //
+				.run_idle = true
+			};
+		}
+
+		auto until_frame_start = this->get_time_until_frame_start();
+		if (until_frame_start > std::chrono::steady_clock::duration::zero()) {
+			// the frame has been finished early, there is spare time before the next one
+			auto budget = std::min<std::chrono::steady_clock::duration>(
+				until_frame_start, //
+				ui_queue_budget::max_duration
+			);
+			return {
+				.deadline = now + budget, //
+				.run_idle = true
+			};
+		}
+
+		return {
+			.deadline = now + ui_queue_budget::frame_pending_duration, //
+			.run_idle = false
+		};
+	}
+
+	void invalidate_all_implicitly()
+	{
+		for (const auto& w : this->windows) {
+			w.second.get().invalidate_implicitly();
+		}
+	}
+
+	void flush_coalesced_input()
+	{
+		for (const auto& w : this->windows) {
+			w.second.get().flush_coalesced_input();
+		}
+	}
+
+	/**
+	 * @brief Deliver captured frames whose readback has completed.
+	 * @return true if there are frame readbacks still in flight.
+	 */
+	bool process_frame_captures()
+	{
+		bool in_flight = false;
+		for (const auto& w : this->windows) {
+			if (w.second.get().process_frame_captures()) {
+				in_flight = true;
+			}
+		}
+		return in_flight;
+	}
+
+	void push_frame_statistics(const ruisapp::frame_statistics::sample& loop_sample)
+	{
+		for (const auto& w : this->windows) {
+			w.second.get().push_frame_statistics(loop_sample);
 		}
 	}
 
@@ -244,11 +488,62 @@ public:
 	{
 		for (auto& win : this->windows) {
 			auto& w = win.second.get();
-			if (w.new_win_dims.is_positive_or_zero()) {
-				w.gui.set_viewport(ruis::rect(0, w.new_win_dims));
+			if (!w.new_win_dims.is_positive_or_zero()) {
+				// no ConfigureNotify since last time
+				continue;
+			}
+			// ConfigureNotify also comes when window is moved, so check that the dimensions have actually changed
+			if (w.new_win_dims != w.cur_win_dims) {
+				ruisapp::flight_recorder::inst().record_instant(
+					ruisapp::trace_event::window_resize, //
+					uint32_t(w.new_win_dims.x()),
+					uint32_t(w.new_win_dims.y())
+				);
+				w.cur_win_dims = w.new_win_dims;
+				w.set_viewport(ruis::rect(0, w.new_win_dims));
+				w.invalidate();
 			}
 			w.new_win_dims = {-1, -1};
+
+			// the window might have been moved to another monitor
+			this->update_window_density(w);
+		}
+	}
+
+	void update_windows_density()
+	{
+		for (auto& win : this->windows) {
+			this->update_window_density(win.second.get());
+		}
+	}
+
+private:
+	void update_window_density(app_window& w)
+	{
+		auto& natwin = w.ruis_native_window.get();
+
+		auto density = this->display.get()
+						   .find_monitor({natwin.get_position_on_root(), w.cur_win_dims.to<int>()})
+						   .density;
+		if (density == w.density) {
+			return;
 		}
+
+		utki::log_debug([&](auto& o) {
+			o << "window moved to monitor with dpi = " << density.dots_per_inch
+			  << ", dots per pp = " << density.dots_per_pp << std::endl;
+		});
+
+		w.density = density;
+
+		auto& units = w.gui.context.get().units;
+		units.set_dots_per_pp(density.dots_per_pp);
+		units.set_dots_per_inch(density.dots_per_inch);
+
+		// reload widgets hierarchy due to update of ruis::context::units values
+		w.gui.get_root().reload();
+
+		w.invalidate();
 	}
 };
 } // namespace
@@ -263,7 +558,10 @@ application_glue& get_glue(ruisapp::application& app)
 
 application::application(parameters params) :
 	application(
-		{.pimpl = utki::make_unique<application_glue>(params.graphics_api_version), //
+		{.pimpl = utki::make_unique<application_glue>(
+			 params.graphics_api_version, //
+			 params.dedicated_input_thread
+		 ), //
 		 .directories = get_application_directories(params.name),
 		 .params = std::move(params)}
 	)
@@ -335,6 +633,21 @@ ruisapp::window& application::make_window_internal(window_parameters window_para
 	return glue.make_window(std::move(window_params));
 }
 
+ruisapp::window& application::make_window_async(
+	window_parameters window_params, //
+	on_window_ready_function_type on_ready
+)
+{
+	// window creation is synchronous on this backend, so the window is ready right away
+	auto& win = this->make_window(std::move(window_params));
+
+	if (on_ready) {
+		on_ready(win);
+	}
+
+	return win;
+}
+
 void application::destroy_window(ruisapp::window& w)
 {
 	auto& glue = get_glue(*this);
@@ -346,8 +659,41 @@ void application::destroy_window(ruisapp::window& w)
 	);
 }
 
+void application::load_resources_async(
+	load_function_type load, //
+	on_loaded_function_type on_loaded
+)
+{
+	auto& glue = get_glue(*this);
+	glue.get_resource_loading_thread().push(
+		std::move(load), //
+		std::move(on_loaded)
+	);
+}
+
+void application::post_to_ui_thread(
+	ui_procedure_type procedure, //
+	ui_priority priority
+)
+{
+	auto& glue = get_glue(*this);
+	glue.ui_queue.push_back(
+		std::move(procedure), //
+		priority
+	);
+}
+
+application::ui_queue_metrics application::get_ui_queue_metrics()
+{
+	auto& glue = get_glue(*this);
+	return glue.ui_queue.get_metrics();
+}
+
 int main(int argc, const char** argv)
 {
+	// must be created before any other threads are started
+	flight_recorder_dumper recorder_dumper;
+
 	auto app = ruisapp::application_factory::make_application(argc, argv);
 	if (!app) {
 		// Not an error. The app just did not show any GUI to the user.
@@ -359,11 +705,19 @@ int main(int argc, const char** argv)
 
 	xevent_waitable xew(glue.display.get().xorg_display.display);
 
+	// in case of dedicated input thread, wait for the events read by the thread instead of the X connection
+	opros::waitable& xevents_waitable = [&]() -> opros::waitable& {
+		if (glue.input_thread.has_value()) {
+			return glue.input_thread.value().queue;
+		}
+		return xew;
+	}();
+
 	opros::wait_set wait_set(2);
 
-	wait_set.add(xew, {opros::ready::read}, &xew);
+	wait_set.add(xevents_waitable, {opros::ready::read}, &xevents_waitable);
 	utki::scope_exit xew_wait_set_scope_exit([&]() {
-		wait_set.remove(xew);
+		wait_set.remove(xevents_waitable);
 	});
 
 	wait_set.add(glue.ui_queue, {opros::ready::read}, &glue.ui_queue);
@@ -371,17 +725,259 @@ int main(int argc, const char** argv)
 		wait_set.remove(glue.ui_queue);
 	});
 
+	bool monitors_changed = false;
+
+	// Handle X event.
+	// The next received event is needed to detect auto-repeated key events.
+	// Returns whether the next event was consumed.
+	auto handle_xevent = [&](XEvent& event, const XEvent* next_event) -> bool {
+		// XRandR events are sent to the root window, so handle those before looking up the target window
+		if (glue.display.get().handle_xrandr_event(event)) {
+			monitors_changed = true;
+			return false;
+		}
+
+		// get the window the event is sent to
+		auto window = glue.get_window(event.xany.window);
+		if (!window) {
+			return false;
+		}
+
+		auto& w = *window;
+
+		if (event.type != MotionNotify) {
+			// deliver coalesced pointer motion before other events to preserve the events order
+			w.flush_coalesced_input();
+		}
+
+		switch (event.type) {
+			case Expose:
+				if (event.xexpose.count != 0) {
+					break;
+				}
+				w.invalidate();
+				break;
+			case ConfigureNotify:
+				// squash all window resize events into one, for that store the new
+				// window dimensions and update the viewport later only once
+				w.new_win_dims.x() = ruis::real(event.xconfigure.width);
+				w.new_win_dims.y() = ruis::real(event.xconfigure.height);
+				ruisapp::flight_recorder::inst().record_instant(
+					ruisapp::trace_event::window_configure, //
+					uint32_t(event.xconfigure.width),
+					uint32_t(event.xconfigure.height)
+				);
+				break;
+			case KeyPress:
+				{
+					// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+					ruis::key key = key_code_map[std::uint8_t(event.xkey.keycode)];
+
+					w.invalidate_implicitly();
+					w.send_key(
+						ruis::button_action::press, //
+						key
+					);
+
+					key_event_unicode_provider string_provider(
+						w.ruis_native_window, //
+						event.xkey
+					);
+
+					w.send_character_input(
+						string_provider, //
+						key
+					);
+				}
+				break;
+			case KeyRelease:
+				{
+					// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+					ruis::key key = key_code_map[std::uint8_t(event.xkey.keycode)];
+
+					w.invalidate_implicitly();
+
+					// detect auto-repeated key events
+					if (next_event) {
+						// there are other events queued
+
+						const auto& nev = *next_event;
+
+						if (nev.type == KeyPress && nev.xkey.time == event.xkey.time &&
+							nev.xkey.keycode == event.xkey.keycode)
+						{
+							// key wasn't actually released
+							// the unicode provider needs non-const event
+							XKeyEvent next_key_event = nev.xkey;
+							w.send_character_input(
+								key_event_unicode_provider(w.ruis_native_window, next_key_event), //
+								key
+							);
+
+							// the key down event is consumed
+							return true;
+						}
+					}
+
+					w.send_key(
+						ruis::button_action::release, //
+						key
+					);
+				}
+				break;
+			case ButtonPress:
+				w.invalidate_implicitly();
+				w.send_mouse_button(
+					ruis::button_action::press, //
+					ruis::vec2(event.xbutton.x, event.xbutton.y),
+					button_number_to_enum(event.xbutton.button),
+					0 // pointer_id
+				);
+				break;
+			case ButtonRelease:
+				w.invalidate_implicitly();
+				w.send_mouse_button(
+					ruis::button_action::release, //
+					ruis::vec2(event.xbutton.x, event.xbutton.y),
+					button_number_to_enum(event.xbutton.button),
+					0 // pointer_id
+				);
+				break;
+			case MotionNotify:
+				// high rate pointing devices produce several motion events per frame,
+				// squash those into one mouse move event per main loop iteration
+				w.coalesce_mouse_move(
+					ruis::vec2(
+						event.xmotion.x, //
+						event.xmotion.y
+					), //
+					0 // pointer_id
+				);
+				break;
+			case EnterNotify:
+				w.invalidate_implicitly();
+				w.send_mouse_hover(
+					true, //
+					0 // pointer_id
+				);
+				break;
+			case LeaveNotify:
+				w.invalidate_implicitly();
+				w.send_mouse_hover(
+					false, //
+					0 // pointer_id
+				);
+				break;
+			case ClientMessage:
+				// probably a WM_DELETE_WINDOW event
+				if (event.xclient.message_type == glue.display.get().atoms.wm_protocols) {
+					auto& nw = w.ruis_native_window.get();
+					if (nw.close_handler) {
+						nw.close_handler();
+					}
+				}
+				break;
+			default:
+				// ignore
+				break;
+		}
+
+		return false;
+	};
+
+	// received X events, reused between main loop iterations to avoid memory allocations
+	std::vector<input_event_queue<XEvent>::timestamped_event> xevents;
+
+	// Collect events received since last call. Events read by the input thread come first,
+	// followed by the events which got into the Xlib's event queue while the UI thread was
+	// doing other Xlib calls. Holding the display lock guarantees the input thread does not
+	// move events from the Xlib's queue in the meantime, so the order of events is preserved.
+	auto collect_xevents = [&]() -> bool {
+		auto display = glue.display.get().xorg_display.display;
+
+		xevents.clear();
+
+		XLockDisplay(display);
+		utki::scope_exit unlock_scope_exit([&]() {
+			XUnlockDisplay(display);
+		});
+
+		if (glue.input_thread.has_value()) {
+			while (auto e = glue.input_thread.value().queue.pop_front()) {
+				xevents.push_back(e.value());
+			}
+		}
+
+		// NOTE: do not check 'read' flag for X event, for some reason when waiting
+		//       with 0 timeout it will never be set.
+		//       Maybe some bug in XWindows.
+		while (XPending(display) > 0) {
+			XEvent event;
+			XNextEvent(
+				display, //
+				&event
+			);
+			xevents.push_back({
+				.event = event, //
+				.receive_time = std::chrono::steady_clock::now()
+			});
+		}
+
+		return !xevents.empty();
+	};
+
+	update_deadline updater_deadline;
+
 	while (!glue.quit_flag.load()) {
 		glue.windows_to_destroy.clear();
 
+		frame_timer timer;
+
 		// main loop cycle sequence as required by ruis:
 		// - update updateables
-		// - render
+		// - render windows which need it
 		// - wait for events and handle them
 
+		bool update_due = updater_deadline.is_due();
 		auto to_wait_ms = glue.updater.get().update();
-		glue.render();
-		wait_set.wait(to_wait_ms);
+		updater_deadline.set(to_wait_ms);
+		if (update_due) {
+			// updated updateables can change appearance of any window
+			glue.invalidate_all_implicitly();
+		}
+		timer.lap(ruisapp::frame_phase::update);
+
+		if (auto until_frame_start = glue.get_time_until_frame_start();
+			until_frame_start > std::chrono::steady_clock::duration::zero())
+		{
+			// Delay rendering so that it finishes right before the next vblank and
+			// meanwhile keep handling input events, so that the frame reflects the latest input.
+			to_wait_ms = std::min(
+				to_wait_ms, //
+				uint32_t(std::chrono::ceil<std::chrono::milliseconds>(until_frame_start).count())
+			);
+		} else {
+			glue.render();
+		}
+
+		if (glue.process_frame_captures()) {
+			// check for completion of the frame readbacks even if no more frames are rendered
+			to_wait_ms = std::min(to_wait_ms, frame_readback::idle_poll_interval_ms);
+		}
+
+		// procedures left in the queue due to exhausted time budget do not wake up the wait
+		if (glue.ui_queue.has_pending(glue.get_ui_queue_budget().run_idle)) {
+			to_wait_ms = 0;
+		}
+
+		{
+			ruisapp::flight_recorder::scope trace_scope(
+				ruisapp::trace_event::wait, //
+				to_wait_ms
+			);
+			wait_set.wait(to_wait_ms);
+		}
+		timer.skip();
 
 		auto triggered_events = wait_set.get_triggered();
 
@@ -393,169 +989,60 @@ int main(int argc, const char** argv)
 			}
 		}
 
-		if (ui_queue_ready_to_read) {
-			while (auto m = glue.ui_queue.pop_front()) {
-				utki::log_debug([](auto& o) {
-					o << "loop message" << std::endl;
-				});
-				m();
+		if (ui_queue_ready_to_read || glue.ui_queue.has_pending(true)) {
+			auto drained = glue.ui_queue.drain(glue.get_ui_queue_budget());
+			if (drained.num_executed != 0) {
+				timer.record_max(
+					ruisapp::frame_phase::ui_queue_latency, //
+					drained.max_latency
+				);
+
+				// posted procedures can change appearance of any window
+				glue.invalidate_all_implicitly();
 			}
 		}
+		timer.lap(ruisapp::frame_phase::ui_queue_drain);
 
-		// NOTE: do not check 'read' flag for X event, for some reason when waiting
-		//       with 0 timeout it will never be set.
-		//       Maybe some bug in XWindows.
-		while (XPending(glue.display.get().xorg_display.display) > 0) {
-			XEvent event;
-			XNextEvent(
-				glue.display.get().xorg_display.display, //
-				&event
-			);
+		monitors_changed = false;
 
-			// get the window the event is sent to
-			auto window = glue.get_window(event.xany.window);
-			if (!window) {
-				continue;
-			}
+		if (glue.input_thread.has_value()) {
+			glue.input_thread.value().queue.acknowledge_wakeup();
+		}
 
-			auto& w = *window;
+		// handling events can lead to new events, so collect until there are none
+		while (collect_xevents()) {
+			auto dispatch_time = std::chrono::steady_clock::now();
+			for (size_t i = 0; i != xevents.size(); ++i) {
+				auto& e = xevents[i];
 
-			switch (event.type) {
-				case Expose:
-					if (event.xexpose.count != 0) {
-						break;
-					}
-					// TODO: instead of rendering, set render needed for this window, when render only if needed is implemented
-					w.render();
-					break;
-				case ConfigureNotify:
-					// squash all window resize events into one, for that store the new
-					// window dimensions and update the viewport later only once
-					w.new_win_dims.x() = ruis::real(event.xconfigure.width);
-					w.new_win_dims.y() = ruis::real(event.xconfigure.height);
-					break;
-				case KeyPress:
-					{
-						// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
-						ruis::key key = key_code_map[std::uint8_t(event.xkey.keycode)];
-
-						w.gui.send_key(
-							ruis::button_action::press, //
-							key
-						);
-
-						key_event_unicode_provider string_provider(
-							w.ruis_native_window, //
-							event.xkey
-						);
-
-						w.gui.send_character_input(
-							string_provider, //
-							key
-						);
-					}
-					break;
-				case KeyRelease:
-					{
-						// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
-						ruis::key key = key_code_map[std::uint8_t(event.xkey.keycode)];
-
-						// detect auto-repeated key events
-						if (XEventsQueued(
-								glue.display.get().xorg_display.display, //
-								QueuedAfterReading
-							))
-						{
-							// there are other events queued
-
-							XEvent nev;
-							XPeekEvent(
-								glue.display.get().xorg_display.display, //
-								&nev
-							);
+				if (glue.input_thread.has_value()) {
+					timer.record_max(
+						ruisapp::frame_phase::input_latency, //
+						dispatch_time - e.receive_time
+					);
+				}
 
-							if (nev.type == KeyPress && nev.xkey.time == event.xkey.time &&
-								nev.xkey.keycode == event.xkey.keycode)
-							{
-								// key wasn't actually released
-								w.gui.send_character_input(
-									key_event_unicode_provider(w.ruis_native_window, nev.xkey), //
-									key
-								);
-
-								// remove the key down event from queue
-								XNextEvent(glue.display.get().xorg_display.display, &nev);
-								break;
-							}
-						}
+				ruisapp::flight_recorder::scope trace_scope(
+					ruisapp::trace_event::native_event, //
+					uint32_t(e.event.type)
+				);
 
-						w.gui.send_key(
-							ruis::button_action::release, //
-							key
-						);
-					}
-					break;
-				case ButtonPress:
-					w.gui.send_mouse_button(
-						ruis::button_action::press, //
-						ruis::vec2(event.xbutton.x, event.xbutton.y),
-						button_number_to_enum(event.xbutton.button),
-						0 // pointer_id
-					);
-					break;
-				case ButtonRelease:
-					w.gui.send_mouse_button(
-						ruis::button_action::release, //
-						ruis::vec2(event.xbutton.x, event.xbutton.y),
-						button_number_to_enum(event.xbutton.button),
-						0 // pointer_id
-					);
-					break;
-				case MotionNotify:
-					w.gui.send_mouse_move(
-						ruis::vec2(
-							event.xmotion.x, //
-							event.xmotion.y
-						), //
-						0 // pointer_id
-					);
-					break;
-				case EnterNotify:
-					w.gui.send_mouse_hover(
-						true, //
-						0 // pointer_id
-					);
-					break;
-				case LeaveNotify:
-					w.gui.send_mouse_hover(
-						false, //
-						0 // pointer_id
-					);
-					break;
-				case ClientMessage:
-					// probably a WM_DELETE_WINDOW event
-					{
-						// NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
-						char* name = XGetAtomName(
-							glue.display.get().xorg_display.display, //
-							event.xclient.message_type
-						);
-						if ("WM_PROTOCOLS"sv == name) {
-							auto& nw = w.ruis_native_window.get();
-							if (nw.close_handler) {
-								nw.close_handler();
-							}
-						}
-						XFree(name);
-					}
-					break;
-				default:
-					// ignore
-					break;
+				const XEvent* next_event = i + 1 == xevents.size() ? nullptr : &xevents[i + 1].event;
+				if (handle_xevent(e.event, next_event)) {
+					++i;
+				}
 			}
 		}
 
+		glue.flush_coalesced_input();
 		glue.apply_new_win_dims();
+		if (monitors_changed) {
+			// monitors were plugged, unplugged or reconfigured
+			glue.update_windows_density();
+		}
+		timer.lap(ruisapp::frame_phase::event_dispatch);
+
+		glue.push_frame_statistics(timer.get_sample());
 	}
 
 	return 0;
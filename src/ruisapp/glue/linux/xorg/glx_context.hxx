@@ -0,0 +1,156 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <array>
+#include <stdexcept>
+
+#include <GL/glx.h>
+#include <utki/flags.hpp>
+#include <utki/string.hpp>
+#include <utki/version.hpp>
+
+#include "../../../startup_profile.hpp"
+
+#include "display.hxx"
+#include "window_visual.hxx"
+
+namespace {
+struct glx_context_wrapper {
+	display_wrapper& display;
+
+	using glx_extension = display_wrapper::glx_extension;
+
+	const utki::flags<glx_extension> supported_extensions;
+
+	const GLXContext context;
+
+	glx_context_wrapper(
+		display_wrapper& display, //
+		const utki::version_duplet& gl_version,
+		const fb_config_wrapper& fb_config,
+		GLXContext shared_context
+	) :
+		display(display),
+		// the extensions string is parsed once per display
+		supported_extensions(this->display.get_supported_glx_extensions()),
+		context([&]() {
+			ruisapp::startup_profile::scope profile_scope(ruisapp::startup_phase::context_creation);
+
+			GLXContext gl_context = nullptr;
+
+			if (this->supported_extensions.get(glx_extension::glx_arb_create_context)) {
+				// GLX_ARB_create_context is supported
+
+				auto glx_create_context_attribs_arb =
+					this->display.get_glx_functions().create_context_attribs_arb;
+
+				if (!glx_create_context_attribs_arb) {
+					// this should not happen since we checked extension presence, and
+					// anyway, glXGetProcAddressARB() never returns nullptr according to
+					// https://dri.freedesktop.org/wiki/glXGetProcAddressNeverReturnsNULL/
+					// so, this check for null is just in case future version of GLX may
+					// return null
+					throw std::runtime_error("glXCreateContextAttribsARB() not found");
+				}
+
+				auto graphics_api_version = [&ver = gl_version]() {
+					if (ver.to_uint32_t() == 0) {
+						// default OpenGL version is 2.0
+						return utki::version_duplet{
+							.major = 2, //
+							.minor = 0
+						};
+					}
+					if (ver.major < 2) {
+						throw std::invalid_argument(
+							utki::cat("minimal supported OpenGL version is 2.0, requested: ", ver)
+						);
+					}
+					return ver;
+				}();
+
+				static const std::array<int, 7> context_attribs = {
+					GLX_CONTEXT_MAJOR_VERSION_ARB,
+					graphics_api_version.major,
+					GLX_CONTEXT_MINOR_VERSION_ARB,
+					graphics_api_version.minor,
+					GLX_CONTEXT_PROFILE_MASK_ARB,
+					// we don't need compatibility context
+					GLX_CONTEXT_CORE_PROFILE_BIT_ARB,
+					None
+				};
+
+				gl_context = glx_create_context_attribs_arb(
+					this->display.xorg_display.display, //
+					fb_config.config,
+					shared_context,
+					GL_TRUE,
+					context_attribs.data()
+				);
+			} else {
+				// GLX_ARB_create_context is not supported
+				gl_context = glXCreateNewContext(
+					this->display.xorg_display.display, //
+					fb_config.config,
+					GLX_RGBA_TYPE,
+					shared_context,
+					GL_TRUE
+				);
+			}
+
+			// sync to ensure any errors generated are processed
+			XSync(
+				this->display.xorg_display.display, //
+				False
+			);
+
+			if (gl_context == nullptr) {
+				throw std::runtime_error("glXCreateContext() failed");
+			}
+
+			return gl_context;
+		}())
+	{}
+
+	glx_context_wrapper(const glx_context_wrapper&) = delete;
+	glx_context_wrapper& operator=(const glx_context_wrapper&) = delete;
+
+	glx_context_wrapper(glx_context_wrapper&&) = delete;
+	glx_context_wrapper& operator=(glx_context_wrapper&&) = delete;
+
+	~glx_context_wrapper()
+	{
+		if (glXGetCurrentContext() == this->context) {
+			glXMakeCurrent(
+				this->display.xorg_display.display, //
+				None,
+				nullptr
+			);
+		}
+		glXDestroyContext(
+			this->display.xorg_display.display, //
+			this->context
+		);
+	}
+};
+} // namespace
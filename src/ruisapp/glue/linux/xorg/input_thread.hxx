@@ -0,0 +1,126 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <thread>
+
+#include <X11/Xlib.h>
+#include <poll.h>
+
+#include "../../input_event_queue.hxx"
+
+namespace {
+/**
+ * @brief Thread reading X events as soon as they arrive.
+ * Requires Xlib to be initialized for multithreading, see XInitThreads().
+ * The events are moved from the Xlib's event queue to the input_event_queue
+ * while holding the display lock. So, the UI thread, also holding the display lock,
+ * can handle events which got into the Xlib's event queue while it was doing
+ * other Xlib calls, without breaking the order of events.
+ */
+class xorg_input_thread
+{
+	Display* const display;
+
+	wakeup_waitable stop_signal;
+	std::atomic_bool quit{false};
+
+public:
+	input_event_queue<XEvent> queue;
+
+private:
+	std::thread thread;
+
+	void run()
+	{
+		std::array<pollfd, 2> fds{};
+		fds[0] = {.fd = XConnectionNumber(this->display), .events = POLLIN, .revents = 0};
+		fds[1] = {.fd = this->stop_signal.get_fd(), .events = POLLIN, .revents = 0};
+
+		while (!this->quit.load()) {
+			bool queue_full = false;
+
+			XLockDisplay(this->display);
+			// XPending() reads events which have arrived to the connection, without blocking
+			while (XPending(this->display) > 0) {
+				if (this->queue.is_full()) {
+					queue_full = true;
+					break;
+				}
+
+				XEvent event;
+				XNextEvent(
+					this->display, //
+					&event
+				);
+				this->queue.push(
+					event, //
+					decltype(this->queue)::clock::now()
+				);
+			}
+			XUnlockDisplay(this->display);
+
+			if (queue_full) {
+				// The UI thread lags behind, let it catch up. Meanwhile, XPending() calls
+				// keep the connection drained by reading the events to the Xlib's event queue.
+				using namespace std::chrono_literals;
+				std::this_thread::sleep_for(1ms);
+				continue;
+			}
+
+			if (poll(
+					fds.data(), //
+					fds.size(),
+					-1 // wait infinitely
+				) < 0)
+			{
+				utki::assert(errno == EINTR, SL);
+			}
+		}
+	}
+
+public:
+	xorg_input_thread(Display* display) :
+		display(display),
+		thread([this]() {
+			this->run();
+		})
+	{}
+
+	xorg_input_thread(const xorg_input_thread&) = delete;
+	xorg_input_thread& operator=(const xorg_input_thread&) = delete;
+
+	xorg_input_thread(xorg_input_thread&&) = delete;
+	xorg_input_thread& operator=(xorg_input_thread&&) = delete;
+
+	~xorg_input_thread()
+	{
+		this->quit.store(true);
+		this->stop_signal.set();
+		this->thread.join();
+	}
+};
+} // namespace
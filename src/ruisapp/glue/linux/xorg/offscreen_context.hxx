@@ -0,0 +1,239 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <array>
+#include <stdexcept>
+
+#include <ruis/render/native_window.hpp>
+#include <utki/shared_ref.hpp>
+#include <utki/version.hpp>
+
+#ifdef RUISAPP_RENDER_OPENGL
+#	include <GL/glx.h>
+
+#	include "../../../startup_profile.hpp"
+
+#	include "glx_context.hxx"
+
+#elif defined(RUISAPP_RENDER_OPENGLES)
+#	include "../../egl_offscreen_context.hxx"
+
+#else
+#	error "Unknown graphics API"
+#endif
+
+#include "display.hxx"
+#include "window_visual.hxx"
+
+namespace {
+
+#ifdef RUISAPP_RENDER_OPENGL
+/**
+ * @brief GL context which is not tied to any window.
+ * Used for GL contexts which are only needed to create GL objects shared with
+ * window contexts, e.g. the shared resources context and the resource loading context.
+ * GLX requires a drawable to bind the context to, so the context is bound with a tiny pbuffer,
+ * which, unlike a window, needs no X visual, colormap and window manager round trips.
+ * Nothing can be presented from the context.
+ */
+class offscreen_context : public ruis::render::native_window
+{
+	const utki::shared_ref<display_wrapper> display;
+
+	const fb_config_wrapper fb_config;
+
+	struct glx_pbuffer_wrapper {
+		display_wrapper& display;
+
+		const GLXPbuffer pbuffer;
+
+		glx_pbuffer_wrapper(
+			display_wrapper& display, //
+			const fb_config_wrapper& fb_config
+		) :
+			display(display),
+			pbuffer([&]() {
+				const std::array<int, 5> attribs = {
+					GLX_PBUFFER_WIDTH,
+					1,
+					GLX_PBUFFER_HEIGHT,
+					1,
+					None
+				};
+
+				auto p = glXCreatePbuffer(
+					this->display.xorg_display.display, //
+					fb_config.config,
+					attribs.data()
+				);
+				if (p == None) {
+					throw std::runtime_error("glXCreatePbuffer() failed");
+				}
+				return p;
+			}())
+		{}
+
+		glx_pbuffer_wrapper(const glx_pbuffer_wrapper&) = delete;
+		glx_pbuffer_wrapper& operator=(const glx_pbuffer_wrapper&) = delete;
+
+		glx_pbuffer_wrapper(glx_pbuffer_wrapper&&) = delete;
+		glx_pbuffer_wrapper& operator=(glx_pbuffer_wrapper&&) = delete;
+
+		~glx_pbuffer_wrapper()
+		{
+			glXDestroyPbuffer(
+				this->display.xorg_display.display, //
+				this->pbuffer
+			);
+		}
+	} glx_pbuffer;
+
+	glx_context_wrapper glx_context;
+
+public:
+	offscreen_context(
+		utki::shared_ref<display_wrapper> display, //
+		const utki::version_duplet& gl_version,
+		const offscreen_context* shared_context
+	) :
+		display(std::move(display)),
+		fb_config(
+			this->display.get().xorg_display, //
+			gl_version,
+			ruisapp::window_parameters{},
+			GLX_PBUFFER_BIT
+		),
+		glx_pbuffer(
+			this->display, //
+			this->fb_config
+		),
+		glx_context(
+			this->display, //
+			gl_version,
+			this->fb_config,
+			shared_context ? shared_context->get_glx_context() : nullptr
+		)
+	{
+		// GLX function addresses do not depend on GL context, so GLEW needs to be initialized only once.
+		// The shared GL context is created before any window and is used by another thread during startup,
+		// so GLEW is initialized here to avoid re-initializing GLEW function pointers while those are in use.
+		static bool glew_initialized = false;
+		if (!glew_initialized) {
+			// if there is no any GL context current, then set this one before calling glewInit()
+			if (glXGetCurrentContext() == nullptr) {
+				this->bind_rendering_context();
+			}
+			ruisapp::startup_profile::scope profile_scope(ruisapp::startup_phase::glew_init);
+			if (glewInit() != GLEW_OK) {
+				throw std::runtime_error("GLEW initialization failed");
+			}
+			glew_initialized = true;
+		}
+	}
+
+	offscreen_context(const offscreen_context&) = delete;
+	offscreen_context& operator=(const offscreen_context&) = delete;
+
+	offscreen_context(offscreen_context&&) = delete;
+	offscreen_context& operator=(offscreen_context&&) = delete;
+
+	~offscreen_context() override = default;
+
+	GLXContext get_glx_context() const noexcept
+	{
+		return this->glx_context.context;
+	}
+
+	r4::vector2<unsigned> get_dims() const noexcept override
+	{
+		return {0, 0};
+	}
+
+	void swap_frame_buffers() override
+	{
+		// nothing to present
+	}
+
+	void bind_rendering_context() override
+	{
+		if (!glXMakeContextCurrent(
+				this->display.get().xorg_display.display, //
+				this->glx_pbuffer.pbuffer,
+				this->glx_pbuffer.pbuffer,
+				this->glx_context.context
+			))
+		{
+			throw std::runtime_error("glXMakeContextCurrent() failed");
+		}
+	}
+
+	bool is_rendering_context_bound() const noexcept override
+	{
+		return glXGetCurrentContext() == this->glx_context.context;
+	}
+
+	/**
+	 * @brief Unbind the context from the calling thread.
+	 * Waits for all GL commands issued in the context to complete, so that GL objects
+	 * created in the context are ready to be used from shared contexts.
+	 * Does nothing if the context is not bound on the calling thread.
+	 */
+	void unbind_rendering_context()
+	{
+		if (!this->is_rendering_context_bound()) {
+			return;
+		}
+		glFinish();
+		glXMakeContextCurrent(
+			this->display.get().xorg_display.display, //
+			None,
+			None,
+			nullptr
+		);
+	}
+
+	void set_vsync_enabled_internal([[maybe_unused]] bool enabled) override
+	{
+		// nothing is presented, so no vsync
+	}
+
+	void set_fullscreen_internal([[maybe_unused]] bool enable) override
+	{
+		// no window, nothing to do
+	}
+
+	void set_mouse_cursor([[maybe_unused]] ruis::mouse_cursor c) override
+	{
+		// no window, nothing to do
+	}
+
+	void set_mouse_cursor_visible([[maybe_unused]] bool visible) override
+	{
+		// no window, nothing to do
+	}
+};
+#elif defined(RUISAPP_RENDER_OPENGLES)
+using offscreen_context = egl_offscreen_context<display_wrapper>;
+#endif
+
+} // namespace
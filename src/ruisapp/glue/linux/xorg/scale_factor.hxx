@@ -0,0 +1,171 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <optional>
+
+#include <r4/vector.hpp>
+#include <ruis/config.hpp>
+#include <utki/util.hpp>
+
+#include <X11/Xlib.h>
+#include <X11/Xresource.h>
+
+namespace {
+namespace scale_factor_detection {
+// DPI which corresponds to the scale factor of 1
+constexpr auto base_dpi = 96;
+
+// Physical DPI starting from which the monitor is considered hi-dpi, same value as GNOME uses.
+constexpr auto hidpi_limit = 192;
+
+// Minimal vertical resolution of a hi-dpi monitor, same value as GNOME uses.
+constexpr auto hidpi_min_height = 1200;
+
+std::optional<ruis::real> get_env_real(const char* name)
+{
+	// NOLINTNEXTLINE(concurrency-mt-unsafe, "environment is not modified concurrently")
+	const char* value = std::getenv(name);
+	if (!value) {
+		return std::nullopt;
+	}
+
+	char* end = nullptr;
+	auto ret = std::strtof(value, &end);
+	if (end == value || !std::isfinite(ret) || ret <= 0) {
+		return std::nullopt;
+	}
+	return ruis::real(ret);
+}
+
+/**
+ * @brief Get Xft.dpi value from X resource database.
+ * Desktop environments set it according to user's display scaling settings.
+ * The resource manager string is fetched by Xlib when opening the display,
+ * so this does not involve any round trips to X server.
+ */
+std::optional<ruis::real> get_xft_dpi(Display* display)
+{
+	const char* resource_string = XResourceManagerString(display);
+	if (!resource_string) {
+		return std::nullopt;
+	}
+
+	XrmInitialize();
+
+	XrmDatabase db = XrmGetStringDatabase(resource_string);
+	if (!db) {
+		return std::nullopt;
+	}
+	utki::scope_exit db_scope_exit([&db]() {
+		XrmDestroyDatabase(db);
+	});
+
+	char* type = nullptr;
+	XrmValue value{};
+	if (!XrmGetResource(db, "Xft.dpi", "Xft.Dpi", &type, &value) || !value.addr) {
+		return std::nullopt;
+	}
+
+	char* end = nullptr;
+	auto dpi = std::strtof(value.addr, &end);
+	if (end == value.addr || !std::isfinite(dpi) || dpi <= 0) {
+		return std::nullopt;
+	}
+	return ruis::real(dpi);
+}
+
+} // namespace scale_factor_detection
+
+/**
+ * @brief Display scale factor settings.
+ * The settings are detected without initializing any toolkit, only data which is
+ * cheap to obtain from X server is used.
+ */
+struct scale_factor_settings {
+	/**
+	 * @brief Scale factor which applies to all monitors.
+	 * Taken from GDK_SCALE environment variable or from Xft.dpi of X resource database.
+	 * If not set, the scale factor is guessed per monitor from its physical DPI.
+	 */
+	std::optional<ruis::real> global_scale_factor;
+
+	/**
+	 * @brief Scale factor multiplier.
+	 * Taken from GDK_DPI_SCALE environment variable.
+	 */
+	ruis::real dpi_scale = 1;
+
+	scale_factor_settings(Display* display)
+	{
+		using namespace scale_factor_detection;
+
+		if (auto gdk_scale = get_env_real("GDK_SCALE")) {
+			// GDK_SCALE only supports integer values
+			this->global_scale_factor = std::max(ruis::real(1), std::round(gdk_scale.value()));
+		} else if (auto xft_dpi = get_xft_dpi(display)) {
+			this->global_scale_factor = xft_dpi.value() / ruis::real(base_dpi);
+		}
+
+		if (auto dpi_scale = get_env_real("GDK_DPI_SCALE")) {
+			this->dpi_scale = dpi_scale.value();
+		}
+	}
+
+	/**
+	 * @brief Get scale factor for a monitor.
+	 * @param resolution - monitor resolution in pixels.
+	 * @param size_mm - monitor physical size in millimeters.
+	 * @return Scale factor for the monitor.
+	 */
+	ruis::real get_scale_factor(
+		const r4::vector2<unsigned>& resolution, //
+		const r4::vector2<unsigned>& size_mm
+	) const
+	{
+		using namespace scale_factor_detection;
+
+		auto scale_factor = [&]() {
+			if (this->global_scale_factor.has_value()) {
+				return this->global_scale_factor.value();
+			}
+
+			// guess scale factor from physical DPI, same heuristic as GNOME uses
+			if (resolution.y() < hidpi_min_height || size_mm.y() == 0) {
+				return ruis::real(1);
+			}
+
+			auto dpi = ruis::real(resolution.y()) * ruis::real(utki::mm_per_inch) / ruis::real(size_mm.y());
+
+			if (dpi < ruis::real(hidpi_limit)) {
+				return ruis::real(1);
+			}
+			return ruis::real(2);
+		}();
+
+		return scale_factor * this->dpi_scale;
+	}
+};
+} // namespace
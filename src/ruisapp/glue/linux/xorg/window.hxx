@@ -21,21 +21,34 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <chrono>
+#include <optional>
+
 #include <X11/Xatom.h>
 #include <X11/Xutil.h>
 
 #ifdef RUISAPP_RENDER_OPENGL
 #	include <GL/glx.h>
 
+#	include "glx_context.hxx"
+
 #elif defined(RUISAPP_RENDER_OPENGLES)
 #	include <EGL/egl.h>
+#	include <GLES2/gl2.h>
+
 #	include "../../egl_utils.hxx"
 
 #else
 #	error "Unknown graphics API"
 #endif
 
+#include "../../../startup_profile.hpp"
+#include "../../fb_config_selector.hxx"
+#include "../../frame_fences.hxx"
+
 #include "display.hxx"
+#include "offscreen_context.hxx"
+#include "window_visual.hxx"
 
 namespace {
 
@@ -43,230 +56,8 @@ class native_window : public ruis::render::native_window
 {
 	utki::shared_ref<display_wrapper> display;
 
-#ifdef RUISAPP_RENDER_OPENGL
-	struct fb_config_wrapper {
-		GLXFBConfig config;
-
-		fb_config_wrapper(
-			display_wrapper& display, //
-			const utki::version_duplet&,
-			const ruisapp::window_parameters& window_params
-		) :
-			config([&]() {
-				GLXFBConfig best_fb_config = nullptr;
-				std::vector<int> visual_attribs;
-				visual_attribs.push_back(GLX_X_RENDERABLE);
-				visual_attribs.push_back(True);
-				visual_attribs.push_back(GLX_X_VISUAL_TYPE);
-				visual_attribs.push_back(GLX_TRUE_COLOR);
-				visual_attribs.push_back(GLX_DRAWABLE_TYPE);
-				visual_attribs.push_back(GLX_WINDOW_BIT);
-				visual_attribs.push_back(GLX_RENDER_TYPE);
-				visual_attribs.push_back(GLX_RGBA_BIT);
-				visual_attribs.push_back(GLX_DOUBLEBUFFER);
-				visual_attribs.push_back(True);
-				visual_attribs.push_back(GLX_RED_SIZE);
-				visual_attribs.push_back(utki::byte_bits);
-				visual_attribs.push_back(GLX_GREEN_SIZE);
-				visual_attribs.push_back(utki::byte_bits);
-				visual_attribs.push_back(GLX_BLUE_SIZE);
-				visual_attribs.push_back(utki::byte_bits);
-				visual_attribs.push_back(GLX_ALPHA_SIZE);
-				visual_attribs.push_back(utki::byte_bits);
-
-				if (window_params.buffers.get(ruisapp::buffer::depth)) {
-					visual_attribs.push_back(GLX_DEPTH_SIZE);
-					visual_attribs.push_back(utki::byte_bits * 3); // 24 bits per pixel for depth buffer
-				}
-				if (window_params.buffers.get(ruisapp::buffer::stencil)) {
-					visual_attribs.push_back(GLX_STENCIL_SIZE);
-					visual_attribs.push_back(utki::byte_bits);
-				}
-
-				visual_attribs.push_back(None);
-
-				utki::span<GLXFBConfig> fb_configs = [&]() {
-					int fbcount = 0;
-					GLXFBConfig* fb_configs = glXChooseFBConfig(
-						display.xorg_display.display,
-						display.xorg_display.get_default_screen(),
-						visual_attribs.data(),
-						&fbcount
-					);
-					if (!fb_configs) {
-						throw std::runtime_error("glXChooseFBConfig() returned empty list");
-					}
-					return utki::make_span(fb_configs, fbcount);
-				}();
-
-				utki::scope_exit scope_exit_fbc([&fb_configs]() {
-					// NOLINTNEXTLINE(bugprone-multi-level-implicit-pointer-conversion)
-					XFree(fb_configs.data());
-				});
-
-				GLXFBConfig worst_fb_config = nullptr;
-				int best_num_samp = -1;
-				// NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
-				int worst_num_samp = 999;
-
-				for (auto fb_config : fb_configs) {
-					XVisualInfo* vi = glXGetVisualFromFBConfig(
-						display.xorg_display.display, //
-						fb_config
-					);
-					if (!vi) {
-						continue;
-					}
-
-					// NOLINTNEXTLINE(cppcoreguidelines-init-variables)
-					int samp_buf;
-					glXGetFBConfigAttrib(
-						display.xorg_display.display, //
-						fb_config,
-						GLX_SAMPLE_BUFFERS,
-						&samp_buf
-					);
-
-					// NOLINTNEXTLINE(cppcoreguidelines-init-variables)
-					int samples;
-					glXGetFBConfigAttrib(
-						display.xorg_display.display, //
-						fb_config,
-						GLX_SAMPLES,
-						&samples
-					);
-
-					if (!best_fb_config || (samp_buf && samples > best_num_samp)) {
-						best_fb_config = fb_config;
-						best_num_samp = samples;
-					}
-					if (!worst_fb_config || !samp_buf || samples < worst_num_samp) {
-						worst_fb_config = fb_config;
-						worst_num_samp = samples;
-					}
-
-					XFree(vi);
-				}
-
-				utki::assert(best_fb_config, SL);
-				return best_fb_config;
-			}())
-		{}
-
-		fb_config_wrapper(const fb_config_wrapper&) = delete;
-		fb_config_wrapper& operator=(const fb_config_wrapper&) = delete;
-
-		fb_config_wrapper(fb_config_wrapper&&) = delete;
-		fb_config_wrapper& operator=(fb_config_wrapper&&) = delete;
-
-		// no need to free fb config
-		~fb_config_wrapper() = default;
-	} fb_config;
-#elif defined(RUISAPP_RENDER_OPENGLES)
-	using fb_config_wrapper = egl_config_wrapper;
-	fb_config_wrapper fb_config;
-#endif
-
-	struct xorg_visual_info_wrapper {
-		XVisualInfo* const visual_info;
-
-		xorg_visual_info_wrapper(
-			display_wrapper& display, //
-			fb_config_wrapper& fb_config
-		) :
-			visual_info([&]() {
-#ifdef RUISAPP_RENDER_OPENGL
-				auto visual_info = glXGetVisualFromFBConfig(
-					display.xorg_display.display, //
-					fb_config.config
-				);
-				if (!visual_info) {
-					throw std::runtime_error("glXGetVisualFromFBConfig() failed");
-				}
-				return visual_info;
-#elif defined(RUISAPP_RENDER_OPENGLES)
-				EGLint vid = 0;
-
-				if (!eglGetConfigAttrib(
-						display.egl_display.display, //
-						fb_config.config,
-						EGL_NATIVE_VISUAL_ID,
-						&vid
-					))
-				{
-					throw std::runtime_error("eglGetConfigAttrib() failed");
-				}
-
-				int num_visuals = 0;
-				XVisualInfo vis_template;
-				vis_template.visualid = vid;
-				auto visual_info = XGetVisualInfo(
-					display.xorg_display.display, //
-					VisualIDMask,
-					&vis_template,
-					&num_visuals
-				);
-				if (!visual_info) {
-					throw std::runtime_error("XGetVisualInfo() failed");
-				}
-				return visual_info;
-#else
-#	error "Unknown graphics API"
-#endif
-			}())
-		{}
-
-		xorg_visual_info_wrapper(const xorg_visual_info_wrapper&) = delete;
-		xorg_visual_info_wrapper& operator=(const xorg_visual_info_wrapper&) = delete;
-
-		xorg_visual_info_wrapper(xorg_visual_info_wrapper&&) = delete;
-		xorg_visual_info_wrapper& operator=(xorg_visual_info_wrapper&&) = delete;
-
-		~xorg_visual_info_wrapper()
-		{
-			XFree(this->visual_info);
-		}
-	} xorg_visual_info;
-
-	struct xorg_color_map_wrapper {
-		display_wrapper& display;
-
-		const Colormap color_map;
-
-		xorg_color_map_wrapper(
-			display_wrapper& display, //
-			xorg_visual_info_wrapper& visual_info
-		) :
-			display(display),
-			color_map([&]() {
-				auto cm = XCreateColormap(
-					this->display.xorg_display.display,
-					this->display.xorg_display.get_root_window(visual_info.visual_info->screen),
-					visual_info.visual_info->visual,
-					AllocNone
-				);
-				if (cm == None) {
-					// TODO: use XSetErrorHandler() to get error code
-					throw std::runtime_error("XCreateColormap(): failed");
-				}
-				return cm;
-			}())
-		{}
-
-		xorg_color_map_wrapper(const xorg_color_map_wrapper&) = delete;
-		xorg_color_map_wrapper& operator=(const xorg_color_map_wrapper&) = delete;
-
-		xorg_color_map_wrapper(xorg_color_map_wrapper&&) = delete;
-		xorg_color_map_wrapper& operator=(xorg_color_map_wrapper&&) = delete;
-
-		~xorg_color_map_wrapper()
-		{
-			XFreeColormap(
-				display.xorg_display.display, //
-				this->color_map
-			);
-		}
-	} xorg_color_map;
+	// shared with other windows created with same framebuffer parameters
+	const window_visual& visual;
 
 	struct xorg_window_wrapper {
 		display_wrapper& display;
@@ -276,33 +67,35 @@ class native_window : public ruis::render::native_window
 		xorg_window_wrapper(
 			display_wrapper& display, //
 			const ruisapp::window_parameters& window_params,
-			xorg_color_map_wrapper& color_map,
-			xorg_visual_info_wrapper& visual_info,
-			bool visible
+			const window_visual& visual
 		) :
 			display(display),
 			window([&]() {
 				XSetWindowAttributes attr;
-				attr.colormap = color_map.color_map;
+				attr.colormap = visual.color_map.color_map;
 				attr.border_pixel = 0;
 				attr.background_pixmap = None;
 				attr.event_mask = ExposureMask | KeyPressMask | KeyReleaseMask | ButtonPressMask | ButtonReleaseMask |
 					PointerMotionMask | ButtonMotionMask | StructureNotifyMask | EnterWindowMask | LeaveWindowMask;
 				unsigned long fields = CWBorderPixel | CWColormap | CWEventMask | CWBackPixmap;
 
-				auto dims = (this->display.scale_factor * window_params.dims.to<ruis::real>()).to<unsigned>();
+				// the window is created at (0, 0), so take scale factor of the monitor it appears on
+				auto scale_factor =
+					this->display.find_monitor({{0, 0}, window_params.dims.to<int>()}).scale_factor;
+
+				auto dims = (scale_factor * window_params.dims.to<ruis::real>()).to<unsigned>();
 
 				auto w = XCreateWindow(
 					this->display.xorg_display.display,
-					this->display.xorg_display.get_root_window(visual_info.visual_info->screen), // parent window
+					this->display.xorg_display.get_root_window(visual.visual_info.visual_info->screen), // parent window
 					0, // x position
 					0, // y position
 					dims.x(), // width
 					dims.y(), // height
 					0, // border width
-					visual_info.visual_info->depth, // window's depth
+					visual.visual_info.visual_info->depth, // window's depth
 					InputOutput, // window's class
-					visual_info.visual_info->visual,
+					visual.visual_info.visual_info->visual,
 					fields, // defined attributes
 					&attr
 				);
@@ -313,11 +106,7 @@ class native_window : public ruis::render::native_window
 			}())
 		{
 			{ // we want to handle WM_DELETE_WINDOW event to know when window is closed
-				Atom a = XInternAtom(
-					this->display.xorg_display.display, //
-					"WM_DELETE_WINDOW",
-					True
-				);
+				Atom a = this->display.atoms.wm_delete_window;
 				XSetWMProtocols(
 					this->display.xorg_display.display, //
 					this->window,
@@ -327,16 +116,8 @@ class native_window : public ruis::render::native_window
 			}
 
 			if (!window_params.taskbar) {
-				Atom wm_state = XInternAtom(
-					this->display.xorg_display.display, //
-					"_NET_WM_STATE",
-					False
-				);
-				Atom skip_taskbar = XInternAtom(
-					this->display.xorg_display.display, //
-					"_NET_WM_STATE_SKIP_TASKBAR",
-					False
-				);
+				Atom wm_state = this->display.atoms.net_wm_state;
+				Atom skip_taskbar = this->display.atoms.net_wm_state_skip_taskbar;
 
 				static_assert(sizeof(skip_taskbar) >= 4, "Atom must be of at least 32-bit size");
 				XChangeProperty(
@@ -352,12 +133,10 @@ class native_window : public ruis::render::native_window
 				);
 			}
 
-			if (visible) {
-				XMapWindow(
-					this->display.xorg_display.display, //
-					this->window
-				);
-			}
+			XMapWindow(
+				this->display.xorg_display.display, //
+				this->window
+			);
 
 			this->display.xorg_display.flush();
 
@@ -386,186 +165,7 @@ class native_window : public ruis::render::native_window
 	} xorg_window;
 
 #ifdef RUISAPP_RENDER_OPENGL
-	struct glx_context_wrapper {
-		display_wrapper& display;
-
-		enum class glx_extension {
-			glx_arb_create_context,
-			glx_ext_swap_control,
-			glx_mesa_swap_control,
-
-			enum_size
-		};
-
-		// glXGetProcAddressARB() will return non-null pointer even if extension is
-		// not supported, so we need to explicitly check for supported extensions.
-		// SOURCE:
-		// https://dri.freedesktop.org/wiki/glXGetProcAddressNeverReturnsNULL/
-		const utki::flags<glx_extension> supported_extensions;
-
-		const GLXContext context;
-
-		glx_context_wrapper(
-			display_wrapper& display, //
-			const xorg_visual_info_wrapper& visual_info,
-			const utki::version_duplet& gl_version,
-			const fb_config_wrapper& fb_config,
-			native_window* shared_gl_context_native_window
-		) :
-			display(display),
-			supported_extensions([&]() {
-				utki::flags<glx_extension> supported = false;
-
-				auto glx_extensions_string = std::string_view(glXQueryExtensionsString(
-					this->display.xorg_display.display, //
-					visual_info.visual_info->screen
-				));
-				utki::log_debug([&](auto& o) {
-					o << "glx_extensions_string = " << glx_extensions_string << std::endl;
-				});
-
-				auto glx_extensions = utki::split(glx_extensions_string);
-
-				using namespace std::string_view_literals;
-
-				if (std::ranges::find(
-						glx_extensions, //
-						"GLX_ARB_create_context"sv
-					) != glx_extensions.end())
-				{
-					supported.set(glx_extension::glx_arb_create_context);
-				}
-
-				if (std::ranges::find(
-						glx_extensions, //
-						"GLX_EXT_swap_control"sv
-					) != glx_extensions.end())
-				{
-					supported.set(glx_extension::glx_ext_swap_control);
-				}
-
-				if (std::ranges::find( //
-						glx_extensions,
-						"GLX_MESA_swap_control"sv
-					) != glx_extensions.end())
-				{
-					supported.set(glx_extension::glx_mesa_swap_control);
-				}
-
-				return supported;
-			}()),
-			context([&]() {
-				GLXContext gl_context = nullptr;
-
-				GLXContext shared_glx_context = [&]() -> GLXContext {
-					if (shared_gl_context_native_window) {
-						return shared_gl_context_native_window->glx_context.context;
-					}
-					return nullptr;
-				}();
-
-				if (this->supported_extensions.get(glx_extension::glx_arb_create_context)) {
-					// GLX_ARB_create_context is supported
-
-					// NOTE: glXGetProcAddressARB() is guaranteed to be present in all GLX
-					// versions.
-					//       glXGetProcAddress() is not guaranteed.
-					// SOURCE:
-					// https://dri.freedesktop.org/wiki/glXGetProcAddressNeverReturnsNULL/
-
-					auto glx_create_context_attribs_arb = PFNGLXCREATECONTEXTATTRIBSARBPROC(glXGetProcAddressARB(
-						// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-						reinterpret_cast<const GLubyte*>("glXCreateContextAttribsARB")
-					));
-
-					if (!glx_create_context_attribs_arb) {
-						// this should not happen since we checked extension presence, and
-						// anyway, glXGetProcAddressARB() never returns nullptr according to
-						// https://dri.freedesktop.org/wiki/glXGetProcAddressNeverReturnsNULL/
-						// so, this check for null is just in case future version of GLX may
-						// return null
-						throw std::runtime_error("glXCreateContextAttribsARB() not found");
-					}
-
-					auto graphics_api_version = [&ver = gl_version]() {
-						if (ver.to_uint32_t() == 0) {
-							// default OpenGL version is 2.0
-							return utki::version_duplet{
-								.major = 2, //
-								.minor = 0
-							};
-						}
-						if (ver.major < 2) {
-							throw std::invalid_argument(
-								utki::cat("minimal supported OpenGL version is 2.0, requested: ", ver)
-							);
-						}
-						return ver;
-					}();
-
-					static const std::array<int, 7> context_attribs = {
-						GLX_CONTEXT_MAJOR_VERSION_ARB,
-						graphics_api_version.major,
-						GLX_CONTEXT_MINOR_VERSION_ARB,
-						graphics_api_version.minor,
-						GLX_CONTEXT_PROFILE_MASK_ARB,
-						// we don't need compatibility context
-						GLX_CONTEXT_CORE_PROFILE_BIT_ARB,
-						None
-					};
-
-					gl_context = glx_create_context_attribs_arb(
-						this->display.xorg_display.display, //
-						fb_config.config,
-						shared_glx_context,
-						GL_TRUE,
-						context_attribs.data()
-					);
-				} else {
-					// GLX_ARB_create_context is not supported
-					gl_context = glXCreateContext(
-						this->display.xorg_display.display, //
-						visual_info.visual_info,
-						shared_glx_context,
-						GL_TRUE
-					);
-				}
-
-				// sync to ensure any errors generated are processed
-				XSync(
-					this->display.xorg_display.display, //
-					False
-				);
-
-				if (gl_context == nullptr) {
-					throw std::runtime_error("glXCreateContext() failed");
-				}
-
-				return gl_context;
-			}())
-		{}
-
-		glx_context_wrapper(const glx_context_wrapper&) = delete;
-		glx_context_wrapper& operator=(const glx_context_wrapper&) = delete;
-
-		glx_context_wrapper(glx_context_wrapper&&) = delete;
-		glx_context_wrapper& operator=(glx_context_wrapper&&) = delete;
-
-		~glx_context_wrapper()
-		{
-			if (glXGetCurrentContext() == this->context) {
-				glXMakeCurrent(
-					this->display.xorg_display.display, //
-					None,
-					nullptr
-				);
-			}
-			glXDestroyContext(
-				this->display.xorg_display.display, //
-				this->context
-			);
-		}
-	} glx_context;
+	glx_context_wrapper glx_context;
 
 #elif defined(RUISAPP_RENDER_OPENGLES)
 	egl_surface_wrapper egl_surface;
@@ -612,74 +212,99 @@ class native_window : public ruis::render::native_window
 		}
 	} xorg_input_context;
 
+	const ruisapp::presentation_mode presentation;
+	const unsigned max_frames_in_flight;
+
+#ifdef RUISAPP_RENDER_OPENGL
+	struct gl_fence_api {
+		using fence_type = GLsync;
+
+		bool is_supported() const noexcept
+		{
+			// fences are available starting from OpenGL 3.2 or via GL_ARB_sync extension
+			return GLEW_ARB_sync;
+		}
+
+		fence_type insert()
+		{
+			return glFenceSync(
+				GL_SYNC_GPU_COMMANDS_COMPLETE, //
+				0 // flags, must be 0
+			);
+		}
+
+		void wait(
+			fence_type fence, //
+			std::chrono::nanoseconds timeout
+		)
+		{
+			glClientWaitSync(
+				fence, //
+				GL_SYNC_FLUSH_COMMANDS_BIT,
+				GLuint64(timeout.count())
+			);
+		}
+
+		void destroy(fence_type fence)
+		{
+			glDeleteSync(fence);
+		}
+	};
+
+	frame_fences<gl_fence_api> fences;
+#elif defined(RUISAPP_RENDER_OPENGLES)
+	frame_fences<egl_fence_api> fences;
+#endif
+
 public:
 	native_window(
 		utki::shared_ref<display_wrapper> display, //
 		const utki::version_duplet& gl_version,
 		const ruisapp::window_parameters& window_params,
-		native_window* shared_gl_context_native_window
+		const offscreen_context& shared_context
 	) :
 		display(std::move(display)),
-		fb_config(
-#ifdef RUISAPP_RENDER_OPENGL
-			this->display,
-#elif defined(RUISAPP_RENDER_OPENGLES)
-			this->display.get().egl_display,
-#endif
-			gl_version,
+		visual(this->display.get().get_window_visual(
+			gl_version, //
 			window_params
-		),
-		xorg_visual_info(
-			this->display, //
-			this->fb_config
-		),
-		xorg_color_map(
-			this->display, //
-			this->xorg_visual_info
-		),
+		)),
 		xorg_window(
 			this->display, //
 			window_params,
-			this->xorg_color_map,
-			this->xorg_visual_info,
-			shared_gl_context_native_window != nullptr
+			this->visual
 		),
 #ifdef RUISAPP_RENDER_OPENGL
 		glx_context(
 			this->display, //
-			this->xorg_visual_info,
 			gl_version,
-			this->fb_config,
-			shared_gl_context_native_window
+			this->visual.fb_config,
+			shared_context.get_glx_context()
 		),
 #elif defined(RUISAPP_RENDER_OPENGLES)
 		egl_surface(
 			this->display.get().egl_display, //
-			this->fb_config,
+			this->visual.fb_config,
 			this->xorg_window.window
 		),
 		egl_context(
 			this->display.get().egl_display, //
 			gl_version,
-			this->fb_config,
-			shared_gl_context_native_window ? shared_gl_context_native_window->egl_context.context : EGL_NO_CONTEXT
+			this->visual.fb_config,
+			shared_context.get_egl_context()
 		),
 #endif
 		xorg_input_context(
 			this->display, //
 			this->xorg_window
-		)
-	{
+		),
+		presentation(window_params.presentation),
+		max_frames_in_flight(window_params.max_frames_in_flight),
 #ifdef RUISAPP_RENDER_OPENGL
-		// if there is no any GL context current, then set this one before calling glewInit()
-		if (glXGetCurrentContext() == nullptr) {
-			this->bind_rendering_context();
-		}
-		if (glewInit() != GLEW_OK) {
-			throw std::runtime_error("GLEW initialization failed");
-		}
+		fences(gl_fence_api{})
+#elif defined(RUISAPP_RENDER_OPENGLES)
+		fences(egl_fence_api{.egl_display = this->display.get().egl_display})
 #endif
-	}
+	{}
 
 	native_window(const native_window&) = delete;
 	native_window& operator=(const native_window&) = delete;
@@ -690,6 +315,18 @@ public:
 	~native_window() override = default;
 
 	void set_vsync_enabled_internal(bool enable) override
+	{
+		this->set_swap_interval(enable);
+	}
+
+private:
+	// whether swapping frame buffers currently waits for vblank
+	bool swap_waits_for_vblank = false;
+
+	// whether the next frame buffers swap should wait for vblank, in case vsync is enabled
+	bool wait_for_vblank = true;
+
+	void set_swap_interval(bool enable)
 	{
 		utki::assert(
 			[this]() {
@@ -705,10 +342,7 @@ public:
 				o << "GLX_EXT_swap_control is supported\n";
 			});
 
-			auto glx_swap_interval_ext = PFNGLXSWAPINTERVALEXTPROC(glXGetProcAddressARB(
-				// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-				reinterpret_cast<const GLubyte*>("glXSwapIntervalEXT")
-			));
+			auto glx_swap_interval_ext = this->display.get().get_glx_functions().swap_interval_ext;
 
 			utki::assert(glx_swap_interval_ext, SL);
 
@@ -725,10 +359,7 @@ public:
 				o << "GLX_MESA_swap_control is supported\n";
 			});
 
-			auto glx_swap_interval_mesa = PFNGLXSWAPINTERVALMESAPROC(glXGetProcAddressARB(
-				// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-				reinterpret_cast<const GLubyte*>("glXSwapIntervalMESA")
-			));
+			auto glx_swap_interval_mesa = this->display.get().get_glx_functions().swap_interval_mesa;
 
 			utki::assert(glx_swap_interval_mesa, SL);
 
@@ -743,12 +374,6 @@ public:
 			std::cout << "none of GLX_EXT_swap_control, GLX_MESA_swap_control GLX "
 					  << "extensions are supported. Not disabling v-sync." << std::endl;
 		}
-
-		// sync to ensure any errors generated are processed
-		XSync(
-			this->display.get().xorg_display.display, //
-			False
-		);
 #elif defined(RUISAPP_RENDER_OPENGLES)
 		utki::logcat_debug("eglSwapInterval(", enable ? "true" : "false", ")\n");
 		if (eglSwapInterval(
@@ -758,17 +383,130 @@ public:
 		{
 			utki::logcat("WARNING: eglSwapInterval(", enable, ") failed");
 		}
+#endif
+		this->swap_waits_for_vblank = enable;
+	}
+
+public:
+	/**
+	 * @brief Set whether the next frame buffers swap should wait for vblank.
+	 * Has effect only if vsync is enabled for the window.
+	 * Used to make only one of the windows rendered in a main loop iteration wait for vblank.
+	 * @param wait - whether to wait for vblank.
+	 */
+	void set_wait_for_vblank(bool wait) noexcept
+	{
+		this->wait_for_vblank = wait;
+	}
+
+	/**
+	 * @brief Timings of the last frame buffers swap.
+	 */
+	struct swap_timings {
+		// time when the swap was requested
+		std::chrono::steady_clock::time_point start;
+
+		// time when the frame was presented, in case the swap waited for vblank
+		std::optional<std::chrono::steady_clock::time_point> vblank;
+	};
+
+	const swap_timings& get_last_swap_timings() const noexcept
+	{
+		return this->last_swap;
+	}
+
+	/**
+	 * @brief Get refresh period of the display the window is shown on.
+	 * @return Refresh period, if reported by the graphics API.
+	 */
+	std::optional<std::chrono::nanoseconds> get_refresh_period()
+	{
+#ifdef RUISAPP_RENDER_OPENGL
+		if (!this->glx_context.supported_extensions.get(glx_context_wrapper::glx_extension::glx_oml_sync_control)) {
+			return {};
+		}
+
+		auto glx_get_msc_rate_oml = this->display.get().get_glx_functions().get_msc_rate_oml;
+		utki::assert(glx_get_msc_rate_oml, SL);
+
+		int32_t numerator = 0;
+		int32_t denominator = 0;
+		if (!glx_get_msc_rate_oml(
+				this->display.get().xorg_display.display, //
+				this->xorg_window.window,
+				&numerator,
+				&denominator
+			) ||
+			numerator <= 0 || denominator <= 0)
+		{
+			return {};
+		}
+
+		// numerator / denominator is the refresh rate in Hz
+		using namespace std::chrono_literals;
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(1s) * denominator / numerator;
+#else
+		return {};
 #endif
 	}
 
 	void swap_frame_buffers() override
 	{
+		this->update_swap_interval();
+
+		this->last_swap.start = std::chrono::steady_clock::now();
+
 #ifdef RUISAPP_RENDER_OPENGL
 		glXSwapBuffers(
 			this->display.get().xorg_display.display, //
 			this->xorg_window.window
 		);
-		if (this->is_vsync_enabled()) {
+#elif defined(RUISAPP_RENDER_OPENGLES)
+		this->egl_surface.swap_frame_buffers();
+#else
+#	error "Unknown graphics API"
+#endif
+		this->limit_frames_in_flight();
+	}
+
+	bool has_frame_fences() const noexcept
+	{
+		return this->fences.has_fences();
+	}
+
+	/**
+	 * @brief Destroy fences of the presented frames.
+	 * Must be called with the window's rendering context bound.
+	 */
+	void release_frame_fences()
+	{
+		this->fences.release();
+	}
+
+private:
+	swap_timings last_swap;
+
+	void update_swap_interval()
+	{
+		// the rendering context is bound at this point, so the swap interval can be changed if needed
+		if (bool wait = this->wait_for_vblank && this->is_vsync_enabled(); wait != this->swap_waits_for_vblank) {
+			this->set_swap_interval(wait);
+		}
+	}
+
+	void limit_frames_in_flight()
+	{
+		this->last_swap.vblank.reset();
+
+		if (this->presentation == ruisapp::presentation_mode::throughput) {
+			if (this->fences.on_frame_presented(this->max_frames_in_flight)) {
+				return;
+			}
+			// fences are not supported, fall back to low latency mode
+		}
+
+#ifdef RUISAPP_RENDER_OPENGL
+		if (this->swap_waits_for_vblank) {
 			// With glFinish() call here it works better when VSYNC is enabled.
 			// This is noticable when an app renders a mouse cursor itself,
 			// the cursor moves with less latency.
@@ -776,14 +514,58 @@ public:
 			// right after swapping buffers, if calling it before swapping buffers,
 			// the effect is not present.
 			glFinish();
+
+			// glFinish() returns once the swap is done, i.e. at vblank
+			this->last_swap.vblank = std::chrono::steady_clock::now();
 		}
+#endif
+	}
+
+public:
+	void swap_frame_buffers([[maybe_unused]] utki::span<const r4::rectangle<int>> damage)
+	{
+#ifdef RUISAPP_RENDER_OPENGL
+		// GLX has no way to pass damage information to the X server
+		this->swap_frame_buffers();
 #elif defined(RUISAPP_RENDER_OPENGLES)
-		this->egl_surface.swap_frame_buffers();
+		this->update_swap_interval();
+		this->last_swap.start = std::chrono::steady_clock::now();
+		this->egl_surface.swap_frame_buffers(damage);
+		this->limit_frames_in_flight();
 #else
 #	error "Unknown graphics API"
 #endif
 	}
 
+	unsigned get_buffer_age()
+	{
+#ifdef RUISAPP_RENDER_OPENGL
+		if (!this->glx_context.supported_extensions.get(glx_context_wrapper::glx_extension::glx_ext_buffer_age)) {
+			return 0;
+		}
+
+		unsigned age = 0;
+		glXQueryDrawable(
+			this->display.get().xorg_display.display, //
+			this->xorg_window.window,
+			GLX_BACK_BUFFER_AGE_EXT,
+			&age
+		);
+		return age;
+#elif defined(RUISAPP_RENDER_OPENGLES)
+		return this->egl_surface.get_buffer_age();
+#else
+#	error "Unknown graphics API"
+#endif
+	}
+
+	void set_repaint_region([[maybe_unused]] const r4::rectangle<int>& region)
+	{
+#ifdef RUISAPP_RENDER_OPENGLES
+		this->egl_surface.set_repaint_region(region);
+#endif
+	}
+
 	static_assert(std::is_integral_v<::Window>, "xorg lib's Window type is unexpectedly not integral");
 	using window_id_type = ::Window;
 
@@ -792,18 +574,34 @@ public:
 		return this->xorg_window.window;
 	}
 
-	void set_fullscreen_internal(bool enable) override
+	/**
+	 * @brief Get window position on the root window.
+	 * Window manager usually reparents the window, so the position reported by ConfigureNotify
+	 * is relative to window manager's frame. This function queries the actual position from X server.
+	 * @return Position of window's top left corner on the root window, in pixels.
+	 */
+	r4::vector2<int> get_position_on_root()
 	{
-		Atom state_atom = XInternAtom(
-			this->display.get().xorg_display.display, //
-			"_NET_WM_STATE",
-			False
-		);
-		Atom atom = XInternAtom(
-			this->display.get().xorg_display.display, //
-			"_NET_WM_STATE_FULLSCREEN",
-			False
+		int x = 0;
+		int y = 0;
+		::Window child = 0;
+		XTranslateCoordinates(
+			this->display.get().xorg_display.display,
+			this->xorg_window.window,
+			this->display.get().xorg_display.get_default_root_window(),
+			0,
+			0,
+			&x,
+			&y,
+			&child
 		);
+		return {x, y};
+	}
+
+	void set_fullscreen_internal(bool enable) override
+	{
+		Atom state_atom = this->display.get().atoms.net_wm_state;
+		Atom atom = this->display.get().atoms.net_wm_state_fullscreen;
 
 		XEvent event;
 		event.xclient.type = ClientMessage;
@@ -970,6 +768,34 @@ private:
 		return glXGetCurrentContext() == this->glx_context.context;
 #elif defined(RUISAPP_RENDER_OPENGLES)
 		return eglGetCurrentContext() == this->egl_context.context;
+#endif
+	}
+
+	/**
+	 * @brief Unbind the window's rendering context from the calling thread.
+	 * Waits for all GL commands issued in the context to complete, so that GL objects
+	 * created in the context are ready to be used from shared contexts.
+	 * Does nothing if the window's rendering context is not bound on the calling thread.
+	 */
+	void unbind_rendering_context()
+	{
+		if (!this->is_rendering_context_bound()) {
+			return;
+		}
+		glFinish();
+#ifdef RUISAPP_RENDER_OPENGL
+		glXMakeCurrent(
+			this->display.get().xorg_display.display, //
+			None,
+			nullptr
+		);
+#elif defined(RUISAPP_RENDER_OPENGLES)
+		eglMakeCurrent(
+			this->display.get().egl_display.display,
+			EGL_NO_SURFACE,
+			EGL_NO_SURFACE,
+			EGL_NO_CONTEXT
+		);
 #endif
 	}
 };
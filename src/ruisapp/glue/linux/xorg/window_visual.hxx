@@ -0,0 +1,367 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include <utki/debug.hpp>
+#include <utki/span.hpp>
+#include <utki/util.hpp>
+#include <utki/version.hpp>
+
+#include <X11/Xutil.h>
+
+#ifdef RUISAPP_RENDER_OPENGL
+#	include <GL/glx.h>
+
+#elif defined(RUISAPP_RENDER_OPENGLES)
+#	include "../../egl_utils.hxx"
+
+#else
+#	error "Unknown graphics API"
+#endif
+
+#include "../../../startup_profile.hpp"
+#include "../../../window.hpp"
+#include "../../fb_config_selector.hxx"
+
+#include "xorg_display_wrapper.hxx"
+
+namespace {
+
+#ifdef RUISAPP_RENDER_OPENGL
+struct fb_config_wrapper {
+	GLXFBConfig config;
+
+	fb_config_wrapper(
+		xorg_display_wrapper& display, //
+		const utki::version_duplet&,
+		const ruisapp::window_parameters& window_params,
+		int drawable_type = GLX_WINDOW_BIT
+	) :
+		config([&]() {
+			ruisapp::startup_profile::scope profile_scope(ruisapp::startup_phase::config_choice);
+
+			auto request = make_fb_config_request(
+				window_params, //
+				utki::byte_bits * 3 // 24 bits per pixel for depth buffer
+			);
+
+			// Request only the minimal requirements, glXChooseFBConfig() sorts matching configs
+			// by its own criteria, e.g. it puts configs with deeper color buffer first,
+			// so the cheapest one is selected afterwards.
+			const bool for_window = (drawable_type & GLX_WINDOW_BIT) != 0;
+
+			std::vector<int> visual_attribs;
+			if (for_window) {
+				visual_attribs.push_back(GLX_X_RENDERABLE);
+				visual_attribs.push_back(True);
+				visual_attribs.push_back(GLX_X_VISUAL_TYPE);
+				visual_attribs.push_back(GLX_TRUE_COLOR);
+				visual_attribs.push_back(GLX_DOUBLEBUFFER);
+				visual_attribs.push_back(True);
+			}
+			visual_attribs.push_back(GLX_DRAWABLE_TYPE);
+			visual_attribs.push_back(drawable_type);
+			visual_attribs.push_back(GLX_RENDER_TYPE);
+			visual_attribs.push_back(GLX_RGBA_BIT);
+			visual_attribs.push_back(GLX_RED_SIZE);
+			visual_attribs.push_back(int(request.red_bits));
+			visual_attribs.push_back(GLX_GREEN_SIZE);
+			visual_attribs.push_back(int(request.green_bits));
+			visual_attribs.push_back(GLX_BLUE_SIZE);
+			visual_attribs.push_back(int(request.blue_bits));
+			visual_attribs.push_back(GLX_ALPHA_SIZE);
+			visual_attribs.push_back(int(request.alpha_bits));
+			visual_attribs.push_back(GLX_DEPTH_SIZE);
+			visual_attribs.push_back(int(request.depth_bits));
+			visual_attribs.push_back(GLX_STENCIL_SIZE);
+			visual_attribs.push_back(int(request.stencil_bits));
+
+			visual_attribs.push_back(None);
+
+			utki::span<GLXFBConfig> fb_configs = [&]() {
+				int fbcount = 0;
+				GLXFBConfig* fb_configs = glXChooseFBConfig(
+					display.display,
+					display.get_default_screen(),
+					visual_attribs.data(),
+					&fbcount
+				);
+				if (!fb_configs) {
+					throw std::runtime_error("glXChooseFBConfig() returned empty list");
+				}
+				return utki::make_span(fb_configs, fbcount);
+			}();
+
+			utki::scope_exit scope_exit_fbc([&fb_configs]() {
+				// NOLINTNEXTLINE(bugprone-multi-level-implicit-pointer-conversion)
+				XFree(fb_configs.data());
+			});
+
+			// usable configs, i.e. the ones which have X visual in case of window, with their attributes
+			std::vector<GLXFBConfig> configs;
+			std::vector<fb_config_attribs> candidates;
+
+			for (auto fb_config : fb_configs) {
+				if (for_window) {
+					XVisualInfo* vi = glXGetVisualFromFBConfig(
+						display.display, //
+						fb_config
+					);
+					if (!vi) {
+						continue;
+					}
+					XFree(vi);
+				}
+
+				auto get_attrib = [&](int attrib) {
+					int value = 0;
+					glXGetFBConfigAttrib(
+						display.display, //
+						fb_config,
+						attrib,
+						&value
+					);
+					return value;
+				};
+
+				configs.push_back(fb_config);
+				candidates.push_back({
+					.red_bits = unsigned(get_attrib(GLX_RED_SIZE)),
+					.green_bits = unsigned(get_attrib(GLX_GREEN_SIZE)),
+					.blue_bits = unsigned(get_attrib(GLX_BLUE_SIZE)),
+					.alpha_bits = unsigned(get_attrib(GLX_ALPHA_SIZE)),
+					.depth_bits = unsigned(get_attrib(GLX_DEPTH_SIZE)),
+					.stencil_bits = unsigned(get_attrib(GLX_STENCIL_SIZE)),
+					.num_samples = get_attrib(GLX_SAMPLE_BUFFERS) == 0 ? 0 : unsigned(get_attrib(GLX_SAMPLES)),
+					.slow = get_attrib(GLX_CONFIG_CAVEAT) == GLX_SLOW_CONFIG
+				});
+			}
+
+			auto selected = select_fb_config(
+				request, //
+				candidates
+			);
+			if (!selected.has_value()) {
+				throw std::runtime_error("glXChooseFBConfig() returned no usable config");
+			}
+
+			return configs[selected.value()];
+		}())
+	{}
+
+	fb_config_wrapper(const fb_config_wrapper&) = delete;
+	fb_config_wrapper& operator=(const fb_config_wrapper&) = delete;
+
+	fb_config_wrapper(fb_config_wrapper&&) = delete;
+	fb_config_wrapper& operator=(fb_config_wrapper&&) = delete;
+
+	// no need to free fb config
+	~fb_config_wrapper() = default;
+};
+#elif defined(RUISAPP_RENDER_OPENGLES)
+using fb_config_wrapper = egl_config_wrapper;
+#endif
+
+struct xorg_visual_info_wrapper {
+	XVisualInfo* const visual_info;
+
+	xorg_visual_info_wrapper(
+		xorg_display_wrapper& display, //
+#ifdef RUISAPP_RENDER_OPENGLES
+		egl_display_wrapper& egl_display,
+#endif
+		const fb_config_wrapper& fb_config
+	) :
+		visual_info([&]() {
+#ifdef RUISAPP_RENDER_OPENGL
+			auto visual_info = glXGetVisualFromFBConfig(
+				display.display, //
+				fb_config.config
+			);
+			if (!visual_info) {
+				throw std::runtime_error("glXGetVisualFromFBConfig() failed");
+			}
+			return visual_info;
+#elif defined(RUISAPP_RENDER_OPENGLES)
+			EGLint vid = 0;
+
+			if (!eglGetConfigAttrib(
+					egl_display.display, //
+					fb_config.config,
+					EGL_NATIVE_VISUAL_ID,
+					&vid
+				))
+			{
+				throw std::runtime_error("eglGetConfigAttrib() failed");
+			}
+
+			int num_visuals = 0;
+			XVisualInfo vis_template;
+			vis_template.visualid = vid;
+			auto visual_info = XGetVisualInfo(
+				display.display, //
+				VisualIDMask,
+				&vis_template,
+				&num_visuals
+			);
+			if (!visual_info) {
+				throw std::runtime_error("XGetVisualInfo() failed");
+			}
+			return visual_info;
+#else
+#	error "Unknown graphics API"
+#endif
+		}())
+	{}
+
+	xorg_visual_info_wrapper(const xorg_visual_info_wrapper&) = delete;
+	xorg_visual_info_wrapper& operator=(const xorg_visual_info_wrapper&) = delete;
+
+	xorg_visual_info_wrapper(xorg_visual_info_wrapper&&) = delete;
+	xorg_visual_info_wrapper& operator=(xorg_visual_info_wrapper&&) = delete;
+
+	~xorg_visual_info_wrapper()
+	{
+		XFree(this->visual_info);
+	}
+};
+
+struct xorg_color_map_wrapper {
+	xorg_display_wrapper& display;
+
+	const Colormap color_map;
+
+	xorg_color_map_wrapper(
+		xorg_display_wrapper& display, //
+		const xorg_visual_info_wrapper& visual_info
+	) :
+		display(display),
+		color_map([&]() {
+			auto cm = XCreateColormap(
+				this->display.display,
+				this->display.get_root_window(visual_info.visual_info->screen),
+				visual_info.visual_info->visual,
+				AllocNone
+			);
+			if (cm == None) {
+				// TODO: use XSetErrorHandler() to get error code
+				throw std::runtime_error("XCreateColormap(): failed");
+			}
+			return cm;
+		}())
+	{}
+
+	xorg_color_map_wrapper(const xorg_color_map_wrapper&) = delete;
+	xorg_color_map_wrapper& operator=(const xorg_color_map_wrapper&) = delete;
+
+	xorg_color_map_wrapper(xorg_color_map_wrapper&&) = delete;
+	xorg_color_map_wrapper& operator=(xorg_color_map_wrapper&&) = delete;
+
+	~xorg_color_map_wrapper()
+	{
+		XFreeColormap(
+			display.display, //
+			this->color_map
+		);
+	}
+};
+
+/**
+ * @brief Framebuffer config, X visual and colormap for windows.
+ * Choosing framebuffer config requires enumerating all the configs the graphics API has,
+ * so the window visuals are created once for each distinct set of framebuffer related
+ * window parameters and are shared by all the windows created with such parameters.
+ */
+struct window_visual {
+	using key_type = std::tuple<
+		uint32_t, // graphics API version
+		bool, // depth buffer
+		bool, // stencil buffer
+		unsigned, // depth bits
+		unsigned, // alpha bits
+		unsigned // number of samples
+		>;
+
+	static key_type make_key(
+		const utki::version_duplet& gl_version, //
+		const ruisapp::window_parameters& window_params
+	)
+	{
+		return {
+			gl_version.to_uint32_t(),
+			window_params.buffers.get(ruisapp::buffer::depth),
+			window_params.buffers.get(ruisapp::buffer::stencil),
+			window_params.depth_bits,
+			window_params.alpha_bits,
+			window_params.num_samples
+		};
+	}
+
+	const fb_config_wrapper fb_config;
+	const xorg_visual_info_wrapper visual_info;
+	const xorg_color_map_wrapper color_map;
+
+	window_visual(
+		xorg_display_wrapper& display, //
+#ifdef RUISAPP_RENDER_OPENGLES
+		egl_display_wrapper& egl_display,
+#endif
+		const utki::version_duplet& gl_version,
+		const ruisapp::window_parameters& window_params
+	) :
+		fb_config(
+#ifdef RUISAPP_RENDER_OPENGL
+			display,
+#elif defined(RUISAPP_RENDER_OPENGLES)
+			egl_display,
+#endif
+			gl_version,
+			window_params
+		),
+		visual_info(
+			display, //
+#ifdef RUISAPP_RENDER_OPENGLES
+			egl_display,
+#endif
+			this->fb_config
+		),
+		color_map(
+			display, //
+			this->visual_info
+		)
+	{}
+
+	window_visual(const window_visual&) = delete;
+	window_visual& operator=(const window_visual&) = delete;
+
+	window_visual(window_visual&&) = delete;
+	window_visual& operator=(window_visual&&) = delete;
+
+	~window_visual() = default;
+};
+
+} // namespace
@@ -32,6 +32,10 @@ struct xorg_display_wrapper {
 
 	xorg_display_wrapper() :
 		display([]() {
+			// Xlib is used from several threads, e.g. GL on the shared GL resources initialization thread.
+			// So, enable Xlib thread safety. This must be done before any other Xlib call.
+			XInitThreads();
+
 			auto d = XOpenDisplay(nullptr);
 			if (!d) {
 				throw std::runtime_error("XOpenDisplay() failed");
@@ -24,6 +24,7 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #include <ruis/render/opengl/context.hpp>
 #include <ruis/widget/widget.hpp>
 
+
 namespace {
 ruis::real get_dots_per_inch()
 {
@@ -80,7 +81,7 @@ void app_window::resize(const ruis::vec2& dims)
 
 	// std::cout << "app_window::resize(): new window dims = " << dims << ", scale = " << natwin.get_scale() << ", dpi = " << natwin.get_dpi() << std::endl;
 
-	this->gui.set_viewport( //
+	this->set_viewport( //
 		ruis::rect(
 			0, //
 			(dims * units.dots_per_pp()).template to<ruis::real>()
@@ -136,19 +137,8 @@ ruisapp::window& application_glue::make_window(ruisapp::window_parameters window
 
 	auto ruis_context = utki::make_shared<ruis::context>(ruis::context::parameters{
 		.post_to_ui_thread_function =
-			[this](std::function<void()> a) {
-				NSEvent* e =
-					[NSEvent otherEventWithType:NSEventTypeApplicationDefined
-									   location:NSMakePoint(0, 0)
-								  modifierFlags:0
-									  timestamp:0
-								   windowNumber:0
-										context:nil
-										subtype:0
-										  data1:reinterpret_cast<NSInteger>(new std::function<void()>(std::move(a)))
-										  data2:0];
-
-				[this->macos_application.application postEvent:e atStart:NO];
+			[](std::function<void()> procedure) {
+				ruisapp::inst().post_to_ui_thread(std::move(procedure));
 			},
 		.updater = this->updater,
 		.renderer = utki::make_shared<ruis::render::renderer>(
@@ -175,7 +165,7 @@ ruisapp::window& application_glue::make_window(ruisapp::window_parameters window
 	units.set_dots_per_pp(natwin.get_scale());
 	units.set_dots_per_inch(natwin.get_dpi());
 
-	ruisapp_window.get().gui.set_viewport( //
+	ruisapp_window.get().set_viewport( //
 		ruis::rect(
 			0, //
 			window_params.dims.to<ruis::real>() * units.dots_per_pp()
@@ -225,12 +215,54 @@ void ruisapp::application::quit() noexcept
 	glue.quit_flag.store(true);
 }
 
+void ruisapp::application::post_to_ui_thread(
+	ui_procedure_type procedure, //
+	[[maybe_unused]] ui_priority priority
+)
+{
+	// this backend has a single UI queue lane, so the priority is ignored
+	auto& glue = get_glue(*this);
+
+	NSEvent* e = [NSEvent otherEventWithType:NSEventTypeApplicationDefined
+									location:NSMakePoint(0, 0)
+							   modifierFlags:0
+								   timestamp:0
+								windowNumber:0
+									 context:nil
+									 subtype:0
+									   data1:reinterpret_cast<NSInteger>(new ui_procedure_type(std::move(procedure)))
+									   data2:0];
+
+	[glue.macos_application.application postEvent:e atStart:NO];
+}
+
+ruisapp::application::ui_queue_metrics ruisapp::application::get_ui_queue_metrics()
+{
+	// the metrics are not collected by this backend
+	return {};
+}
+
 ruisapp::window& ruisapp::application::make_window_internal(window_parameters window_params)
 {
 	auto& glue = get_glue(*this);
 	return glue.make_window(std::move(window_params));
 }
 
+ruisapp::window& ruisapp::application::make_window_async(
+	window_parameters window_params, //
+	on_window_ready_function_type on_ready
+)
+{
+	// window creation is synchronous on this backend, so the window is ready right away
+	auto& win = this->make_window(std::move(window_params));
+
+	if (on_ready) {
+		on_ready(win);
+	}
+
+	return win;
+}
+
 void ruisapp::application::destroy_window(ruisapp::window& w)
 {
 	auto& glue = get_glue(*this);
@@ -238,3 +270,12 @@ void ruisapp::application::destroy_window(ruisapp::window& w)
 	utki::assert(dynamic_cast<app_window*>(&w), SL);
 	glue.destroy_window(static_cast<app_window&>(w));
 }
+
+void ruisapp::application::load_resources_async(
+	[[maybe_unused]] load_function_type load, //
+	[[maybe_unused]] on_loaded_function_type on_loaded
+)
+{
+	// this backend has no resource loading thread, loading synchronously instead would block the UI thread
+	throw std::logic_error("application::load_resources_async(): not supported on this backend");
+}
@@ -88,7 +88,7 @@ int main(int argc, const char** argv){
 					{
 						NSInteger data = [event data1];
 						utki::assert(data, SL);
-						std::unique_ptr<std::function<void()>> m(reinterpret_cast<std::function<void()>*>(data));
+						std::unique_ptr<ruisapp::application::ui_procedure_type> m(reinterpret_cast<ruisapp::application::ui_procedure_type*>(data));
 						(*m)();
 					}
 					break;
@@ -44,7 +44,7 @@ void handle_mouse_button(
 
 	utki::logcat_debug("mouse down pos = ", pos, '\n');
 
-	w.gui.send_mouse_button(
+	w.send_mouse_button(
 		action, //
 		pos,
 		button,
@@ -71,7 +71,7 @@ void handle_mouse_move(
 
 	// utki::logcat_debug("mouse move pos = ", pos, '\n');
 
-	w.gui.send_mouse_move(
+	w.send_mouse_move(
 		pos, //
 		0 // pointer id
 	);
@@ -94,7 +94,7 @@ void handle_mouse_hover(
 
 	utki::logcat_debug("window mouse hovered: ", is_hovered, '\n');
 
-	w.gui.send_mouse_hover(
+	w.send_mouse_hover(
 		is_hovered, //
 		0 // pointer id
 	);
@@ -108,7 +108,7 @@ void handle_key_event(
 	app_window& w
 )
 {
-	w.gui.send_key(
+	w.send_key(
 		action, //
 		key_code
 	);
@@ -150,7 +150,7 @@ void handle_character_input(
 
 	const void* nsstring = [e characters];
 
-	w.gui.send_character_input(
+	w.send_character_input(
 		macos_input_string_provider(static_cast<const NSString*>(nsstring)), //
 		key
 	);
@@ -0,0 +1,139 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#include <utki/debug.hpp>
+#include <utki/span.hpp>
+
+#if defined(__SSE2__)
+#	include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#	include <arm_neon.h>
+#endif
+
+namespace {
+/**
+ * @brief Copy row of 4 byte pixels swapping the first and the third bytes of each pixel.
+ * Converts RGBA pixels to BGRA and vice versa.
+ * @param src - source pixels.
+ * @param dst - destination pixels, must not overlap with the source.
+ * @param num_pixels - number of pixels in the row.
+ */
+inline void copy_swapping_red_blue(
+	const uint8_t* src, //
+	uint8_t* dst,
+	size_t num_pixels
+)
+{
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	// 4 pixels at a time, each pixel is a little-endian 32-bit lane with the red byte in the lowest bits
+	const __m128i green_alpha_mask = _mm_set1_epi32(int32_t(0xff00ff00));
+	const __m128i low_byte_mask = _mm_set1_epi32(0xff);
+	constexpr size_t num_pixels_per_vector = 4;
+	for (; i + num_pixels_per_vector <= num_pixels; i += num_pixels_per_vector) {
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		__m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+
+		__m128i green_alpha = _mm_and_si128(p, green_alpha_mask);
+		__m128i third_to_first = _mm_and_si128(_mm_srli_epi32(p, 16), low_byte_mask);
+		__m128i first_to_third = _mm_slli_epi32(_mm_and_si128(p, low_byte_mask), 16);
+
+		_mm_storeu_si128(
+			// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+			reinterpret_cast<__m128i*>(dst + i * 4),
+			_mm_or_si128(green_alpha, _mm_or_si128(third_to_first, first_to_third))
+		);
+	}
+#elif defined(__ARM_NEON)
+	// 16 pixels at a time, the load de-interleaves the pixel bytes to separate vectors
+	constexpr size_t num_pixels_per_vector = 16;
+	for (; i + num_pixels_per_vector <= num_pixels; i += num_pixels_per_vector) {
+		uint8x16x4_t p = vld4q_u8(src + i * 4);
+		std::swap(p.val[0], p.val[2]);
+		vst4q_u8(dst + i * 4, p);
+	}
+#endif
+
+	for (; i != num_pixels; ++i) {
+		const uint8_t* s = src + i * 4;
+		uint8_t* d = dst + i * 4;
+		d[0] = s[2];
+		d[1] = s[1];
+		d[2] = s[0];
+		d[3] = s[3];
+	}
+}
+
+/**
+ * @brief Copy image of 4 byte pixels flipping it vertically.
+ * Used to convert images read from framebuffer, which go from bottom row to top,
+ * to usual top to bottom row order.
+ * @param src - source pixels, rows are tightly packed.
+ * @param dst - destination pixels, same size as the source, must not overlap with the source.
+ * @param width - image width in pixels.
+ * @param swap_red_blue - whether to also swap the first and the third bytes of each pixel,
+ *                        i.e. to convert RGBA to BGRA and vice versa.
+ */
+inline void copy_flipping_vertically(
+	utki::span<const uint8_t> src, //
+	utki::span<uint8_t> dst,
+	size_t width,
+	bool swap_red_blue
+)
+{
+	utki::assert(src.size() == dst.size(), SL);
+
+	const size_t row_size = width * 4;
+	if (row_size == 0) {
+		return;
+	}
+
+	utki::assert(src.size() % row_size == 0, SL);
+
+	const size_t num_rows = src.size() / row_size;
+
+	for (size_t r = 0; r != num_rows; ++r) {
+		const uint8_t* src_row = src.data() + (num_rows - 1 - r) * row_size;
+		uint8_t* dst_row = dst.data() + r * row_size;
+
+		if (swap_red_blue) {
+			copy_swapping_red_blue(
+				src_row, //
+				dst_row,
+				width
+			);
+		} else {
+			std::memcpy(
+				dst_row, //
+				src_row,
+				row_size
+			);
+		}
+	}
+}
+} // namespace
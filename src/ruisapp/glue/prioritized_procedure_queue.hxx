@@ -0,0 +1,241 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <type_traits>
+
+#include "../application.hpp"
+
+#include "procedure_queue.hxx"
+
+namespace {
+/**
+ * @brief Time budget for executing posted procedures within a main loop iteration.
+ */
+struct ui_queue_budget {
+	/**
+	 * @brief Time by which the execution of normal priority procedures has to stop.
+	 */
+	std::chrono::steady_clock::time_point deadline;
+
+	/**
+	 * @brief Whether idle priority procedures can be executed.
+	 * Set when the frame has been finished early, i.e. nothing is waiting to be rendered
+	 * or there is spare time before the next frame has to be started.
+	 */
+	bool run_idle;
+
+	/**
+	 * @brief Budget used when nothing is waiting to be rendered.
+	 * Still limited, so that input events are not delayed for too long.
+	 */
+	constexpr static auto max_duration = std::chrono::milliseconds(8);
+
+	/**
+	 * @brief Budget used when a frame is due but its deadline is not known.
+	 */
+	constexpr static auto frame_pending_duration = std::chrono::milliseconds(2);
+};
+
+/**
+ * @brief UI thread procedure queue with priority lanes.
+ * Each ruisapp::ui_priority has its own procedure_queue lane. All lanes share the same wakeup,
+ * so the consumer waits on a single waitable.
+ *
+ * Unlike with a plain procedure_queue, the consumer does not have to drain the queue completely.
+ * Procedures left in the queue due to exhausted time budget do not signal the wakeup again,
+ * so before waiting for the wakeup the consumer has to check for pending procedures with has_pending().
+ * Procedures posted after a drain() call do signal the wakeup.
+ * @tparam wakeup_type - type providing set() and clear() functions to wake up the consumer thread.
+ */
+template <typename wakeup_type>
+class prioritized_procedure_queue : public wakeup_type
+{
+	struct lane_wakeup {
+		wakeup_type& wakeup;
+
+		void set()
+		{
+			this->wakeup.set();
+		}
+
+		// the shared wakeup is cleared by drain() once for all lanes
+		void clear() noexcept {}
+	};
+
+	using lane_type = procedure_queue<lane_wakeup>;
+
+	std::array<lane_type, size_t(ruisapp::ui_priority::enum_size)> lanes;
+
+	ruisapp::application::ui_queue_metrics metrics;
+
+	lane_type& get_lane(ruisapp::ui_priority priority) noexcept
+	{
+		return this->lanes[size_t(priority)];
+	}
+
+public:
+	using clock = std::chrono::steady_clock;
+
+	using function_type = typename lane_type::function_type;
+
+	static_assert(
+		std::is_same_v<function_type, ruisapp::application::ui_procedure_type>,
+		"procedures posted to the UI thread must be queued without conversion"
+	);
+
+	template <typename... arguments_type>
+	prioritized_procedure_queue(arguments_type&&... args) :
+		wakeup_type(std::forward<arguments_type>(args)...),
+		lanes{
+			lane_type(lane_wakeup{*this}), //
+			lane_type(lane_wakeup{*this}),
+			lane_type(lane_wakeup{*this})
+		}
+	{
+		static_assert(size_t(ruisapp::ui_priority::enum_size) == 3, "all lanes must be initialized");
+	}
+
+	prioritized_procedure_queue(const prioritized_procedure_queue&) = delete;
+	prioritized_procedure_queue& operator=(const prioritized_procedure_queue&) = delete;
+
+	prioritized_procedure_queue(prioritized_procedure_queue&&) = delete;
+	prioritized_procedure_queue& operator=(prioritized_procedure_queue&&) = delete;
+
+	~prioritized_procedure_queue() = default;
+
+	/**
+	 * @brief Post procedure to the queue.
+	 * Can be called from any thread.
+	 * @param proc - procedure to post.
+	 * @param priority - priority lane to post the procedure to.
+	 */
+	void push_back(
+		function_type proc, //
+		ruisapp::ui_priority priority = ruisapp::ui_priority::normal
+	)
+	{
+		this->get_lane(priority).push_back(std::move(proc));
+	}
+
+	/**
+	 * @brief Check if there are procedures waiting to be executed.
+	 * To be called by the consumer thread only.
+	 * @param include_idle - whether to take idle priority procedures into account.
+	 * @return true if there are procedures to execute.
+	 */
+	bool has_pending(bool include_idle)
+	{
+		return this->get_lane(ruisapp::ui_priority::input).size() != 0 ||
+			this->get_lane(ruisapp::ui_priority::normal).size() != 0 ||
+			(include_idle && this->get_lane(ruisapp::ui_priority::idle).size() != 0);
+	}
+
+	/**
+	 * @brief Result of a drain() call.
+	 */
+	struct drain_result {
+		size_t num_executed = 0;
+
+		// longest time an executed procedure waited in the queue
+		clock::duration max_latency{0};
+	};
+
+	/**
+	 * @brief Execute posted procedures within the time budget.
+	 * To be called by the consumer thread only.
+	 * Input priority procedures posted before the call are all executed regardless of the budget.
+	 * Normal priority procedures are executed until the budget deadline, but at least one,
+	 * so that the queue makes progress even when the budget is exhausted.
+	 * Idle priority procedures are executed only if allowed by the budget, until the budget deadline.
+	 * @param budget - time budget.
+	 * @return Execution statistics.
+	 */
+	drain_result drain(const ui_queue_budget& budget)
+	{
+		// Acknowledge the wakeup of all lanes, so that any procedure posted from now on signals it again.
+		// The lanes are not necessarily popped empty below, so pop_front_entry() cannot be relied on for that.
+		this->clear();
+		for (auto& lane : this->lanes) {
+			lane.acknowledge_wakeup();
+		}
+
+		size_t total_depth = 0;
+		for (size_t i = 0; i != this->lanes.size(); ++i) {
+			auto depth = this->lanes[i].size();
+			this->metrics.depth[ruisapp::ui_priority(i)] = depth;
+			total_depth += depth;
+		}
+		this->metrics.max_depth = std::max(this->metrics.max_depth, total_depth);
+
+		drain_result res;
+
+		auto execute = [&res](lane_type& lane) {
+			auto e = lane.pop_front_entry();
+			if (!e.proc) {
+				return false;
+			}
+			res.max_latency = std::max(res.max_latency, clock::now() - e.post_time);
+			e.proc();
+			++res.num_executed;
+			return true;
+		};
+
+		// procedures posted to the input lane while draining it are left for the next drain,
+		// so that a procedure reposting itself does not block the main loop
+		for (auto n = this->metrics.depth[ruisapp::ui_priority::input]; n != 0; --n) {
+			if (!execute(this->get_lane(ruisapp::ui_priority::input))) {
+				break;
+			}
+		}
+
+		for (bool first = true; first || clock::now() < budget.deadline; first = false) {
+			if (!execute(this->get_lane(ruisapp::ui_priority::normal))) {
+				break;
+			}
+		}
+
+		if (budget.run_idle && !this->has_pending(false)) {
+			while (clock::now() < budget.deadline) {
+				if (!execute(this->get_lane(ruisapp::ui_priority::idle))) {
+					break;
+				}
+			}
+		}
+
+		return res;
+	}
+
+	/**
+	 * @brief Get queue metrics.
+	 * To be called by the consumer thread only.
+	 * @return Queue metrics sampled by the latest drain() call.
+	 */
+	const ruisapp::application::ui_queue_metrics& get_metrics() const noexcept
+	{
+		return this->metrics;
+	}
+};
+} // namespace
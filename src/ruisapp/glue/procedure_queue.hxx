@@ -0,0 +1,278 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "../inline_function.hpp"
+
+namespace {
+/**
+ * @brief Queue of procedures to be executed on the UI thread.
+ * Multiple producers, single consumer. The procedures are stored in a lock-free
+ * bounded ring buffer of inline_function objects, so posting a procedure
+ * does not allocate memory, unless it is too big to fit into the inline storage.
+ * In case the ring buffer is full, e.g. when the UI thread is blocked for a long time,
+ * the procedures are stored in a mutex protected overflow queue, until it is drained
+ * by the consumer, so the procedures are never lost and the order of the procedures
+ * posted from the same thread is preserved.
+ *
+ * The consumer is woken up only when a procedure is posted to an empty queue,
+ * i.e. wakeups are coalesced.
+ *
+ * Each procedure is stamped with the time it was posted at, so that the consumer
+ * can measure how long the procedures wait in the queue.
+ * @tparam wakeup_type - type providing set() and clear() functions to wake up the consumer thread.
+ *                       The queue derives from the type, so in case it is a waitable, the queue is waitable too.
+ */
+template <typename wakeup_type>
+class procedure_queue : public wakeup_type
+{
+public:
+	// big enough for an std::function or a lambda capturing a few pointers
+	constexpr static size_t inline_capacity = 6 * sizeof(void*);
+
+	using function_type = ruisapp::inline_function<inline_capacity>;
+
+	using clock = std::chrono::steady_clock;
+
+	struct entry {
+		function_type proc;
+		clock::time_point post_time;
+	};
+
+	constexpr static size_t capacity = 1024;
+
+private:
+	static_assert((capacity & (capacity - 1)) == 0, "capacity must be a power of 2");
+
+	struct cell {
+		// equals to the cell position if the cell is free,
+		// equals to the cell position + 1 if the cell holds a procedure
+		std::atomic_size_t sequence;
+		entry e;
+	};
+
+	std::unique_ptr<std::array<cell, capacity>> ring = std::make_unique<std::array<cell, capacity>>();
+
+	std::atomic_size_t enqueue_pos{0};
+
+	// accessed by consumer only
+	size_t dequeue_pos = 0;
+
+	std::atomic_bool overflowed{false};
+	std::mutex overflow_mutex;
+	std::deque<entry> overflow;
+
+	// whether the consumer has been woken up and has not acknowledged it yet
+	std::atomic_bool wakeup_pending{false};
+
+	bool try_push_to_ring(entry& e) noexcept
+	{
+		auto& cells = *this->ring;
+
+		auto pos = this->enqueue_pos.load(std::memory_order_relaxed);
+		while (true) {
+			auto& c = cells[pos % capacity];
+			auto seq = c.sequence.load(std::memory_order_acquire);
+			auto diff = std::ptrdiff_t(seq) - std::ptrdiff_t(pos);
+			if (diff == 0) {
+				// the cell is free, try to claim it
+				if (this->enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					c.e = std::move(e);
+					c.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+				// other producer has claimed the cell, pos is updated by compare_exchange_weak()
+			} else if (diff < 0) {
+				// the ring is full
+				return false;
+			} else {
+				// other producer has claimed the cell, reload position
+				pos = this->enqueue_pos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	entry try_pop_from_ring() noexcept
+	{
+		auto& c = (*this->ring)[this->dequeue_pos % capacity];
+		if (c.sequence.load(std::memory_order_acquire) != this->dequeue_pos + 1) {
+			// the ring is empty or the producer has not finished writing the cell yet
+			return {};
+		}
+
+		auto e = std::move(c.e);
+		c.sequence.store(this->dequeue_pos + capacity, std::memory_order_release);
+		++this->dequeue_pos;
+		return e;
+	}
+
+	entry try_pop() noexcept
+	{
+		if (auto e = this->try_pop_from_ring(); e.proc) {
+			return e;
+		}
+
+		// A producer can have claimed a ring cell, but not have written it yet, while other producer
+		// has found the ring full and has posted a later procedure to the overflow queue.
+		// So, to preserve the order, take procedures from the overflow queue only when the ring is empty.
+		// Otherwise, the producer signals the wakeup once it has written the cell.
+		if (this->enqueue_pos.load(std::memory_order_acquire) != this->dequeue_pos) {
+			return {};
+		}
+
+		if (!this->overflowed.load(std::memory_order_acquire)) {
+			return {};
+		}
+
+		std::lock_guard lock(this->overflow_mutex);
+		if (this->overflow.empty()) {
+			return {};
+		}
+		auto e = std::move(this->overflow.front());
+		this->overflow.pop_front();
+		if (this->overflow.empty()) {
+			this->overflowed.store(false, std::memory_order_release);
+		}
+		return e;
+	}
+
+public:
+	template <typename... arguments_type>
+	procedure_queue(arguments_type&&... args) :
+		wakeup_type(std::forward<arguments_type>(args)...)
+	{
+		for (size_t i = 0; i != capacity; ++i) {
+			(*this->ring)[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	procedure_queue(const procedure_queue&) = delete;
+	procedure_queue& operator=(const procedure_queue&) = delete;
+
+	procedure_queue(procedure_queue&&) = delete;
+	procedure_queue& operator=(procedure_queue&&) = delete;
+
+	~procedure_queue() = default;
+
+	/**
+	 * @brief Get number of procedures in the queue.
+	 * To be called by the consumer thread only.
+	 * The value is approximate, as the producers can be posting procedures concurrently.
+	 * @return Number of queued procedures.
+	 */
+	size_t size()
+	{
+		size_t ret = this->enqueue_pos.load(std::memory_order_relaxed) - this->dequeue_pos;
+
+		if (this->overflowed.load(std::memory_order_acquire)) {
+			std::lock_guard lock(this->overflow_mutex);
+			ret += this->overflow.size();
+		}
+
+		return ret;
+	}
+
+	/**
+	 * @brief Post procedure to the queue.
+	 * Can be called from any thread.
+	 * @param proc - procedure to post.
+	 */
+	void push_back(function_type proc)
+	{
+		if (!proc) {
+			return;
+		}
+
+		entry e{
+			.proc = std::move(proc), //
+			.post_time = clock::now()
+		};
+
+		if (this->overflowed.load(std::memory_order_acquire) || !this->try_push_to_ring(e)) {
+			std::lock_guard lock(this->overflow_mutex);
+			this->overflow.push_back(std::move(e));
+			this->overflowed.store(true, std::memory_order_release);
+		}
+
+		// wake up the consumer only if it has not been woken up yet
+		if (!this->wakeup_pending.exchange(true, std::memory_order_seq_cst)) {
+			this->set();
+		}
+	}
+
+	/**
+	 * @brief Pop procedure from the queue.
+	 * To be called by the consumer thread only.
+	 * When the queue is drained, the wakeup is acknowledged.
+	 * @return Popped procedure.
+	 * @return Empty function if the queue is empty.
+	 */
+	function_type pop_front()
+	{
+		return this->pop_front_entry().proc;
+	}
+
+	/**
+	 * @brief Pop procedure from the queue along with its post time.
+	 * Same as pop_front(), but also gives the time the procedure was posted at.
+	 * @return Popped entry. The entry's procedure is empty if the queue is empty.
+	 */
+	entry pop_front_entry()
+	{
+		if (auto e = this->try_pop(); e.proc) {
+			return e;
+		}
+
+		// the queue looks empty
+		this->acknowledge_wakeup();
+
+		return this->try_pop();
+	}
+
+	/**
+	 * @brief Acknowledge the wakeup.
+	 * To be called by the consumer thread only.
+	 * The next procedure posted after the call signals the wakeup again, even if the queue is not empty.
+	 * pop_front() does this when the queue is drained. A consumer which leaves procedures in the queue
+	 * has to call this before checking for the queued procedures, otherwise it would not be woken up
+	 * for the procedures posted later.
+	 */
+	void acknowledge_wakeup()
+	{
+		// clear the wakeup before resetting the flag, otherwise the wakeup signalled in between would be lost
+		this->clear();
+		this->wakeup_pending.store(false, std::memory_order_seq_cst);
+
+		// make sure the procedures pushed before the flag was reset are seen
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+	}
+};
+} // namespace
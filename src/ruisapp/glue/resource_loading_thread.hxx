@@ -0,0 +1,199 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <ruis/gui.hpp>
+#include <utki/shared_ref.hpp>
+#include <utki/util.hpp>
+
+#include "../application.hpp"
+
+namespace {
+/**
+ * @brief Thread for loading resources in background.
+ * The thread has its own rendering context which shares GL objects with rendering contexts of all windows.
+ * So, decoding images, fonts, SVGs etc. and uploading them to GPU can be done without blocking the UI thread.
+ * The loading tasks are executed in the order they were submitted.
+ */
+class resource_loading_thread
+{
+	const std::function<utki::shared_ref<ruis::render::context>()> make_rendering_context;
+	const std::function<void()> unbind_rendering_context;
+	const std::function<void(std::function<void()>)> post_to_ui_thread;
+
+	struct task {
+		ruisapp::application::load_function_type load;
+		ruisapp::application::on_loaded_function_type on_loaded;
+	};
+
+	std::mutex mutex;
+	std::condition_variable cond_var;
+	std::deque<task> tasks;
+	bool quit = false;
+
+	std::thread thread;
+
+	void run()
+	{
+		std::optional<utki::shared_ref<ruis::resource_loader>> loader;
+
+		utki::scope_exit unbind_scope_exit([&]() {
+			// resources cached by the loader have to be freed while the thread's rendering context is alive
+			loader.reset();
+			this->unbind_rendering_context();
+		});
+
+		while (true) {
+			std::deque<task> batch;
+			{
+				std::unique_lock lock(this->mutex);
+				this->cond_var.wait(lock, [this]() {
+					return this->quit || !this->tasks.empty();
+				});
+				if (this->quit) {
+					return;
+				}
+				std::swap(batch, this->tasks);
+			}
+
+			std::vector<std::function<void()>> completions;
+			completions.reserve(batch.size());
+
+			for (auto& t : batch) {
+				std::exception_ptr error;
+				try {
+					if (!loader.has_value()) {
+						auto rendering_context = this->make_rendering_context();
+						auto render_objects = utki::make_shared<ruis::render::renderer::objects>(rendering_context);
+						loader.emplace(utki::make_shared<ruis::resource_loader>(
+							std::move(rendering_context), //
+							std::move(render_objects)
+						));
+					}
+
+					t.load(loader.value().get());
+				} catch (...) {
+					error = std::current_exception();
+				}
+
+				completions.emplace_back([on_loaded = std::move(t.on_loaded), error = std::move(error)]() {
+					on_loaded(error);
+				});
+			}
+
+			// Unbinding the rendering context waits for the GL commands to complete,
+			// so the loaded resources are ready to be used from other rendering contexts
+			// by the time the completions are executed.
+			// Also, unbound context can be bound on the UI thread in case some resources
+			// are destroyed there.
+			this->unbind_rendering_context();
+
+			for (auto& c : completions) {
+				this->post_to_ui_thread(std::move(c));
+			}
+		}
+	}
+
+public:
+	/**
+	 * @brief Start resource loading thread.
+	 * @param make_rendering_context - function creating ruis rendering context for the loading thread.
+	 *                                 The rendering context must share GL objects with windows' rendering contexts.
+	 *                                 Called on the loading thread when the first loading task is executed.
+	 * @param unbind_rendering_context - function waiting for the GL commands to complete and unbinding
+	 *                                   the loading thread's rendering context from the calling thread.
+	 *                                   Called on the loading thread.
+	 * @param post_to_ui_thread - function posting a procedure to the UI thread queue.
+	 */
+	resource_loading_thread(
+		std::function<utki::shared_ref<ruis::render::context>()> make_rendering_context, //
+		std::function<void()> unbind_rendering_context,
+		std::function<void(std::function<void()>)> post_to_ui_thread
+	) :
+		make_rendering_context(std::move(make_rendering_context)),
+		unbind_rendering_context(std::move(unbind_rendering_context)),
+		post_to_ui_thread(std::move(post_to_ui_thread)),
+		thread([this]() {
+			this->run();
+		})
+	{}
+
+	resource_loading_thread(const resource_loading_thread&) = delete;
+	resource_loading_thread& operator=(const resource_loading_thread&) = delete;
+
+	resource_loading_thread(resource_loading_thread&&) = delete;
+	resource_loading_thread& operator=(resource_loading_thread&&) = delete;
+
+	/**
+	 * @brief Stop the loading thread.
+	 * Waits for the currently executed loading tasks to complete.
+	 * Pending loading tasks are dropped without calling their completion functions,
+	 * same as the procedures left in the UI queue, because by that time the application
+	 * object, which the completion functions normally refer to, is already destroyed.
+	 */
+	~resource_loading_thread()
+	{
+		{
+			std::lock_guard lock(this->mutex);
+			this->quit = true;
+		}
+		this->cond_var.notify_one();
+		this->thread.join();
+	}
+
+	/**
+	 * @brief Submit loading task.
+	 * Thread safe.
+	 * @param load - loading function, called on the loading thread.
+	 * @param on_loaded - completion function, posted to the UI thread once the loading function returns.
+	 * @throw std::invalid_argument - in case the completion function is empty.
+	 */
+	void push(
+		ruisapp::application::load_function_type load, //
+		ruisapp::application::on_loaded_function_type on_loaded
+	)
+	{
+		if (!on_loaded) {
+			throw std::invalid_argument("resource_loading_thread::push(): on_loaded function is empty");
+		}
+
+		{
+			std::lock_guard lock(this->mutex);
+			this->tasks.push_back({
+				.load = std::move(load), //
+				.on_loaded = std::move(on_loaded)
+			});
+		}
+		this->cond_var.notify_one();
+	}
+};
+} // namespace
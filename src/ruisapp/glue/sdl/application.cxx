@@ -21,6 +21,8 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #include "application.hxx"
 
+#include "../vblank_pacing.hxx"
+
 #ifdef RUISAPP_RENDER_OPENGL
 // #	include <GL/glew.h>
 #	include <ruis/render/opengl/context.hpp>
@@ -100,7 +102,25 @@ app_window* application_glue::get_window()
 void application_glue::render()
 {
 	for (auto& w : this->windows) {
-		w.second.get().render();
+		auto& win = w.second.get();
+		if (win.is_render_needed()) {
+			this->windows_to_render.push_back(&win);
+		}
+	}
+	render_with_single_vblank_wait(this->windows_to_render);
+}
+
+void application_glue::invalidate_all_implicitly()
+{
+	for (auto& w : this->windows) {
+		w.second.get().invalidate_implicitly();
+	}
+}
+
+void application_glue::flush_coalesced_input()
+{
+	for (auto& w : this->windows) {
+		w.second.get().flush_coalesced_input();
 	}
 }
 
@@ -108,13 +128,22 @@ void application_glue::apply_new_win_dims()
 {
 	for (auto& win : this->windows) {
 		auto& w = win.second.get();
-		if (w.new_win_dims.is_positive_or_zero()) {
-			w.gui.set_viewport(ruis::rect(0, w.new_win_dims));
+		if (w.new_win_dims.is_positive_or_zero() && w.new_win_dims != w.cur_win_dims) {
+			w.cur_win_dims = w.new_win_dims;
+			w.set_viewport(ruis::rect(0, w.new_win_dims));
+			w.invalidate();
 		}
 		w.new_win_dims = {-1, -1};
 	}
 }
 
+void application_glue::push_frame_statistics(const ruisapp::frame_statistics::sample& loop_sample)
+{
+	for (auto& w : this->windows) {
+		w.second.get().push_frame_statistics(loop_sample);
+	}
+}
+
 ruisapp::window& application_glue::make_window(ruisapp::window_parameters window_params)
 {
 	auto ruis_native_window = utki::make_shared<native_window>(
@@ -144,15 +173,8 @@ ruisapp::window& application_glue::make_window(ruisapp::window_parameters window
 
 	auto ruis_context = utki::make_shared<ruis::context>(ruis::context::parameters{
 		.post_to_ui_thread_function =
-			[display = this->display](std::function<void()> procedure) {
-				SDL_Event e;
-				SDL_memset(&e, 0, sizeof(e));
-				e.type = display.get().user_event_type_id;
-				e.user.code = 0;
-				// NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
-				e.user.data1 = new std::function<void()>(std::move(procedure));
-				e.user.data2 = nullptr;
-				SDL_PushEvent(&e);
+			[](std::function<void()> procedure) {
+				ruisapp::inst().post_to_ui_thread(std::move(procedure));
 			},
 		.updater = this->updater,
 		.renderer =
@@ -192,8 +214,9 @@ ruisapp::window& application_glue::make_window(ruisapp::window_parameters window
 		std::move(ruis_native_window)
 	);
 
-	ruisapp_window.get().gui.set_viewport( //
-		ruis::rect({0, 0}, ruisapp_window.get().ruis_native_window.get().get_dims().to<ruis::real>())
+	ruisapp_window.get().cur_win_dims = ruisapp_window.get().ruis_native_window.get().get_dims().to<ruis::real>();
+	ruisapp_window.get().set_viewport( //
+		ruis::rect({0, 0}, ruisapp_window.get().cur_win_dims)
 	);
 
 	auto res = this->windows.insert( //
@@ -252,6 +275,22 @@ void ruisapp::application::quit() noexcept
 	SDL_PushEvent(&event);
 }
 
+void ruisapp::application::post_to_ui_thread(
+	ui_procedure_type procedure, //
+	[[maybe_unused]] ui_priority priority
+)
+{
+	// this backend has a single UI queue lane, so the priority is ignored
+	auto& glue = get_glue(*this);
+	glue.display.get().ui_queue.push_back(std::move(procedure));
+}
+
+ruisapp::application::ui_queue_metrics ruisapp::application::get_ui_queue_metrics()
+{
+	// the metrics are not collected by this backend
+	return {};
+}
+
 ruisapp::window& ruisapp::application::make_window_internal(ruisapp::window_parameters window_params)
 {
 	auto& glue = get_glue(*this);
@@ -267,6 +306,21 @@ ruisapp::window& ruisapp::application::make_window_internal(ruisapp::window_para
 	return glue.make_window(std::move(window_params));
 }
 
+ruisapp::window& ruisapp::application::make_window_async(
+	window_parameters window_params, //
+	on_window_ready_function_type on_ready
+)
+{
+	// window creation is synchronous on this backend, so the window is ready right away
+	auto& win = this->make_window(std::move(window_params));
+
+	if (on_ready) {
+		on_ready(win);
+	}
+
+	return win;
+}
+
 void ruisapp::application::destroy_window(ruisapp::window& w)
 {
 #if CFG_OS_NAME == CFG_OS_NAME_EMSCRIPTEN
@@ -283,3 +337,12 @@ void ruisapp::application::destroy_window(ruisapp::window& w)
 	glue.destroy_window(app_win.ruis_native_window.get().get_id());
 #endif
 }
+
+void ruisapp::application::load_resources_async(
+	[[maybe_unused]] load_function_type load, //
+	[[maybe_unused]] on_loaded_function_type on_loaded
+)
+{
+	// this backend has no resource loading thread, loading synchronously instead would block the UI thread
+	throw std::logic_error("application::load_resources_async(): not supported on this backend");
+}
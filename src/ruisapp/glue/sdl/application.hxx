@@ -26,6 +26,7 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #include <utki/destructable.hpp>
 
 #include "../../application.hpp"
+#include "../update_deadline.hxx"
 
 #include "display.hxx"
 #include "window.hxx"
@@ -54,6 +55,9 @@ public:
 	}
 
 	ruis::vec2 new_win_dims{-1, -1};
+
+	// dimensions the window's viewport was last set to
+	ruis::vec2 cur_win_dims{-1, -1};
 };
 } // namespace
 
@@ -82,11 +86,17 @@ private:
 		>
 		windows;
 
+	// reused between main loop iterations to avoid memory allocations
+	std::vector<app_window*> windows_to_render;
+
 public:
 	std::vector<utki::shared_ref<app_window>> windows_to_destroy;
 
 	utki::shared_ref<ruis::updater> updater = utki::make_shared<ruis::updater>();
 
+	// time point when the updater needs to be updated next time
+	update_deadline updater_deadline;
+
 	std::atomic_bool quit_flag = false;
 
 	application_glue(const utki::version_duplet& gl_version);
@@ -107,7 +117,13 @@ public:
 	// render all windows if needed
 	void render();
 
+	void invalidate_all_implicitly();
+
+	void flush_coalesced_input();
+
 	void apply_new_win_dims();
+
+	void push_frame_statistics(const ruisapp::frame_statistics::sample& loop_sample);
 };
 } // namespace
 
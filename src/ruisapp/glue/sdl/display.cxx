@@ -116,5 +116,17 @@ display_wrapper::display_wrapper() :
 			));
 		}
 		return t;
-	}())
+	}()),
+	ui_queue(sdl_wakeup{.event_type = this->user_event_type_id})
 {}
+
+void display_wrapper::sdl_wakeup::set()
+{
+	SDL_Event e;
+	SDL_memset(&e, 0, sizeof(e));
+	e.type = this->event_type;
+	e.user.code = 0;
+	e.user.data1 = nullptr;
+	e.user.data2 = nullptr;
+	SDL_PushEvent(&e);
+}
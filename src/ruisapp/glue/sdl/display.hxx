@@ -33,6 +33,8 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #	include <SDL2/SDL.h>
 #endif
 
+#include "../procedure_queue.hxx"
+
 namespace {
 class display_wrapper
 {
@@ -81,6 +83,20 @@ public:
 
 	const Uint32 user_event_type_id;
 
+	/**
+	 * @brief Wakes up the main loop by pushing a user event to the SDL event queue.
+	 */
+	struct sdl_wakeup {
+		const Uint32 event_type;
+
+		void set();
+
+		void clear() noexcept {}
+	};
+
+	// procedures posted to the UI thread
+	procedure_queue<sdl_wakeup> ui_queue;
+
 	display_wrapper();
 
 	display_wrapper(const display_wrapper&) = delete;
@@ -25,6 +25,8 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #include <utki/enum_array.hpp>
 #include <utki/unicode.hpp>
 
+#include "../frame_timer.hxx"
+
 #include "application.hxx"
 #include "key_code_map.hxx"
 
@@ -79,15 +81,21 @@ void main_loop_iteration(void* user_data)
 
 	glue.windows_to_destroy.clear();
 
+	frame_timer timer;
+
 	// loop iteration sequence:
 	// - update updateables
-	// - render
+	// - render windows which need it
 	// - wait for events and handle them/next cycle
 
-#if CFG_OS_NAME != CFG_OS_NAME_EMSCRIPTEN
-	auto to_wait_ms =
-#endif
-		glue.updater.get().update();
+	bool update_due = glue.updater_deadline.is_due();
+	auto to_wait_ms = glue.updater.get().update();
+	glue.updater_deadline.set(to_wait_ms);
+	if (update_due) {
+		// updated updateables can change appearance of any window
+		glue.invalidate_all_implicitly();
+	}
+	timer.lap(ruisapp::frame_phase::update);
 
 	glue.render();
 
@@ -97,9 +105,11 @@ void main_loop_iteration(void* user_data)
 
 	if (SDL_WaitEventTimeout(nullptr, int(to_wait_ms)) == 0) {
 		// No events or error. In case of error not much we can do, just ignore it.
+		glue.push_frame_statistics(timer.get_sample());
 		return;
 	}
 #endif
+	timer.skip();
 
 	SDL_Event e;
 	while (SDL_PollEvent(&e) != 0) {
@@ -114,6 +124,9 @@ void main_loop_iteration(void* user_data)
 					switch (e.window.event) {
 						default:
 							break;
+						case SDL_WINDOWEVENT_EXPOSED:
+							win.invalidate();
+							break;
 						case SDL_WINDOWEVENT_RESIZED:
 						case SDL_WINDOWEVENT_SIZE_CHANGED:
 							// squash all window resize events into one, for that store the new
@@ -127,14 +140,18 @@ void main_loop_iteration(void* user_data)
 							break;
 						case SDL_WINDOWEVENT_ENTER:
 							natwin.set_hovered(true);
-							win.gui.send_mouse_hover(
+							win.flush_coalesced_input();
+							win.invalidate_implicitly();
+							win.send_mouse_hover(
 								true, //
 								0 // pointer id
 							);
 							break;
 						case SDL_WINDOWEVENT_LEAVE:
 							natwin.set_hovered(false);
-							win.gui.send_mouse_hover(
+							win.flush_coalesced_input();
+							win.invalidate_implicitly();
+							win.send_mouse_hover(
 								false, //
 								0 // pointer id
 							);
@@ -165,7 +182,9 @@ void main_loop_iteration(void* user_data)
 
 					// utki::logcat("mouse move event: pos = ", pos, '\n');
 
-					win.gui.send_mouse_move(
+					// high rate pointing devices produce several motion events per frame,
+					// squash those into one mouse move event per main loop iteration
+					win.coalesce_mouse_move(
 						pos, //
 						0 // pointer id
 					);
@@ -192,7 +211,9 @@ void main_loop_iteration(void* user_data)
 
 					// utki::logcat("mouse button event: pos = ", pos, '\n');
 
-					win.gui.send_mouse_button(
+					win.flush_coalesced_input();
+					win.invalidate_implicitly();
+					win.send_mouse_button(
 						e.button.type == SDL_MOUSEBUTTONDOWN ? ruis::button_action::press
 															 : ruis::button_action::release, //
 						pos,
@@ -216,8 +237,11 @@ void main_loop_iteration(void* user_data)
 					auto& win = *window;
 
 					auto key = sdl_scancode_to_ruis_key(e.key.keysym.scancode);
+
+					win.flush_coalesced_input();
+					win.invalidate_implicitly();
 					if (e.key.repeat == 0) {
-						win.gui.send_key(
+						win.send_key(
 							e.key.type == SDL_KEYDOWN ? ruis::button_action::press : ruis::button_action::release, //
 							key
 						);
@@ -230,7 +254,7 @@ void main_loop_iteration(void* user_data)
 							}
 						};
 
-						win.gui.send_character_input(
+						win.send_character_input(
 							sdl_dummy_input_string_provider(), //
 							key
 						);
@@ -273,7 +297,9 @@ void main_loop_iteration(void* user_data)
 						&(e.text.text[0])
 					);
 
-					win.gui.send_character_input(
+					win.flush_coalesced_input();
+					win.invalidate_implicitly();
+					win.send_character_input(
 						sdl_input_string_provider, //
 						ruis::key::unknown
 					);
@@ -281,17 +307,29 @@ void main_loop_iteration(void* user_data)
 				break;
 			default:
 				if (e.type == glue.display.get().user_event_type_id) {
-					std::unique_ptr<std::function<void()>> f(
-						// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-						reinterpret_cast<std::function<void()>*>(e.user.data1)
-					);
-					f->operator()();
+					// account the posted procedure execution time to ui queue drain phase
+					timer.lap(ruisapp::frame_phase::event_dispatch);
+
+					// the event is pushed when a procedure is posted to the empty queue,
+					// so execute all the procedures posted since then
+					while (auto proc = glue.display.get().ui_queue.pop_front()) {
+						proc();
+					}
+
+					// posted procedures can change appearance of any window
+					glue.invalidate_all_implicitly();
+
+					timer.lap(ruisapp::frame_phase::ui_queue_drain);
 				}
 				break;
 		}
 	}
 
+	glue.flush_coalesced_input();
 	glue.apply_new_win_dims();
+	timer.lap(ruisapp::frame_phase::event_dispatch);
+
+	glue.push_frame_statistics(timer.get_sample());
 
 #if CFG_OS_NAME == CFG_OS_NAME_EMSCRIPTEN
 	if (glue.quit_flag.load()) {
@@ -24,6 +24,7 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #include <ruis/config.hpp>
 #include <ruis/render/native_window.hpp>
 #include <utki/config.hpp>
+#include <utki/debug.hpp>
 #include <utki/shared_ref.hpp>
 #include <utki/version.hpp>
 
@@ -103,8 +104,48 @@ public:
 		native_window* shared_gl_context_native_window
 	);
 
+private:
+	// whether swapping frame buffers currently waits for vblank
+	bool swap_waits_for_vblank = false;
+
+	// whether the next frame buffers swap should wait for vblank, in case vsync is enabled
+	bool wait_for_vblank = true;
+
+	void set_swap_interval(bool enable)
+	{
+#if CFG_OS_NAME != CFG_OS_NAME_EMSCRIPTEN
+		// on emscripten the swap interval controls the main loop timing, so leave it as is
+		if (SDL_GL_SetSwapInterval(enable ? 1 : 0) != 0) {
+			utki::logcat("WARNING: SDL_GL_SetSwapInterval(", enable, ") failed: ", SDL_GetError(), '\n');
+		}
+#endif
+		this->swap_waits_for_vblank = enable;
+	}
+
+public:
+	void set_vsync_enabled_internal(bool enable) override
+	{
+		this->set_swap_interval(enable);
+	}
+
+	/**
+	 * @brief Set whether the next frame buffers swap should wait for vblank.
+	 * Has effect only if vsync is enabled for the window.
+	 * Used to make only one of the windows rendered in a main loop iteration wait for vblank.
+	 * @param wait - whether to wait for vblank.
+	 */
+	void set_wait_for_vblank(bool wait) noexcept
+	{
+		this->wait_for_vblank = wait;
+	}
+
 	void swap_frame_buffers() override
 	{
+		// the rendering context is bound at this point, so the swap interval can be changed if needed
+		if (bool wait = this->wait_for_vblank && this->is_vsync_enabled(); wait != this->swap_waits_for_vblank) {
+			this->set_swap_interval(wait);
+		}
+
 		SDL_GL_SwapWindow(this->sdl_window.window);
 	}
 
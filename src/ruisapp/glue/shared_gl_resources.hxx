@@ -0,0 +1,138 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <functional>
+#include <future>
+#include <optional>
+
+#include <ruis/gui.hpp>
+#include <utki/shared_ref.hpp>
+#include <utki/util.hpp>
+
+#include "../startup_profile.hpp"
+
+namespace {
+/**
+ * @brief GL resources shared by all windows of the application.
+ */
+struct shared_gl_resources {
+	utki::shared_ref<ruis::render::context> resource_loader_ruis_rendering_context;
+	utki::shared_ref<const ruis::render::context::shaders> common_shaders;
+	utki::shared_ref<const ruis::render::renderer::objects> common_render_objects;
+	utki::shared_ref<ruis::resource_loader> ruis_resource_loader;
+	utki::shared_ref<ruis::style_provider> ruis_style_provider;
+};
+} // namespace
+
+namespace {
+/**
+ * @brief Shared GL resources initialized on a worker thread.
+ * Compiling shaders and creating common render objects takes considerable time,
+ * so it is done on a worker thread, while the main thread proceeds with the application
+ * startup, i.e. runs the application factory and creates the first window.
+ * The main thread blocks only when it needs the resources for the first time.
+ */
+class async_shared_gl_resources
+{
+	std::future<shared_gl_resources> future;
+
+	std::optional<shared_gl_resources> resources;
+
+public:
+	/**
+	 * @brief Start initialization of shared GL resources.
+	 * The shared GL context must not be bound on the calling thread,
+	 * as it will be bound on the worker thread.
+	 * @param make_rendering_context - function creating ruis rendering context for the shared GL context.
+	 *                                 Called on the worker thread.
+	 * @param unbind_rendering_context - function unbinding the shared GL context from the current thread.
+	 *                                   Called on the worker thread when the initialization is done,
+	 *                                   so that the context can be bound on the main thread later.
+	 */
+	async_shared_gl_resources(
+		std::function<utki::shared_ref<ruis::render::context>()> make_rendering_context, //
+		std::function<void()> unbind_rendering_context
+	) :
+		future(std::async(
+			std::launch::async, //
+			[make_rendering_context = std::move(make_rendering_context),
+			 unbind_rendering_context = std::move(unbind_rendering_context)]() {
+				utki::scope_exit unbind_scope_exit([&]() {
+					unbind_rendering_context();
+				});
+
+				auto rendering_context = make_rendering_context();
+
+				auto shaders = [&]() {
+					ruisapp::startup_profile::scope profile_scope(ruisapp::startup_phase::make_shaders);
+					return rendering_context.get().make_shaders();
+				}();
+
+				auto render_objects = utki::make_shared<ruis::render::renderer::objects>(rendering_context);
+
+				auto resource_loader = [&]() {
+					ruisapp::startup_profile::scope profile_scope(
+						ruisapp::startup_phase::resource_loader_construction
+					);
+					return utki::make_shared<ruis::resource_loader>(
+						rendering_context, //
+						render_objects
+					);
+				}();
+				auto style_provider = utki::make_shared<ruis::style_provider>(resource_loader);
+
+				return shared_gl_resources{
+					.resource_loader_ruis_rendering_context = std::move(rendering_context),
+					.common_shaders = std::move(shaders),
+					.common_render_objects = std::move(render_objects),
+					.ruis_resource_loader = std::move(resource_loader),
+					.ruis_style_provider = std::move(style_provider)
+				};
+			}
+		))
+	{}
+
+	async_shared_gl_resources(const async_shared_gl_resources&) = delete;
+	async_shared_gl_resources& operator=(const async_shared_gl_resources&) = delete;
+
+	async_shared_gl_resources(async_shared_gl_resources&&) = delete;
+	async_shared_gl_resources& operator=(async_shared_gl_resources&&) = delete;
+
+	~async_shared_gl_resources() = default;
+
+	/**
+	 * @brief Get shared GL resources.
+	 * Waits for the initialization to complete if it is still in progress.
+	 * Rethrows exception in case the initialization has failed.
+	 * Must be called from the main thread only.
+	 * @return Shared GL resources.
+	 */
+	const shared_gl_resources& get()
+	{
+		if (!this->resources.has_value()) {
+			this->resources.emplace(this->future.get());
+		}
+		return this->resources.value();
+	}
+};
+} // namespace
@@ -0,0 +1,66 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+namespace {
+/**
+ * @brief Tracks when the ruis::updater is due to update its updateables.
+ * The ruis::updater::update() returns number of milliseconds till the next update is due.
+ * The main loop uses this to find out if any updateables were updated on the current
+ * iteration, in which case all windows need to be re-rendered.
+ */
+class update_deadline
+{
+	using clock = std::chrono::steady_clock;
+
+	// min value makes the very first update to be treated as due
+	clock::time_point deadline = clock::time_point::min();
+
+public:
+	/**
+	 * @brief Check if updateables are due for update.
+	 * @return true if the deadline set by last set() call has been reached.
+	 */
+	bool is_due() const noexcept
+	{
+		return clock::now() >= this->deadline;
+	}
+
+	/**
+	 * @brief Set new deadline.
+	 * @param to_wait_ms - value returned by ruis::updater::update().
+	 */
+	void set(uint32_t to_wait_ms) noexcept
+	{
+		if (to_wait_ms == std::numeric_limits<uint32_t>::max()) {
+			// no updateables to update
+			this->deadline = clock::time_point::max();
+			return;
+		}
+		this->deadline = clock::now() + std::chrono::milliseconds(to_wait_ms);
+	}
+};
+} // namespace
@@ -0,0 +1,71 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+/**
+ * @brief Render windows so that the main loop waits for vblank at most once.
+ * Swapping buffers of a window with vsync enabled blocks until vblank. So, rendering
+ * several windows one after another would make the main loop run at the refresh rate
+ * divided by the number of windows. Instead, only one window with vsync enabled, the one
+ * which is rendered last, waits for vblank, the other windows swap buffers without waiting.
+ *
+ * The native window type must provide set_wait_for_vblank(bool) which is to be respected
+ * by the next swap of its frame buffers.
+ * @param windows - windows to render. The vector is cleared by the function.
+ * @return The window which waited for vblank.
+ * @return nullptr if none of the windows has vsync enabled.
+ */
+template <typename app_window_type>
+app_window_type* render_with_single_vblank_wait(std::vector<app_window_type*>& windows)
+{
+	if (windows.empty()) {
+		return nullptr;
+	}
+
+	auto pacing_window = std::find_if(
+		windows.rbegin(), //
+		windows.rend(),
+		[](app_window_type* w) {
+			return w->ruis_native_window.get().is_vsync_enabled();
+		}
+	);
+	app_window_type* pacer = nullptr;
+	if (pacing_window != windows.rend()) {
+		// render the window which waits for vblank last
+		std::iter_swap(pacing_window, windows.rbegin());
+		pacer = windows.back();
+	}
+
+	for (auto w : windows) {
+		w->ruis_native_window.get().set_wait_for_vblank(w == pacer);
+		w->render();
+	}
+
+	windows.clear();
+
+	return pacer;
+}
+} // namespace
@@ -0,0 +1,100 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <cerrno>
+#include <system_error>
+
+#include <opros/waitable.hpp>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <utki/debug.hpp>
+
+namespace {
+/**
+ * @brief Waitable which is signalled from another thread.
+ * Based on eventfd.
+ */
+class wakeup_waitable : public opros::waitable
+{
+	const int event_fd;
+
+	static int make_event_fd()
+	{
+		int fd = eventfd(
+			0, //
+			EFD_NONBLOCK | EFD_CLOEXEC
+		);
+		if (fd < 0) {
+			throw std::system_error(
+				errno, //
+				std::generic_category(),
+				"could not create eventfd"
+			);
+		}
+		return fd;
+	}
+
+public:
+	wakeup_waitable() :
+		wakeup_waitable(make_event_fd())
+	{}
+
+private:
+	wakeup_waitable(int fd) :
+		opros::waitable(fd),
+		event_fd(fd)
+	{}
+
+public:
+	wakeup_waitable(const wakeup_waitable&) = delete;
+	wakeup_waitable& operator=(const wakeup_waitable&) = delete;
+
+	wakeup_waitable(wakeup_waitable&&) = delete;
+	wakeup_waitable& operator=(wakeup_waitable&&) = delete;
+
+	~wakeup_waitable()
+	{
+		close(this->event_fd);
+	}
+
+	int get_fd() const noexcept
+	{
+		return this->event_fd;
+	}
+
+	void set() noexcept
+	{
+		if (eventfd_write(this->event_fd, 1) < 0) {
+			utki::assert(false, SL);
+		}
+	}
+
+	void clear() noexcept
+	{
+		eventfd_t value = 0;
+		if (eventfd_read(this->event_fd, &value) < 0) {
+			utki::assert(errno == EAGAIN, SL);
+		}
+	}
+};
+} // namespace
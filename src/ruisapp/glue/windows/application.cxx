@@ -23,6 +23,7 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #include <Shlobj.h> // needed for SHGetFolderPathA()
 
+
 namespace {
 void app_window::send_mouse_button_event(
 	ruis::button_action action, //
@@ -43,7 +44,7 @@ void app_window::send_mouse_button_event(
 	}
 
 	this->mouse_button_state.set(button);
-	this->gui.send_mouse_button(
+	this->send_mouse_button(
 		action, //
 		pos,
 		button,
@@ -157,16 +158,7 @@ ruisapp::window& application_glue::make_window(ruisapp::window_parameters window
 	auto ruis_context = utki::make_shared<ruis::context>(ruis::context::parameters{
 		.post_to_ui_thread_function =
 			[](std::function<void()> procedure) {
-				if (PostMessage(
-						NULL, // post message to UI thread's message queue
-						WM_USER,
-						0, // no wParam
-						// NOLINTNEXTLINE(cppcoreguidelines-owning-memory, cppcoreguidelines-pro-type-reinterpret-cast)
-						reinterpret_cast<LPARAM>(new std::remove_reference_t<decltype(procedure)>(std::move(procedure)))
-					) == 0)
-				{
-					throw std::runtime_error("PostMessage(): failed");
-				}
+				ruisapp::inst().post_to_ui_thread(std::move(procedure));
 			},
 		.updater = this->updater,
 		.renderer = utki::make_shared<ruis::render::renderer>(
@@ -192,7 +184,7 @@ ruisapp::window& application_glue::make_window(ruisapp::window_parameters window
 		std::move(ruis_native_window)
 	);
 
-	ruisapp_window.get().gui.set_viewport( //
+	ruisapp_window.get().set_viewport( //
 		ruis::rect(
 			0, //
 			0,
@@ -236,12 +228,51 @@ void ruisapp::application::quit() noexcept
 	);
 }
 
+void ruisapp::application::post_to_ui_thread(
+	ui_procedure_type procedure, //
+	[[maybe_unused]] ui_priority priority
+)
+{
+	// this backend has a single UI queue lane, so the priority is ignored
+	if (PostMessage(
+			NULL, // post message to UI thread's message queue
+			WM_USER,
+			0, // no wParam
+			// NOLINTNEXTLINE(cppcoreguidelines-owning-memory, cppcoreguidelines-pro-type-reinterpret-cast)
+			reinterpret_cast<LPARAM>(new std::remove_reference_t<decltype(procedure)>(std::move(procedure)))
+		) == 0)
+	{
+		throw std::runtime_error("PostMessage(): failed");
+	}
+}
+
+ruisapp::application::ui_queue_metrics ruisapp::application::get_ui_queue_metrics()
+{
+	// the metrics are not collected by this backend
+	return {};
+}
+
 ruisapp::window& ruisapp::application::make_window_internal(ruisapp::window_parameters window_params)
 {
 	auto& glue = get_glue(*this);
 	return glue.make_window(std::move(window_params));
 }
 
+ruisapp::window& ruisapp::application::make_window_async(
+	window_parameters window_params, //
+	on_window_ready_function_type on_ready
+)
+{
+	// window creation is synchronous on this backend, so the window is ready right away
+	auto& win = this->make_window(std::move(window_params));
+
+	if (on_ready) {
+		on_ready(win);
+	}
+
+	return win;
+}
+
 void ruisapp::application::destroy_window(ruisapp::window& w)
 {
 	auto& glue = get_glue(*this);
@@ -250,3 +281,12 @@ void ruisapp::application::destroy_window(ruisapp::window& w)
 	auto& app_win = static_cast<app_window&>(w);
 	glue.destroy_window(app_win.ruis_native_window.get().get_id());
 }
+
+void ruisapp::application::load_resources_async(
+	[[maybe_unused]] load_function_type load, //
+	[[maybe_unused]] on_loaded_function_type on_loaded
+)
+{
+	// this backend has no resource loading thread, loading synchronously instead would block the UI thread
+	throw std::logic_error("application::load_resources_async(): not supported on this backend");
+}
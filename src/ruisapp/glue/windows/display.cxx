@@ -140,12 +140,12 @@ LRESULT CALLBACK window_procedure(
 						}
 					}
 
-					win.gui.send_mouse_hover(
+					win.send_mouse_hover(
 						true, //
 						0 // pointer id
 					);
 				}
-				win.gui.send_mouse_move(
+				win.send_mouse_move(
 					ruis::vec2(
 						float(GET_X_LPARAM(l_param)), //
 						float(GET_Y_LPARAM(l_param))
@@ -165,7 +165,7 @@ LRESULT CALLBACK window_procedure(
 				}
 
 				win.is_hovered = false;
-				win.gui.send_mouse_hover(
+				win.send_mouse_hover(
 					false,
 					0 // pointer id
 				);
@@ -175,7 +175,7 @@ LRESULT CALLBACK window_procedure(
 					if (win.mouse_button_state.get(btn)) {
 						win.mouse_button_state.clear(btn);
 						constexpr auto outside_of_window_coordinate = 100000000;
-						win.gui.send_mouse_button(
+						win.send_mouse_button(
 							ruis::button_action::release,
 							ruis::vec2(
 								outside_of_window_coordinate, //
@@ -280,7 +280,7 @@ LRESULT CALLBACK window_procedure(
 				}
 
 				for (unsigned i = 0; i != times; ++i) {
-					win.gui.send_mouse_button(
+					win.send_mouse_button(
 						ruis::button_action::press, //
 						ruis::vec2(
 							float(pos.x), //
@@ -289,7 +289,7 @@ LRESULT CALLBACK window_procedure(
 						button,
 						0 // pointer id
 					);
-					win.gui.send_mouse_button(
+					win.send_mouse_button(
 						ruis::button_action::release, //
 						ruis::vec2(
 							float(pos.x), //
@@ -310,19 +310,19 @@ LRESULT CALLBACK window_procedure(
 				constexpr auto previous_key_state_mask = 0x40000000;
 
 				if ((l_param & previous_key_state_mask) == 0) { // ignore auto-repeated keypress event
-					win.gui.send_key(
+					win.send_key(
 						ruis::button_action::press, //
 						key
 					);
 				}
-				win.gui.send_character_input(
+				win.send_character_input(
 					windows_input_string_provider(), //
 					key
 				);
 				return 0;
 			}
 		case WM_KEYUP:
-			win.gui.send_key(
+			win.send_key(
 				ruis::button_action::release,
 				// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
 				key_code_map[std::uint8_t(w_param)]
@@ -336,7 +336,7 @@ LRESULT CALLBACK window_procedure(
 				case U'\U0000000d': // Carriage return
 					break;
 				default:
-					win.gui.send_character_input(windows_input_string_provider(char32_t(w_param)), ruis::key::unknown);
+					win.send_character_input(windows_input_string_provider(char32_t(w_param)), ruis::key::unknown);
 					break;
 			}
 			return 0;
@@ -352,7 +352,7 @@ LRESULT CALLBACK window_procedure(
 			return 0;
 
 		case WM_SIZE:
-			win.gui.set_viewport( //
+			win.set_viewport( //
 				ruis::rect(
 					0, //
 					0,
@@ -96,9 +96,9 @@ void winmain(
 					glue.quit_flag.store(true);
 					break;
 				} else if (msg.message == WM_USER) {
-					std::unique_ptr<std::function<void()>> m(
+					std::unique_ptr<ruisapp::application::ui_procedure_type> m(
 						// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-						reinterpret_cast<std::function<void()>*>(msg.lParam)
+						reinterpret_cast<ruisapp::application::ui_procedure_type*>(msg.lParam)
 					);
 					(*m)();
 					continue;
@@ -0,0 +1,162 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <utki/debug.hpp>
+
+namespace ruisapp {
+
+/**
+ * @brief Move-only callable with inline storage.
+ * Callables which fit into the inline storage are stored without memory allocation.
+ * Bigger callables are stored on the heap.
+ * @tparam inline_capacity - size of the inline storage in bytes.
+ */
+template <size_t inline_capacity>
+class inline_function
+{
+	static_assert(inline_capacity >= sizeof(void*), "inline storage must fit a pointer");
+
+	alignas(std::max_align_t) std::array<std::byte, inline_capacity> storage;
+
+	void (*invoke)(void* storage) = nullptr;
+
+	// moves the callable from one storage to another and destroys the source,
+	// in case the destination is nullptr, just destroys the source
+	void (*relocate)(void* from, void* to) noexcept = nullptr;
+
+	template <typename callable_type>
+	constexpr static bool is_inline = //
+		sizeof(callable_type) <= inline_capacity && //
+		alignof(callable_type) <= alignof(std::max_align_t) && //
+		std::is_nothrow_move_constructible_v<callable_type>;
+
+	void reset() noexcept
+	{
+		if (this->relocate) {
+			this->relocate(this->storage.data(), nullptr);
+			this->relocate = nullptr;
+			this->invoke = nullptr;
+		}
+	}
+
+	void move_from(inline_function& f) noexcept
+	{
+		if (!f.relocate) {
+			return;
+		}
+		f.relocate(f.storage.data(), this->storage.data());
+		this->invoke = f.invoke;
+		this->relocate = f.relocate;
+		f.invoke = nullptr;
+		f.relocate = nullptr;
+	}
+
+public:
+	inline_function() = default;
+
+	template <
+		typename callable_type,
+		typename = std::enable_if_t<!std::is_same_v<std::decay_t<callable_type>, inline_function>>>
+	// NOLINTNEXTLINE(bugprone-forwarding-reference-overload, "overload is disabled for inline_function type")
+	inline_function(callable_type&& callable)
+	{
+		using type = std::decay_t<callable_type>;
+
+		if constexpr (std::is_same_v<type, std::function<void()>>) {
+			if (!callable) {
+				// empty std::function gives empty inline_function
+				return;
+			}
+		}
+
+		if constexpr (is_inline<type>) {
+			new (this->storage.data()) type(std::forward<callable_type>(callable));
+			this->invoke = [](void* s) {
+				(*std::launder(static_cast<type*>(s)))();
+			};
+			this->relocate = [](void* from, void* to) noexcept {
+				auto f = std::launder(static_cast<type*>(from));
+				if (to) {
+					new (to) type(std::move(*f));
+				}
+				f->~type();
+			};
+		} else {
+			// too big to fit into the inline storage, store on the heap
+			new (this->storage.data()) type*(new type(std::forward<callable_type>(callable)));
+			this->invoke = [](void* s) {
+				(**std::launder(static_cast<type**>(s)))();
+			};
+			this->relocate = [](void* from, void* to) noexcept {
+				auto p = *std::launder(static_cast<type**>(from));
+				if (to) {
+					new (to) type*(p);
+				} else {
+					delete p;
+				}
+			};
+		}
+	}
+
+	inline_function(const inline_function&) = delete;
+	inline_function& operator=(const inline_function&) = delete;
+
+	inline_function(inline_function&& f) noexcept
+	{
+		this->move_from(f);
+	}
+
+	inline_function& operator=(inline_function&& f) noexcept
+	{
+		if (this != &f) {
+			this->reset();
+			this->move_from(f);
+		}
+		return *this;
+	}
+
+	~inline_function()
+	{
+		this->reset();
+	}
+
+	explicit operator bool() const noexcept
+	{
+		return this->invoke != nullptr;
+	}
+
+	void operator()()
+	{
+		utki::assert(this->invoke, SL);
+		this->invoke(this->storage.data());
+	}
+};
+
+} // namespace ruisapp
@@ -0,0 +1,323 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "input_recording.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+
+#include <utki/string.hpp>
+
+#include "window.hpp"
+
+using namespace std::string_view_literals;
+
+using namespace ruisapp;
+
+namespace {
+constexpr auto file_header = "ruisapp_input_recording 1"sv;
+} // namespace
+
+namespace {
+std::string_view to_string(ruis::button_action action)
+{
+	return action == ruis::button_action::press ? "press"sv : "release"sv;
+}
+} // namespace
+
+namespace {
+ruis::button_action parse_button_action(std::string_view str)
+{
+	if (str == "press"sv) {
+		return ruis::button_action::press;
+	} else if (str == "release"sv) {
+		return ruis::button_action::release;
+	}
+	throw std::invalid_argument(utki::cat("input_recording::parse(): unknown button action: ", str));
+}
+} // namespace
+
+std::string input_recording::to_string() const
+{
+	std::stringstream ss;
+
+	// make sure the coordinates are read back exactly
+	ss << std::setprecision(std::numeric_limits<ruis::real>::max_digits10);
+
+	ss << file_header << '\n';
+
+	for (const auto& e : this->events) {
+		ss << e.time.count() << ' ';
+
+		std::visit(
+			[&ss](const auto& d) {
+				using type = std::decay_t<decltype(d)>;
+				if constexpr (std::is_same_v<type, input_event::mouse_move>) {
+					ss << "mouse_move " << d.pos.x() << ' ' << d.pos.y() << ' ' << d.pointer_id;
+				} else if constexpr (std::is_same_v<type, input_event::mouse_button>) {
+					ss << "mouse_button " << ::to_string(d.action) << ' ' << d.pos.x() << ' ' << d.pos.y() << ' '
+					   << unsigned(d.button) << ' ' << d.pointer_id;
+				} else if constexpr (std::is_same_v<type, input_event::mouse_hover>) {
+					ss << "mouse_hover " << (d.is_hovered ? 1 : 0) << ' ' << d.pointer_id;
+				} else if constexpr (std::is_same_v<type, input_event::keyboard>) {
+					ss << "key " << ::to_string(d.action) << ' ' << unsigned(d.key);
+				} else if constexpr (std::is_same_v<type, input_event::character_input>) {
+					ss << "character_input " << unsigned(d.key) << ' ' << d.string.size();
+					for (auto ch : d.string) {
+						ss << ' ' << uint32_t(ch);
+					}
+				} else {
+					static_assert(std::is_same_v<type, input_event::viewport>, "unhandled input event type");
+					ss << "viewport " << d.rect.p.x() << ' ' << d.rect.p.y() << ' ' << d.rect.d.x() << ' ' << d.rect.d.y();
+				}
+			},
+			e.data
+		);
+
+		ss << '\n';
+	}
+
+	return ss.str();
+}
+
+input_recording input_recording::parse(std::string_view str)
+{
+	std::istringstream is{std::string(str)};
+
+	std::string line;
+	if (!std::getline(is, line) || line != file_header) {
+		throw std::invalid_argument("input_recording::parse(): not an input recording");
+	}
+
+	input_recording ret;
+
+	while (std::getline(is, line)) {
+		if (line.empty()) {
+			continue;
+		}
+
+		std::istringstream ls(line);
+
+		std::chrono::microseconds::rep time = 0;
+		std::string type;
+		ls >> time >> type;
+
+		auto read_action = [&ls]() {
+			std::string a;
+			ls >> a;
+			return parse_button_action(a);
+		};
+
+		input_event::data_type data;
+
+		if (type == "mouse_move"sv) {
+			input_event::mouse_move m{};
+			ls >> m.pos.x() >> m.pos.y() >> m.pointer_id;
+			data = m;
+		} else if (type == "mouse_button"sv) {
+			input_event::mouse_button m{};
+			m.action = read_action();
+			unsigned button = 0;
+			ls >> m.pos.x() >> m.pos.y() >> button >> m.pointer_id;
+			m.button = ruis::mouse_button(button);
+			data = m;
+		} else if (type == "mouse_hover"sv) {
+			input_event::mouse_hover m{};
+			unsigned is_hovered = 0;
+			ls >> is_hovered >> m.pointer_id;
+			m.is_hovered = is_hovered != 0;
+			data = m;
+		} else if (type == "key"sv) {
+			input_event::keyboard k{};
+			k.action = read_action();
+			unsigned key = 0;
+			ls >> key;
+			k.key = ruis::key(key);
+			data = k;
+		} else if (type == "character_input"sv) {
+			input_event::character_input c{};
+			unsigned key = 0;
+			size_t size = 0;
+			ls >> key >> size;
+			c.key = ruis::key(key);
+			for (size_t j = 0; j != size && ls; ++j) {
+				uint32_t ch = 0;
+				ls >> ch;
+				c.string.push_back(char32_t(ch));
+			}
+			data = std::move(c);
+		} else if (type == "viewport"sv) {
+			input_event::viewport v{};
+			ls >> v.rect.p.x() >> v.rect.p.y() >> v.rect.d.x() >> v.rect.d.y();
+			data = v;
+		} else {
+			throw std::invalid_argument(utki::cat("input_recording::parse(): unknown event type: ", type));
+		}
+
+		if (ls.fail()) {
+			throw std::invalid_argument(utki::cat("input_recording::parse(): malformed line: ", line));
+		}
+
+		ret.events.push_back({
+			.time = std::chrono::microseconds(time), //
+			.data = std::move(data)
+		});
+	}
+
+	return ret;
+}
+
+bool input_recording::save(const std::string& file_name) const
+{
+	std::ofstream f(file_name);
+	f << this->to_string();
+	return bool(f);
+}
+
+input_recording input_recording::load(const std::string& file_name)
+{
+	std::ifstream f(file_name);
+	if (!f) {
+		throw std::runtime_error(utki::cat("input_recording::load(): could not open file: ", file_name));
+	}
+
+	std::stringstream ss;
+	ss << f.rdbuf();
+
+	return parse(ss.str());
+}
+
+namespace {
+class recorded_string_provider : public ruis::gui::input_string_provider
+{
+	const std::u32string& string;
+
+public:
+	recorded_string_provider(const std::u32string& string) :
+		string(string)
+	{}
+
+	std::u32string get() const override
+	{
+		return this->string;
+	}
+};
+} // namespace
+
+input_replayer::input_replayer(
+	ruisapp::window& window, //
+	input_recording recording,
+	float speed
+) :
+	window(window),
+	recording(std::move(recording)),
+	speed(speed)
+{
+	if (!(speed > 0)) {
+		throw std::invalid_argument("input_replayer::input_replayer(): speed must be positive");
+	}
+}
+
+void input_replayer::update([[maybe_unused]] uint32_t dt_ms)
+{
+	if (this->finished) {
+		return;
+	}
+
+	auto now = std::chrono::steady_clock::now();
+
+	if (!this->started) {
+		this->start = now;
+		this->started = true;
+	}
+
+	auto replay_time = std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::duration<double, std::micro>(now - this->start) * double(this->speed)
+	);
+
+	const auto& events = this->recording.events;
+
+	bool injected = false;
+
+	for (; this->next_event != events.size(); ++this->next_event) {
+		const auto& e = events[this->next_event];
+		if (e.time > replay_time) {
+			break;
+		}
+
+		injected = true;
+
+		auto& w = this->window;
+
+		std::visit(
+			[&w](const auto& d) {
+				using type = std::decay_t<decltype(d)>;
+				if constexpr (std::is_same_v<type, input_event::mouse_move>) {
+					w.send_mouse_move(
+						d.pos, //
+						d.pointer_id
+					);
+				} else if constexpr (std::is_same_v<type, input_event::mouse_button>) {
+					w.send_mouse_button(
+						d.action, //
+						d.pos,
+						d.button,
+						d.pointer_id
+					);
+				} else if constexpr (std::is_same_v<type, input_event::mouse_hover>) {
+					w.send_mouse_hover(
+						d.is_hovered, //
+						d.pointer_id
+					);
+				} else if constexpr (std::is_same_v<type, input_event::keyboard>) {
+					w.send_key(
+						d.action, //
+						d.key
+					);
+				} else if constexpr (std::is_same_v<type, input_event::character_input>) {
+					w.send_character_input(
+						recorded_string_provider(d.string), //
+						d.key
+					);
+				} else {
+					static_assert(std::is_same_v<type, input_event::viewport>, "unhandled input event type");
+					w.set_viewport(d.rect);
+				}
+			},
+			e.data
+		);
+	}
+
+	if (injected) {
+		this->window.invalidate_implicitly();
+	}
+
+	if (this->next_event == events.size()) {
+		this->finished = true;
+		if (this->finished_handler) {
+			this->finished_handler(*this);
+		}
+	}
+}
@@ -0,0 +1,201 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include <ruis/gui.hpp>
+#include <ruis/updateable.hpp>
+
+namespace ruisapp {
+
+class window;
+
+/**
+ * @brief Input event as it is delivered from the window to the GUI.
+ * Backend-specific input is normalized to these events, so the recorded
+ * events can be replayed with any backend.
+ */
+struct input_event {
+	struct mouse_move {
+		ruis::vec2 pos;
+		unsigned pointer_id;
+	};
+
+	struct mouse_button {
+		ruis::button_action action;
+		ruis::vec2 pos;
+		ruis::mouse_button button;
+		unsigned pointer_id;
+	};
+
+	struct mouse_hover {
+		bool is_hovered;
+		unsigned pointer_id;
+	};
+
+	struct keyboard {
+		ruis::button_action action;
+		ruis::key key;
+	};
+
+	struct character_input {
+		std::u32string string;
+		ruis::key key;
+	};
+
+	struct viewport {
+		ruis::rect rect;
+	};
+
+	using data_type = std::variant<
+		mouse_move, //
+		mouse_button,
+		mouse_hover,
+		keyboard,
+		character_input,
+		viewport>;
+
+	/**
+	 * @brief Time of the event since start of the recording.
+	 */
+	std::chrono::microseconds time;
+
+	data_type data;
+};
+
+/**
+ * @brief Recorded input events of a window.
+ * Recordings are made with window::start_input_recording() and window::stop_input_recording()
+ * and can be saved to a text file, one event per line, to be replayed later with input_replayer.
+ */
+struct input_recording {
+	/**
+	 * @brief Recorded events, in order of their time.
+	 */
+	std::vector<input_event> events;
+
+	/**
+	 * @brief Convert the recording to text format.
+	 * @return Text representation of the recording.
+	 */
+	std::string to_string() const;
+
+	/**
+	 * @brief Parse recording from text format.
+	 * @param str - text representation of the recording, as produced by to_string().
+	 * @return Parsed recording.
+	 * @throw std::invalid_argument - in case the text is malformed.
+	 */
+	static input_recording parse(std::string_view str);
+
+	/**
+	 * @brief Write the recording to a file in text format.
+	 * @param file_name - name of the file to write to.
+	 * @return true if the file was written successfully.
+	 * @return false otherwise.
+	 */
+	bool save(const std::string& file_name) const;
+
+	/**
+	 * @brief Read recording from a file.
+	 * @param file_name - name of the file to read from.
+	 * @return Read recording.
+	 * @throw std::runtime_error - in case the file could not be read.
+	 * @throw std::invalid_argument - in case the file contents are malformed.
+	 */
+	static input_recording load(const std::string& file_name);
+};
+
+/**
+ * @brief Replays recorded input events to a window.
+ * The events are injected to the window on updates, each event in the first update
+ * after its recorded time is reached, so the replayer has to be started with zero update interval:
+ * @code{.cpp}
+ * auto replayer = utki::make_shared<ruisapp::input_replayer>(window, std::move(recording));
+ * window.gui.context.get().updater.get().start(replayer, 0);
+ * @endcode
+ * Viewport events only change the GUI viewport, the native window is not resized.
+ */
+class input_replayer : public ruis::updateable
+{
+	ruisapp::window& window;
+
+	const input_recording recording;
+
+	const float speed;
+
+	size_t next_event = 0;
+
+	// not set until the first update
+	std::chrono::steady_clock::time_point start;
+	bool started = false;
+
+	bool finished = false;
+
+public:
+	/**
+	 * @brief Called once, on the update which has injected the last event.
+	 * The replayer is not stopped automatically, this handler can stop it.
+	 */
+	std::function<void(input_replayer& replayer)> finished_handler;
+
+	/**
+	 * @brief Create input replayer.
+	 * @param window - window to inject the events to. Must outlive the replayer.
+	 * @param recording - events to replay.
+	 * @param speed - replay pace, 1 means the original pace, 2 means twice as fast, etc.
+	 * @throw std::invalid_argument - in case the speed is not positive.
+	 */
+	input_replayer(
+		ruisapp::window& window, //
+		input_recording recording,
+		float speed = 1
+	);
+
+	input_replayer(const input_replayer&) = delete;
+	input_replayer& operator=(const input_replayer&) = delete;
+
+	input_replayer(input_replayer&&) = delete;
+	input_replayer& operator=(input_replayer&&) = delete;
+
+	~input_replayer() override = default;
+
+	/**
+	 * @brief Check if all the events have been replayed.
+	 * @return true if all the events have been injected to the window.
+	 * @return false otherwise.
+	 */
+	bool is_finished() const noexcept
+	{
+		return this->finished;
+	}
+
+	void update(uint32_t dt_ms) override;
+};
+
+} // namespace ruisapp
@@ -0,0 +1,234 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#include "startup_profile.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+#include <utki/enum_array.hpp>
+
+using namespace ruisapp;
+
+namespace {
+// initialized when the library is loaded, which is close enough to the program start
+const auto program_start_time = startup_profile::clock::now();
+
+constexpr auto trace_file_env_var = "RUISAPP_STARTUP_TRACE";
+
+using microseconds = std::chrono::duration<double, std::micro>;
+} // namespace
+
+std::string_view ruisapp::to_string(startup_phase phase)
+{
+	switch (phase) {
+		case startup_phase::make_application:
+			return "make_application";
+		case startup_phase::display_open:
+			return "display_open";
+		case startup_phase::config_choice:
+			return "config_choice";
+		case startup_phase::context_creation:
+			return "context_creation";
+		case startup_phase::glew_init:
+			return "glew_init";
+		case startup_phase::make_shaders:
+			return "make_shaders";
+		case startup_phase::resource_loader_construction:
+			return "resource_loader_construction";
+		case startup_phase::make_window:
+			return "make_window";
+		case startup_phase::first_swap:
+			return "first_swap";
+		case startup_phase::enum_size:
+			break;
+	}
+	return "unknown";
+}
+
+startup_profile::startup_profile() :
+	origin(program_start_time)
+{
+	// NOLINTNEXTLINE(concurrency-mt-unsafe, "the environment is not modified by the library")
+	if (auto file_name = std::getenv(trace_file_env_var)) {
+		this->trace_file = file_name;
+	}
+}
+
+startup_profile& startup_profile::inst()
+{
+	static startup_profile profile;
+	return profile;
+}
+
+void startup_profile::record(
+	startup_phase phase, //
+	clock::time_point begin,
+	clock::time_point end
+)
+{
+	if (this->is_complete()) {
+		return;
+	}
+
+	auto id = std::this_thread::get_id();
+
+	std::lock_guard lock(this->mutex);
+
+	auto i = std::find(
+		this->threads.begin(), //
+		this->threads.end(),
+		id
+	);
+	if (i == this->threads.end()) {
+		i = this->threads.insert(i, id);
+	}
+
+	this->spans.push_back({
+		.phase = phase, //
+		.begin = begin,
+		.end = end,
+		.thread = unsigned(std::distance(this->threads.begin(), i))
+	});
+}
+
+void startup_profile::set_trace_file(std::string file_name)
+{
+	// NOLINTNEXTLINE(concurrency-mt-unsafe, "the environment is not modified by the library")
+	if (std::getenv(trace_file_env_var)) {
+		return;
+	}
+
+	std::lock_guard lock(this->mutex);
+	this->trace_file = std::move(file_name);
+}
+
+void startup_profile::on_frame_presented()
+{
+	if (this->is_complete()) {
+		return;
+	}
+
+	{
+		std::lock_guard lock(this->mutex);
+		if (this->is_complete()) {
+			// completed by another thread meanwhile
+			return;
+		}
+		this->first_frame_time = clock::now();
+		this->complete.store(true, std::memory_order_release);
+	}
+
+	this->write_trace();
+}
+
+std::vector<startup_profile::span> startup_profile::get_spans() const
+{
+	std::lock_guard lock(this->mutex);
+	return this->spans;
+}
+
+startup_profile::clock::duration startup_profile::get_time_to_first_frame() const
+{
+	if (!this->is_complete()) {
+		return clock::duration::zero();
+	}
+
+	std::lock_guard lock(this->mutex);
+	return this->first_frame_time - this->origin;
+}
+
+std::string startup_profile::to_chrome_trace() const
+{
+	std::lock_guard lock(this->mutex);
+
+	std::stringstream ss;
+	ss << std::fixed << std::setprecision(3);
+
+	ss << R"({"displayTimeUnit":"ms","traceEvents":[)";
+
+	auto write_event = [&](std::string_view name, clock::time_point begin, clock::time_point end, unsigned thread) {
+		ss << R"({"name":")" << name << R"(","cat":"startup","ph":"X","pid":1,"tid":)" << thread //
+		   << R"(,"ts":)" << microseconds(begin - this->origin).count() //
+		   << R"(,"dur":)" << microseconds(end - begin).count() << "}";
+	};
+
+	bool first = true;
+	for (const auto& s : this->spans) {
+		if (!first) {
+			ss << ",";
+		}
+		first = false;
+		write_event(to_string(s.phase), s.begin, s.end, s.thread);
+	}
+
+	if (this->is_complete()) {
+		if (!first) {
+			ss << ",";
+		}
+		write_event("time_to_first_frame", this->origin, this->first_frame_time, 0);
+	}
+
+	ss << "]}";
+
+	return ss.str();
+}
+
+void startup_profile::write_trace() const
+{
+	std::string file_name;
+	{
+		std::lock_guard lock(this->mutex);
+		if (this->trace_file.empty()) {
+			return;
+		}
+		file_name = this->trace_file;
+	}
+
+	// sum up durations of all spans of each phase, e.g. there can be several windows created
+	utki::enum_array<clock::duration, startup_phase> totals{};
+	for (const auto& s : this->get_spans()) {
+		totals[s.phase] += s.end - s.begin;
+	}
+
+	auto& o = std::clog;
+	o << "ruisapp startup profile:" << '\n';
+	for (size_t i = 0; i != size_t(startup_phase::enum_size); ++i) {
+		auto phase = startup_phase(i);
+		o << "  " << std::left << std::setw(32) << to_string(phase) //
+		  << std::right << std::fixed << std::setprecision(3) << std::setw(10)
+		  << std::chrono::duration<double, std::milli>(totals[phase]).count() << " ms" << '\n';
+	}
+	o << "  " << std::left << std::setw(32) << "time_to_first_frame" //
+	  << std::right << std::setw(10)
+	  << std::chrono::duration<double, std::milli>(this->get_time_to_first_frame()).count() << " ms" << std::endl;
+
+	std::ofstream f(file_name);
+	f << this->to_chrome_trace();
+	if (!f) {
+		o << "ruisapp: could not write startup trace to " << file_name << std::endl;
+	}
+}
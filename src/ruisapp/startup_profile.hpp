@@ -0,0 +1,249 @@
+/*
+ruisapp - ruis GUI adaptation layer
+
+Copyright (C) 2016-2025  Ivan Gagis <igagis@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* ================ LICENSE END ================ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace ruisapp {
+
+/**
+ * @brief Phases of application startup.
+ */
+enum class startup_phase {
+	/**
+	 * @brief Construction of the application object, i.e. ruisapp::application_factory::make_application().
+	 * Includes the rest of the phases which are done during the application construction.
+	 */
+	make_application,
+
+	/**
+	 * @brief Opening connection to the display server.
+	 */
+	display_open,
+
+	/**
+	 * @brief Choosing graphics API framebuffer configuration, e.g. GLX or EGL config.
+	 */
+	config_choice,
+
+	/**
+	 * @brief Creation of graphics API context.
+	 */
+	context_creation,
+
+	/**
+	 * @brief Initialization of GLEW.
+	 */
+	glew_init,
+
+	/**
+	 * @brief Compilation of common shaders.
+	 */
+	make_shaders,
+
+	/**
+	 * @brief Construction of ruis::resource_loader.
+	 */
+	resource_loader_construction,
+
+	/**
+	 * @brief Creation of a window, i.e. ruisapp::application::make_window().
+	 */
+	make_window,
+
+	/**
+	 * @brief Swapping frame buffers of the first rendered frame.
+	 * The end of this phase is the time of the first presented frame.
+	 */
+	first_swap,
+
+	enum_size
+};
+
+/**
+ * @brief Get name of a startup phase.
+ * @param phase - startup phase to get the name of.
+ * @return Name of the startup phase.
+ */
+std::string_view to_string(startup_phase phase);
+
+/**
+ * @brief Profile of the application startup.
+ * Records time spans of startup phases from the program start until the first frame is presented.
+ * The recording is always done, as it is just a few timestamps, and is stopped once the first frame
+ * has been presented, after that recording costs one atomic load.
+ *
+ * In case a trace file is set, once the first frame is presented, the profile is written to the file
+ * in Chrome trace event JSON format (can be viewed with chrome://tracing or https://ui.perfetto.dev),
+ * and the breakdown of the startup time is printed to std::clog.
+ * The trace file can be set with the RUISAPP_STARTUP_TRACE environment variable or
+ * via ruisapp::application::parameters::startup_trace_file.
+ *
+ * All phases are recorded by the xorg, wayland and headless backends,
+ * other backends record only make_application, make_window and first_swap phases.
+ */
+class startup_profile
+{
+public:
+	using clock = std::chrono::steady_clock;
+
+	/**
+	 * @brief Time span of a startup phase.
+	 */
+	struct span {
+		startup_phase phase;
+		clock::time_point begin;
+		clock::time_point end;
+
+		/**
+		 * @brief Index of the thread the phase was executed on.
+		 * Threads are numbered in order of recording their first span.
+		 */
+		unsigned thread;
+	};
+
+	/**
+	 * @brief Measure a startup phase within a scope.
+	 * Records the phase span from construction till destruction of the object.
+	 */
+	class scope
+	{
+		const startup_phase phase;
+		const clock::time_point begin = clock::now();
+
+	public:
+		scope(startup_phase phase) :
+			phase(phase)
+		{}
+
+		scope(const scope&) = delete;
+		scope& operator=(const scope&) = delete;
+
+		scope(scope&&) = delete;
+		scope& operator=(scope&&) = delete;
+
+		~scope()
+		{
+			startup_profile::inst().record(
+				this->phase, //
+				this->begin,
+				clock::now()
+			);
+		}
+	};
+
+private:
+	// approximate program start time
+	const clock::time_point origin;
+
+	std::atomic_bool complete{false};
+
+	mutable std::mutex mutex;
+
+	std::vector<span> spans;
+	std::vector<std::thread::id> threads;
+
+	clock::time_point first_frame_time;
+
+	std::string trace_file;
+
+	startup_profile();
+
+	void write_trace() const;
+
+public:
+	startup_profile(const startup_profile&) = delete;
+	startup_profile& operator=(const startup_profile&) = delete;
+
+	startup_profile(startup_profile&&) = delete;
+	startup_profile& operator=(startup_profile&&) = delete;
+
+	~startup_profile() = default;
+
+	/**
+	 * @brief Get the program-wide startup profile.
+	 * @return The startup profile.
+	 */
+	static startup_profile& inst();
+
+	/**
+	 * @brief Record startup phase span.
+	 * Can be called from any thread.
+	 * Does nothing once the first frame has been presented.
+	 * @param phase - startup phase.
+	 * @param begin - time the phase has started.
+	 * @param end - time the phase has ended.
+	 */
+	void record(
+		startup_phase phase, //
+		clock::time_point begin,
+		clock::time_point end
+	);
+
+	/**
+	 * @brief Set file to write the startup trace to.
+	 * The RUISAPP_STARTUP_TRACE environment variable takes precedence over the value set by this function.
+	 * @param file_name - name of the file to write the trace to, empty string disables writing the trace.
+	 */
+	void set_trace_file(std::string file_name);
+
+	/**
+	 * @brief Notify that a frame has been presented.
+	 * The first call completes the startup profile.
+	 */
+	void on_frame_presented();
+
+	/**
+	 * @brief Check if the startup profile is complete, i.e. the first frame has been presented.
+	 * @return true if the first frame has been presented.
+	 */
+	bool is_complete() const noexcept
+	{
+		return this->complete.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * @brief Get recorded startup phase spans.
+	 * @return Recorded spans, in order of recording.
+	 */
+	std::vector<span> get_spans() const;
+
+	/**
+	 * @brief Get time from the program start till the first frame was presented.
+	 * @return Time to the first presented frame. Zero if the profile is not complete yet.
+	 */
+	clock::duration get_time_to_first_frame() const;
+
+	/**
+	 * @brief Get the startup profile in Chrome trace event JSON format.
+	 * @return Chrome trace event JSON.
+	 */
+	std::string to_chrome_trace() const;
+};
+
+} // namespace ruisapp
@@ -21,24 +21,478 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #include "window.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iterator>
+#include <stdexcept>
+
+#include <utki/debug.hpp>
+
+#include "flight_recorder.hpp"
+#include "startup_profile.hpp"
+
 using namespace ruisapp;
 
+namespace {
+bool is_empty(const r4::rectangle<int>& r)
+{
+	return r.d.x() <= 0 || r.d.y() <= 0;
+}
+} // namespace
+
+namespace {
+r4::rectangle<int> unite(const r4::rectangle<int>& a, const r4::rectangle<int>& b)
+{
+	if (is_empty(a)) {
+		return b;
+	}
+	if (is_empty(b)) {
+		return a;
+	}
+
+	using std::max;
+	using std::min;
+
+	r4::vector2<int> p = {min(a.p.x(), b.p.x()), min(a.p.y(), b.p.y())};
+	r4::vector2<int> p2 = {max(a.x2(), b.x2()), max(a.y2(), b.y2())};
+
+	return {p, p2 - p};
+}
+} // namespace
+
+namespace {
+r4::rectangle<int> intersect(const r4::rectangle<int>& a, const r4::rectangle<int>& b)
+{
+	using std::max;
+	using std::min;
+
+	r4::vector2<int> p = {max(a.p.x(), b.p.x()), max(a.p.y(), b.p.y())};
+	r4::vector2<int> p2 = {min(a.x2(), b.x2()), min(a.y2(), b.y2())};
+
+	if (p2.x() <= p.x() || p2.y() <= p.y()) {
+		return {0, 0, 0, 0};
+	}
+
+	return {p, p2 - p};
+}
+} // namespace
+
+namespace {
+// convert rectangle from window coordinates to framebuffer coordinates which have origin at bottom left corner
+r4::rectangle<int> flip_y(const r4::rectangle<int>& r, int framebuffer_height)
+{
+	return {
+		{r.p.x(), framebuffer_height - r.y2()},
+		r.d
+	};
+}
+} // namespace
+
+namespace {
+uint32_t make_trace_id()
+{
+	static std::atomic_uint32_t next_trace_id{1};
+	return next_trace_id.fetch_add(1, std::memory_order_relaxed);
+}
+} // namespace
+
 window::window(utki::shared_ref<ruis::context> ruis_context) :
+	trace_id(make_trace_id()),
 	gui(std::move(ruis_context))
-{}
+{
+	flight_recorder::inst().record_instant(
+		trace_event::window_create, //
+		this->trace_id
+	);
+}
+
+window::~window()
+{
+	flight_recorder::inst().record_instant(
+		trace_event::window_destroy, //
+		this->trace_id
+	);
+}
+
+void window::invalidate(const ruis::rect& region)
+{
+	// round outwards to whole pixels
+	r4::vector2<int> p = {int(std::floor(region.p.x())), int(std::floor(region.p.y()))};
+	r4::vector2<int> p2 = {int(std::ceil(region.x2())), int(std::ceil(region.y2()))};
+
+	if (p2.x() <= p.x() || p2.y() <= p.y()) {
+		return;
+	}
+
+	r4::rectangle<int> rect = {p, p2 - p};
+
+	if (this->render_needed) {
+		if (this->damage.empty()) {
+			// whole window is already damaged
+			return;
+		}
+	} else {
+		this->render_needed = true;
+		utki::assert(this->damage.empty(), SL);
+	}
+
+	if (this->damage.size() == max_num_damage_rects) {
+		// too many rectangles, collapse them into bounding one
+		auto bb = this->damage.front();
+		for (const auto& r : this->damage) {
+			bb = unite(bb, r);
+		}
+		this->damage.clear();
+		this->damage.push_back(bb);
+	}
+
+	this->damage.push_back(rect);
+}
+
+std::vector<r4::rectangle<int>> window::get_damage() const
+{
+	if (this->damage.empty()) {
+		return {r4::rectangle<int>({0, 0}, this->gui.get_root().rect().d.to<int>())};
+	}
+	return this->damage;
+}
 
 void window::render()
 {
+	this->render_needed = false;
+
 	this->gui.context.get().ren().ctx().apply([this]() {
-		// TODO: render only if needed?
-		this->gui.context.get().ren().ctx().clear_framebuffer_color();
+		using clock = std::chrono::steady_clock;
+
+		auto render_start = clock::now();
+
+		auto& ctx = this->gui.context.get().ren().ctx();
+
+		auto fb_dims = this->gui.get_root().rect().d.to<int>();
+		r4::rectangle<int> fb_rect = {{0, 0}, fb_dims};
+
+		bool fb_resized = fb_dims != this->last_framebuffer_dims;
+
+		std::vector<r4::rectangle<int>> frame_damage;
+		if (this->damage.empty() || fb_resized) {
+			frame_damage.push_back(fb_rect);
+		} else {
+			for (const auto& r : this->damage) {
+				auto dr = intersect(flip_y(r, fb_dims.y()), fb_rect);
+				if (!is_empty(dr)) {
+					frame_damage.push_back(dr);
+				}
+			}
+			if (frame_damage.empty()) {
+				// damaged regions are all outside of the window, should not normally happen
+				frame_damage.push_back(fb_rect);
+			}
+		}
+		this->damage.clear();
+
+		r4::rectangle<int> frame_damage_bb = {0, 0, 0, 0};
+		for (const auto& r : frame_damage) {
+			frame_damage_bb = unite(frame_damage_bb, r);
+		}
+
+		// The back buffer contains the frame presented buffer_age frames ago,
+		// so bring it up to date by repainting damage of all the frames presented since then.
+		auto buffer_age = this->get_back_buffer_age();
+
+		r4::rectangle<int> repaint_rect = fb_rect;
+		if (buffer_age != 0 && buffer_age <= this->damage_history_size + 1 && !fb_resized) {
+			repaint_rect = frame_damage_bb;
+			for (size_t i = 0; i != buffer_age - 1; ++i) {
+				repaint_rect = unite(repaint_rect, this->damage_history.at(i));
+			}
+		}
+
+		// remember damage of this frame
+		std::shift_right(this->damage_history.begin(), this->damage_history.end(), 1);
+		this->damage_history.front() = frame_damage_bb;
+		this->damage_history_size = std::min(this->damage_history_size + 1, this->damage_history.size());
+		this->last_framebuffer_dims = fb_dims;
+
+		this->set_repaint_region(repaint_rect);
+
+		bool partial = repaint_rect.p != fb_rect.p || repaint_rect.d != fb_rect.d;
+		if (partial) {
+			// restrict clearing and rendering to the repainted region,
+			// widgets which clip their contents intersect their scissor with this one
+			ctx.enable_scissor(true);
+			ctx.set_scissor(repaint_rect.to<uint32_t>());
+		}
+
+		ctx.clear_framebuffer_color();
 
 		// no clear of depth and stencil buffers, it will be done by individual widgets if needed
 
-		this->gui.render(this->gui.context.get().ren().ctx().initial_matrix);
+		this->gui.render(ctx.initial_matrix);
+
+		if (partial) {
+			ctx.enable_scissor(false);
+		}
+
+		if (!this->frame_capture_requests.empty() || this->continuous_frame_capture.has_value()) {
+			auto requests = std::move(this->frame_capture_requests);
+			this->frame_capture_requests.clear();
+			if (this->continuous_frame_capture.has_value()) {
+				requests.push_back(this->continuous_frame_capture.value());
+			}
+			this->frame_readbacks_in_flight = this->start_frame_readback(
+				fb_dims, //
+				std::move(requests)
+			);
+		}
+
+		auto swap_start = clock::now();
 
 		// std::cout << "swap frame buffers" << std::endl;
-		this->gui.context.get().window().swap_frame_buffers();
+		this->swap_frame_buffers(utki::make_span(frame_damage));
 		// std::cout << "swapped" << std::endl;
+
+		auto swap_end = clock::now();
+
+		auto& recorder = flight_recorder::inst();
+		recorder.record(
+			trace_event::render, //
+			render_start,
+			swap_start,
+			this->trace_id
+		);
+		recorder.record(
+			trace_event::swap, //
+			swap_start,
+			swap_end,
+			this->trace_id
+		);
+
+		if (auto& profile = startup_profile::inst(); !profile.is_complete()) {
+			profile.record(
+				startup_phase::first_swap, //
+				swap_start,
+				swap_end
+			);
+			profile.on_frame_presented();
+		}
+
+		auto& durations = this->cur_frame_sample.durations;
+		durations[frame_phase::render] =
+			std::chrono::duration_cast<frame_statistics::duration_type>(swap_start - render_start);
+		durations[frame_phase::swap] = std::chrono::duration_cast<frame_statistics::duration_type>(swap_end - swap_start);
 	});
 }
+
+void window::push_frame_statistics(const frame_statistics::sample& loop_sample) noexcept
+{
+	auto s = loop_sample;
+	s.durations[frame_phase::render] = this->cur_frame_sample.durations[frame_phase::render];
+	s.durations[frame_phase::swap] = this->cur_frame_sample.durations[frame_phase::swap];
+
+	this->frame_stats.push(s);
+
+	this->cur_frame_sample = {};
+}
+
+void window::coalesce_mouse_move(const ruis::vec2& pos, unsigned pointer_id)
+{
+	auto i = std::find_if(
+		this->pending_motions.begin(), //
+		this->pending_motions.end(),
+		[&](const auto& m) {
+			return m.pointer_id == pointer_id;
+		}
+	);
+	if (i == this->pending_motions.end()) {
+		this->pending_motions.push_back({.pointer_id = pointer_id});
+		i = std::prev(this->pending_motions.end());
+	}
+
+	i->pending = true;
+	i->pos = pos;
+
+	if (this->motion_history_handler) {
+		i->history.push_back(pos);
+	}
+}
+
+void window::flush_coalesced_input()
+{
+	for (auto& m : this->pending_motions) {
+		if (!m.pending) {
+			continue;
+		}
+		m.pending = false;
+
+		this->invalidate_implicitly();
+
+		if (this->motion_history_handler && !m.history.empty()) {
+			this->motion_history_handler(m.pointer_id, m.history);
+		}
+		m.history.clear();
+
+		this->send_mouse_move(
+			m.pos, //
+			m.pointer_id
+		);
+	}
+}
+
+void window::record_input(input_event::data_type data)
+{
+	if (!this->recorded_input.has_value()) {
+		return;
+	}
+
+	this->recorded_input->events.push_back({
+		.time = std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now() - this->input_recording_start
+		),
+		.data = std::move(data)
+	});
+}
+
+void window::send_mouse_move(const ruis::vec2& pos, unsigned pointer_id)
+{
+	this->record_input(input_event::mouse_move{
+		.pos = pos, //
+		.pointer_id = pointer_id
+	});
+	this->gui.send_mouse_move(
+		pos, //
+		pointer_id
+	);
+}
+
+void window::send_mouse_button(
+	ruis::button_action action, //
+	const ruis::vec2& pos,
+	ruis::mouse_button button,
+	unsigned pointer_id
+)
+{
+	this->record_input(input_event::mouse_button{
+		.action = action, //
+		.pos = pos,
+		.button = button,
+		.pointer_id = pointer_id
+	});
+	this->gui.send_mouse_button(
+		action, //
+		pos,
+		button,
+		pointer_id
+	);
+}
+
+void window::send_mouse_hover(bool is_hovered, unsigned pointer_id)
+{
+	this->record_input(input_event::mouse_hover{
+		.is_hovered = is_hovered, //
+		.pointer_id = pointer_id
+	});
+	this->gui.send_mouse_hover(
+		is_hovered, //
+		pointer_id
+	);
+}
+
+void window::send_key(ruis::button_action action, ruis::key key)
+{
+	this->record_input(input_event::keyboard{
+		.action = action, //
+		.key = key
+	});
+	this->gui.send_key(
+		action, //
+		key
+	);
+}
+
+void window::send_character_input(
+	const ruis::gui::input_string_provider& string_provider, //
+	ruis::key key
+)
+{
+	// the string is resolved only when recording, since it can be costly to get
+	if (this->recorded_input.has_value()) {
+		this->record_input(input_event::character_input{
+			.string = string_provider.get(), //
+			.key = key
+		});
+	}
+	this->gui.send_character_input(
+		string_provider, //
+		key
+	);
+}
+
+void window::set_viewport(const ruis::rect& rect)
+{
+	this->record_input(input_event::viewport{
+		.rect = rect //
+	});
+	this->gui.set_viewport(rect);
+}
+
+void window::start_input_recording()
+{
+	this->recorded_input.emplace();
+	this->input_recording_start = std::chrono::steady_clock::now();
+}
+
+input_recording window::stop_input_recording()
+{
+	if (!this->recorded_input.has_value()) {
+		return {};
+	}
+
+	auto ret = std::move(this->recorded_input.value());
+	this->recorded_input.reset();
+	return ret;
+}
+
+void window::capture_frame(
+	std::function<void(captured_frame)> callback, //
+	ruisapp::pixel_format format
+)
+{
+	if (!this->is_frame_capture_supported()) {
+		throw std::logic_error("window::capture_frame(): frame capture is not supported by the backend");
+	}
+
+	this->frame_capture_requests.push_back({
+		.callback = std::move(callback), //
+		.format = format
+	});
+}
+
+void window::start_frame_capture(
+	std::function<void(captured_frame)> callback, //
+	ruisapp::pixel_format format
+)
+{
+	if (!this->is_frame_capture_supported()) {
+		throw std::logic_error("window::start_frame_capture(): frame capture is not supported by the backend");
+	}
+
+	this->continuous_frame_capture = {
+		.callback = std::move(callback), //
+		.format = format
+	};
+}
+
+bool window::process_frame_captures()
+{
+	if (!this->frame_readbacks_in_flight) {
+		return false;
+	}
+
+	this->gui.context.get().ren().ctx().apply([this]() {
+		this->frame_readbacks_in_flight = this->poll_frame_readbacks();
+	});
+
+	return this->frame_readbacks_in_flight;
+}
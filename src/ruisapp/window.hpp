@@ -21,11 +21,21 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <functional>
+#include <optional>
+#include <vector>
 
+#include <r4/rectangle.hpp>
 #include <r4/vector.hpp>
 #include <ruis/gui.hpp>
 #include <utki/flags.hpp>
+#include <utki/span.hpp>
+
+#include "frame_statistics.hpp"
+#include "input_recording.hpp"
 
 namespace ruisapp {
 
@@ -62,6 +72,28 @@ enum class buffer {
 	enum_size
 };
 
+/**
+ * @brief Frame presentation mode.
+ */
+enum class presentation_mode {
+	/**
+	 * @brief Wait for the GPU to finish the frame right after presenting it.
+	 * Minimizes the latency between user input and its result appearing on the screen,
+	 * but CPU work on the next frame cannot overlap with GPU work on the presented one.
+	 */
+	low_latency,
+
+	/**
+	 * @brief Allow a bounded number of frames to be processed by the GPU at the same time.
+	 * CPU work on the next frame overlaps with GPU work on the previously presented frames,
+	 * at the cost of extra latency of up to window_parameters::max_frames_in_flight frames.
+	 * Falls back to low_latency mode if the graphics API does not support fences.
+	 */
+	throughput,
+
+	enum_size
+};
+
 /**
  * @brief Desired window parameters.
  */
@@ -110,10 +142,223 @@ struct window_parameters {
 	 * Color buffer is always there implicitly.
 	 */
 	utki::flags<ruisapp::buffer> buffers = false;
+
+	/**
+	 * @brief Minimal depth buffer precision in bits.
+	 * Only used if depth buffer is requested in buffers.
+	 * Value of 0 means the default precision: 24 bits for OpenGL and 16 bits for OpenGL ES.
+	 * Supported by the xorg, wayland, headless and android backends, other backends ignore it.
+	 */
+	unsigned depth_bits = 0;
+
+	/**
+	 * @brief Minimal alpha channel precision of the color buffer in bits.
+	 * Value of 0 means that the color buffer does not need the alpha channel.
+	 * Supported by the same backends as depth_bits.
+	 */
+	unsigned alpha_bits = 0;
+
+	/**
+	 * @brief Number of multisample anti-aliasing samples per pixel.
+	 * Values of 0 and 1 mean no multisampling.
+	 * Multisampling multiplies the fill rate cost, so it is only enabled when requested.
+	 * If the requested number of samples is not supported, the greatest supported lower number is used.
+	 * Supported by the same backends as depth_bits.
+	 */
+	unsigned num_samples = 0;
+
+	/**
+	 * @brief Frame presentation mode.
+	 * Used by the xorg and wayland backends. Other backends present frames the same way in both modes.
+	 */
+	ruisapp::presentation_mode presentation = ruisapp::presentation_mode::low_latency;
+
+	/**
+	 * @brief Maximum number of frames in flight.
+	 * Number of presented frames the GPU can be processing while the CPU works on the next frame.
+	 * Only used in presentation_mode::throughput. Value of 0 is treated as 1.
+	 */
+	unsigned max_frames_in_flight = 2;
+};
+
+/**
+ * @brief Pixel format of captured frames.
+ */
+enum class pixel_format {
+	/**
+	 * @brief 4 bytes per pixel: red, green, blue, alpha.
+	 */
+	rgba,
+
+	/**
+	 * @brief 4 bytes per pixel: blue, green, red, alpha.
+	 */
+	bgra,
+
+	enum_size
+};
+
+/**
+ * @brief Pixels of a captured frame.
+ */
+struct captured_frame {
+	/**
+	 * @brief Frame dimensions in pixels.
+	 */
+	r4::vector2<unsigned> dims;
+
+	ruisapp::pixel_format format;
+
+	/**
+	 * @brief Frame pixels.
+	 * Rows go from top to bottom and are tightly packed.
+	 */
+	std::vector<uint8_t> pixels;
+};
+
+/**
+ * @brief Request for capturing a frame.
+ */
+struct frame_capture_request {
+	/**
+	 * @brief Function to call with the captured frame.
+	 * Called on a worker thread.
+	 */
+	std::function<void(captured_frame)> callback;
+
+	ruisapp::pixel_format format;
 };
 
 class window
 {
+	frame_statistics frame_stats;
+
+	// render and swap timings of the current main loop iteration
+	frame_statistics::sample cur_frame_sample;
+
+	// identifies the window in the flight recorder events
+	const uint32_t trace_id;
+
+	bool render_needed = true;
+
+	// see set_implicit_invalidation()
+	bool implicit_invalidation = true;
+
+	// Regions of the window changed since last render, in window pixels with origin at top left corner.
+	// Empty list means the whole window is damaged.
+	std::vector<r4::rectangle<int>> damage;
+
+	constexpr static const size_t max_num_damage_rects = 8;
+
+	// Maximal back buffer age to do partial redraw for.
+	// Window systems usually have up to 3 buffers in the swap chain, take some extra.
+	constexpr static const size_t max_buffer_age = 5;
+
+	// Bounding rectangles of damage of previous frames, latest frame first, in framebuffer coordinates.
+	std::array<r4::rectangle<int>, max_buffer_age - 1> damage_history;
+	size_t damage_history_size = 0;
+
+	// framebuffer dimensions of the last rendered frame
+	r4::vector2<int> last_framebuffer_dims = {0, 0};
+
+	struct pending_motion {
+		unsigned pointer_id;
+		bool pending = false;
+		ruis::vec2 pos;
+
+		// all positions since last flush, only collected if motion_history_handler is set
+		std::vector<ruis::vec2> history;
+	};
+
+	// Motions of pointers which were down or moved during the window's lifetime.
+	// Entries are kept to reuse their memory.
+	std::vector<pending_motion> pending_motions;
+
+	// set while the input is being recorded
+	std::optional<input_recording> recorded_input;
+	std::chrono::steady_clock::time_point input_recording_start;
+
+	void record_input(input_event::data_type data);
+
+	// requests to capture the next rendered frame
+	std::vector<frame_capture_request> frame_capture_requests;
+
+	// request to capture every rendered frame
+	std::optional<frame_capture_request> continuous_frame_capture;
+
+	bool frame_readbacks_in_flight = false;
+
+	/**
+	 * @brief Check if the backend supports frame capture.
+	 * Backends supporting frame capture override this function.
+	 * @return true if frame capture is supported.
+	 */
+	virtual bool is_frame_capture_supported() const noexcept
+	{
+		return false;
+	}
+
+	/**
+	 * @brief Start reading the rendered frame.
+	 * Called right before presenting a frame which is requested to be captured,
+	 * with the rendering context bound.
+	 * Backends supporting frame capture override this function.
+	 * The reading must not wait for the GPU to finish rendering the frame, the pixels are
+	 * to be delivered to the requests' callbacks later, see poll_frame_readbacks().
+	 * @param dims - framebuffer dimensions.
+	 * @param requests - requests to capture the frame.
+	 * @return true if there are frame readbacks still in flight.
+	 */
+	virtual bool start_frame_readback(
+		[[maybe_unused]] r4::vector2<int> dims, //
+		[[maybe_unused]] std::vector<frame_capture_request> requests
+	)
+	{
+		return false;
+	}
+
+	/**
+	 * @brief Deliver frames whose readback has completed.
+	 * Called with the rendering context bound while there are frame readbacks in flight.
+	 * Must not wait for the readbacks to complete.
+	 * @return true if there are frame readbacks still in flight.
+	 */
+	virtual bool poll_frame_readbacks()
+	{
+		return false;
+	}
+
+	/**
+	 * @brief Get age of the back buffer.
+	 * Called right before rendering a frame, with the rendering context bound.
+	 * Backends supporting buffer age query override this function.
+	 * @return Number of frames passed since the current back buffer contents were presented.
+	 * @return 0 if the back buffer contents are undefined.
+	 */
+	virtual unsigned get_back_buffer_age()
+	{
+		return 0;
+	}
+
+	/**
+	 * @brief Set region of the back buffer which is going to be repainted.
+	 * Called before rendering a frame, after get_back_buffer_age(), with the rendering context bound.
+	 * Backends supporting partial update of the back buffer override this function.
+	 * @param region - region to be repainted, in framebuffer coordinates with origin at bottom left corner.
+	 */
+	virtual void set_repaint_region([[maybe_unused]] const r4::rectangle<int>& region) {}
+
+	/**
+	 * @brief Present rendered frame.
+	 * Called with the rendering context bound.
+	 * Backends supporting presenting with damage override this function.
+	 * @param damage - regions changed since previous frame, in framebuffer coordinates with origin at bottom left corner.
+	 */
+	virtual void swap_frame_buffers([[maybe_unused]] utki::span<const r4::rectangle<int>> damage)
+	{
+		this->gui.context.get().window().swap_frame_buffers();
+	}
+
 public:
 	ruis::gui gui;
 
@@ -125,9 +370,262 @@ public:
 	window(window&&) = delete;
 	window& operator=(window&&) = delete;
 
-	virtual ~window() = default;
+	virtual ~window();
 
+	/**
+	 * @brief Render the window.
+	 * Renders the widget hierarchy and swaps frame buffers regardless of
+	 * whether the rendering is needed or not.
+	 */
 	void render();
+
+	/**
+	 * @brief Request re-rendering of the window.
+	 * The main loop renders windows only when needed. The rendering is needed when
+	 * input events were delivered to the window, the window's viewport was changed,
+	 * procedures posted to the UI thread were executed or updateables were updated,
+	 * see set_implicit_invalidation().
+	 * In case the window appearance changes due to some other reason, this function
+	 * has to be called to get the window re-rendered on the next main loop iteration.
+	 */
+	void invalidate() noexcept
+	{
+		this->render_needed = true;
+		this->damage.clear();
+	}
+
+	/**
+	 * @brief Request re-rendering of a region of the window.
+	 * Same as invalidate(), but only the given region is marked as changed.
+	 * In case the backend supports it, only the changed regions are repainted
+	 * and presented to the window system.
+	 * Note, that input events, posted procedures and updates invalidate the whole window,
+	 * unless implicit invalidation is disabled, see set_implicit_invalidation().
+	 * @param region - changed region of the window, in window pixels with origin at top left corner.
+	 */
+	void invalidate(const ruis::rect& region);
+
+	/**
+	 * @brief Enable or disable implicit invalidation of the window.
+	 * ruis does not report which widgets have changed, so by default the whole window is invalidated
+	 * on every input event delivered to it, on every execution of procedures posted to the UI thread
+	 * and on every update of updateables. For example, each pointer motion repaints and presents the whole window.
+	 * Applications which know what changes in the window can disable the implicit invalidation
+	 * and call invalidate(const ruis::rect&) for the rectangles of the changed widgets,
+	 * so that only those regions are repainted and presented.
+	 * Viewport changes and exposure of the window by the window system always invalidate the whole window.
+	 * Implicit invalidation is enabled by default.
+	 * @param enable - whether to invalidate the window implicitly.
+	 */
+	void set_implicit_invalidation(bool enable) noexcept
+	{
+		this->implicit_invalidation = enable;
+	}
+
+	/**
+	 * @brief Invalidate the whole window, unless implicit invalidation is disabled.
+	 * Called by the backends on input events, execution of posted procedures and updates.
+	 * See set_implicit_invalidation().
+	 */
+	void invalidate_implicitly() noexcept
+	{
+		if (this->implicit_invalidation) {
+			this->invalidate();
+		}
+	}
+
+	/**
+	 * @brief Get regions of the window changed since last render.
+	 * @return Changed regions in window pixels with origin at top left corner.
+	 */
+	std::vector<r4::rectangle<int>> get_damage() const;
+
+	/**
+	 * @brief Check if the window needs to be re-rendered.
+	 * @return true if the window has been invalidated since last render.
+	 * @return false otherwise.
+	 */
+	bool is_render_needed() const noexcept
+	{
+		return this->render_needed;
+	}
+
+	/**
+	 * @brief Pointer motion history handler.
+	 * Pointer motion events received within one batch of input events are coalesced
+	 * into a single mouse move event carrying the latest pointer position.
+	 * In case every intermediate pointer position is needed, e.g. by a drawing canvas,
+	 * this handler can be set to receive all the positions coalesced into the mouse move event.
+	 * It is called right before the coalesced mouse move event is sent to the GUI.
+	 * Parameters are the pointer id and the pointer positions in order of arrival,
+	 * the last one being the position the mouse move event is sent with.
+	 */
+	std::function<void(unsigned pointer_id, utki::span<const ruis::vec2> positions)> motion_history_handler;
+
+	/**
+	 * @brief Coalesce pointer motion.
+	 * Called by backends instead of sending the mouse move event to the GUI right away.
+	 * The latest position of each pointer is sent to the GUI on flush_coalesced_input() call.
+	 * @param pos - pointer position, in window pixels with origin at top left corner.
+	 * @param pointer_id - id of the pointer.
+	 */
+	void coalesce_mouse_move(const ruis::vec2& pos, unsigned pointer_id);
+
+	/**
+	 * @brief Send coalesced input events to the GUI.
+	 * Called by backends at the end of each batch of input events and before sending
+	 * any other input event to the GUI, so that the order of input events is preserved.
+	 */
+	void flush_coalesced_input();
+
+	/**
+	 * @brief Send mouse move event to the GUI.
+	 * Backends send all input to the GUI through the window's send_*() functions
+	 * and set_viewport(), so that the input can be recorded.
+	 * Pointer motion should normally be sent via coalesce_mouse_move() instead.
+	 * @param pos - pointer position, in window pixels with origin at top left corner.
+	 * @param pointer_id - id of the pointer.
+	 */
+	void send_mouse_move(const ruis::vec2& pos, unsigned pointer_id);
+
+	/**
+	 * @brief Send mouse button event to the GUI.
+	 * @param action - button action.
+	 * @param pos - pointer position, in window pixels with origin at top left corner.
+	 * @param button - mouse button.
+	 * @param pointer_id - id of the pointer.
+	 */
+	void send_mouse_button(
+		ruis::button_action action, //
+		const ruis::vec2& pos,
+		ruis::mouse_button button,
+		unsigned pointer_id
+	);
+
+	/**
+	 * @brief Send mouse hover event to the GUI.
+	 * @param is_hovered - whether the pointer has entered or left the window.
+	 * @param pointer_id - id of the pointer.
+	 */
+	void send_mouse_hover(bool is_hovered, unsigned pointer_id);
+
+	/**
+	 * @brief Send key event to the GUI.
+	 * @param action - key action.
+	 * @param key - key.
+	 */
+	void send_key(ruis::button_action action, ruis::key key);
+
+	/**
+	 * @brief Send character input event to the GUI.
+	 * @param string_provider - provider of the input string.
+	 * @param key - key which has produced the input.
+	 */
+	void send_character_input(
+		const ruis::gui::input_string_provider& string_provider, //
+		ruis::key key
+	);
+
+	/**
+	 * @brief Set GUI viewport.
+	 * @param rect - viewport rectangle.
+	 */
+	void set_viewport(const ruis::rect& rect);
+
+	/**
+	 * @brief Start recording input of the window.
+	 * All input events sent to the GUI via the window are recorded, with mouse moves
+	 * recorded as they are sent to the GUI, i.e. after coalescing.
+	 * If the input is already being recorded, the recording is restarted.
+	 */
+	void start_input_recording();
+
+	/**
+	 * @brief Stop recording input of the window.
+	 * @return The recorded input events.
+	 * @return Empty recording in case the input was not being recorded.
+	 */
+	input_recording stop_input_recording();
+
+	/**
+	 * @brief Check if the input is being recorded.
+	 * @return true if the input is being recorded.
+	 * @return false otherwise.
+	 */
+	bool is_recording_input() const noexcept
+	{
+		return this->recorded_input.has_value();
+	}
+
+	/**
+	 * @brief Capture the next rendered frame.
+	 * Reads the pixels of the next frame rendered by the window right before presenting it.
+	 * The pixels are read asynchronously, so that rendering does not stall waiting for the GPU,
+	 * and are delivered to the callback on a worker thread, usually a frame or two later.
+	 * Note, that the window is only rendered when needed, see invalidate().
+	 * Frames which are not yet delivered when the window is destroyed are discarded.
+	 * In case the callbacks do not keep up with rendering, rendering waits for them to catch up,
+	 * so the callback must not block waiting for the UI thread.
+	 * Frame capture is supported by xorg, wayland and headless backends,
+	 * other backends throw std::logic_error.
+	 * @param callback - function to call with the captured frame. Called on a worker thread.
+	 * @param format - desired pixel format of the captured frame.
+	 * @throw std::logic_error - in case the backend does not support frame capture.
+	 */
+	void capture_frame(
+		std::function<void(captured_frame)> callback, //
+		ruisapp::pixel_format format = ruisapp::pixel_format::rgba
+	);
+
+	/**
+	 * @brief Start capturing every rendered frame.
+	 * Same as calling capture_frame() for each rendered frame.
+	 * Replaces previously started continuous capture, if any.
+	 * @param callback - function to call with each captured frame. Called on a worker thread.
+	 * @param format - desired pixel format of the captured frames.
+	 * @throw std::logic_error - in case the backend does not support frame capture.
+	 */
+	void start_frame_capture(
+		std::function<void(captured_frame)> callback, //
+		ruisapp::pixel_format format = ruisapp::pixel_format::rgba
+	);
+
+	/**
+	 * @brief Stop capturing every rendered frame.
+	 * Frames which have already been rendered are still delivered.
+	 */
+	void stop_frame_capture() noexcept
+	{
+		this->continuous_frame_capture.reset();
+	}
+
+	/**
+	 * @brief Deliver captured frames whose readback has completed.
+	 * Called by backend's main loop once per iteration.
+	 * @return true if there are frame readbacks still in flight, so the main loop
+	 *         has to call this function again soon, even if there is nothing else to do.
+	 */
+	bool process_frame_captures();
+
+	/**
+	 * @brief Get frame timing statistics of the window.
+	 * The statistics can be read from any thread.
+	 * Main loop phase timings are supported by xorg, wayland, sdl and headless backends.
+	 * @return Frame timing statistics.
+	 */
+	const frame_statistics& get_frame_statistics() const noexcept
+	{
+		return this->frame_stats;
+	}
+
+	/**
+	 * @brief Record frame timings of the current main loop iteration.
+	 * Called by backend's main loop once per iteration.
+	 * The render and swap timings are taken from the last render() call
+	 * within the iteration, the rest of timings are taken from the given sample.
+	 * @param loop_sample - timings of the main loop iteration phases common for all windows.
+	 */
+	void push_frame_statistics(const frame_statistics::sample& loop_sample) noexcept;
 };
 
 } // namespace ruisapp
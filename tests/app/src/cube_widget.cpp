@@ -68,12 +68,17 @@ void cube_widget::update(uint32_t dt){
     this->fpsSecCounter += dt;
     ++this->fps;
     // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
-    this->rot *= ruis::quat().set_rotation(r4::vector3<float>(1, 2, 1).normalize(), 1.5f * (float(dt) / std::milli::den));
+    this->rotate(1.5f * (float(dt) / std::milli::den));
     if(this->fpsSecCounter >= std::milli::den){
         std::cout << "fps = " << std::dec << fps << std::endl;
         this->fpsSecCounter = 0;
         this->fps = 0;
     }
+}
+
+void cube_widget::rotate(ruis::real angle){
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+    this->rot *= ruis::quat().set_rotation(r4::vector3<float>(1, 2, 1).normalize(), angle);
     this->clear_cache();
 }
 
@@ -29,6 +29,9 @@ public:
 
 	void update(uint32_t dt) override;
 
+	// rotate the cube by the given angle, in radians
+	void rotate(ruis::real angle);
+
 	void render(const ruis::mat4& matrix)const override;
 };
 
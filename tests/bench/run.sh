@@ -0,0 +1,54 @@
+#!/bin/bash
+
+# Runs the rendering benchmark without a physical display.
+# Usage: run.sh <backend> <bench-binary> [bench-args...]
+#   backend: xorg      - runs under Xvfb, rendering with Mesa llvmpipe
+#            wayland   - runs under headless weston, rendering with Mesa llvmpipe
+#            sdl       - runs with SDL offscreen video driver
+#            headless  - runs with ruisapp headless backend, no display server needed
+# The binary must be built for the corresponding backend, see makefile.
+# Results are printed to stdout, one JSON object per scenario.
+
+set -eo pipefail
+
+if [ $# -lt 2 ]; then
+	echo "usage: $0 <xorg|wayland|sdl|headless> <bench-binary> [bench-args...]" >&2
+	exit 1
+fi
+
+backend=$1
+binary=$(realpath "$2")
+shift 2
+
+# resource paths are relative to this directory
+cd "$(dirname "$0")"
+
+export LIBGL_ALWAYS_SOFTWARE=1
+export GALLIUM_DRIVER=llvmpipe
+
+case $backend in
+	xorg)
+		xvfb-run --auto-servernum --server-args="-screen 0 1920x1080x24" "$binary" --tag=$backend "$@"
+		;;
+	wayland)
+		export XDG_RUNTIME_DIR=$(mktemp -d)
+		trap 'kill $weston_pid 2>/dev/null; rm -rf "$XDG_RUNTIME_DIR"' EXIT
+		weston --backend=headless-backend.so --use-gl --socket=bench-wayland &
+		weston_pid=$!
+		while [ ! -S "$XDG_RUNTIME_DIR/bench-wayland" ]; do
+			kill -0 $weston_pid || { echo "weston failed to start" >&2; exit 1; }
+			sleep 0.1
+		done
+		WAYLAND_DISPLAY=bench-wayland "$binary" --tag=$backend "$@"
+		;;
+	sdl)
+		SDL_VIDEODRIVER=offscreen "$binary" --tag=$backend "$@"
+		;;
+	headless)
+		"$binary" --tag=$backend "$@"
+		;;
+	*)
+		echo "unknown backend: $backend" >&2
+		exit 1
+		;;
+esac
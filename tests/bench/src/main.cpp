@@ -0,0 +1,415 @@
+// Rendering benchmark suite.
+// Runs a set of scenarios, each for a fixed number of frames, and prints
+// one line of JSON per scenario with percentiles of the interval between main loop updates,
+// of the frame render and swap times of all windows, CPU time and memory usage.
+//
+// Command line arguments:
+//     --frames=<n> - number of frames to measure per scenario.
+//     --scenario=<name>[,<name>...] - scenarios to run, all scenarios are run by default.
+//     --tag=<label> - arbitrary label to put to the results, e.g. backend name.
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <ruis/standard_widgets.hpp>
+#include <ruis/updateable.hpp>
+#include <ruisapp/application.hpp>
+#include <utki/config.hpp>
+#include <utki/string.hpp>
+
+#if CFG_OS == CFG_OS_LINUX
+#	include <fstream>
+
+#	include <sys/resource.h>
+#	include <unistd.h>
+#endif
+
+#include "scenario.hpp"
+
+using namespace std::string_literals;
+using namespace std::string_view_literals;
+
+namespace {
+using clock_type = std::chrono::steady_clock;
+
+constexpr unsigned default_num_frames = 500;
+
+// frames rendered before starting the measurement, to let caches, glyph atlases etc. warm up
+constexpr unsigned num_warmup_frames = 10;
+
+struct memory_usage {
+	size_t rss_kb = 0;
+	size_t peak_rss_kb = 0;
+};
+
+memory_usage get_memory_usage()
+{
+	memory_usage ret;
+#if CFG_OS == CFG_OS_LINUX
+	{
+		std::ifstream statm("/proc/self/statm");
+		size_t size_pages = 0;
+		size_t resident_pages = 0;
+		if (statm >> size_pages >> resident_pages) {
+			constexpr auto bytes_per_kb = 1024;
+			ret.rss_kb = resident_pages * size_t(sysconf(_SC_PAGESIZE)) / bytes_per_kb;
+		}
+	}
+
+	rusage usage{};
+	if (getrusage(RUSAGE_SELF, &usage) == 0) {
+		// on Linux the ru_maxrss is in kilobytes
+		ret.peak_rss_kb = size_t(usage.ru_maxrss);
+	}
+#endif
+	return ret;
+}
+
+// prints percentiles of the values as a named JSON object
+void print_percentiles(
+	std::ostream& o, //
+	std::string_view name,
+	std::vector<double> values
+)
+{
+	std::sort(values.begin(), values.end());
+
+	auto percentile = [&values](double p) -> double {
+		if (values.empty()) {
+			return 0;
+		}
+		return values[std::min(size_t(double(values.size()) * p), values.size() - 1)];
+	};
+
+	double total = 0;
+	for (auto v : values) {
+		total += v;
+	}
+
+	o << '"' << name << R"(":{)";
+	o << R"("p50":)" << percentile(0.5) << ",";
+	o << R"("p90":)" << percentile(0.9) << ",";
+	o << R"("p99":)" << percentile(0.99) << ",";
+	o << R"("max":)" << percentile(1) << ",";
+	o << R"("mean":)" << (values.empty() ? 0 : total / double(values.size()));
+	o << "}";
+}
+
+// calls scenario step functions and invalidates the windows once per main loop iteration
+class frame_driver : public ruis::updateable
+{
+	std::vector<ruisapp::window*> windows;
+	std::vector<std::function<void(unsigned frame)>> steps;
+
+	const unsigned num_frames;
+
+	unsigned frame = 0;
+
+	clock_type::time_point last_update;
+
+	// number of frame statistics samples of each window seen so far
+	std::vector<uint64_t> num_seen_samples;
+
+	std::clock_t cpu_start = 0;
+	clock_type::time_point wall_start;
+
+	std::function<void()> done_handler;
+
+	// collects render and swap times of the frames rendered since the previous call
+	void collect_frame_statistics()
+	{
+		for (size_t i = 0; i != this->windows.size(); ++i) {
+			const auto& stats = this->windows[i]->get_frame_statistics();
+
+			auto num_recorded = stats.get_num_recorded();
+			auto num_new = size_t(num_recorded - this->num_seen_samples[i]);
+			this->num_seen_samples[i] = num_recorded;
+
+			auto samples = stats.get_samples();
+			auto first = std::next(
+				samples.begin(), //
+				std::ptrdiff_t(samples.size() - std::min(samples.size(), num_new))
+			);
+
+			for (auto j = first; j != samples.end(); ++j) {
+				const auto& d = j->durations;
+				if (d[ruisapp::frame_phase::render].count() == 0 && d[ruisapp::frame_phase::swap].count() == 0) {
+					// the window was not rendered in this main loop iteration
+					continue;
+				}
+				this->render_times_us.push_back(double(d[ruisapp::frame_phase::render].count()));
+				this->swap_times_us.push_back(double(d[ruisapp::frame_phase::swap].count()));
+			}
+		}
+	}
+
+	// Checks if a window's frame statistics ring is about to overwrite samples not collected yet.
+	// Collecting only then keeps copying of the samples out of the measured frames most of the time.
+	bool is_frame_statistics_collection_due() const
+	{
+		for (size_t i = 0; i != this->windows.size(); ++i) {
+			auto num_recorded = this->windows[i]->get_frame_statistics().get_num_recorded();
+			if (num_recorded - this->num_seen_samples[i] >= ruisapp::frame_statistics::capacity / 2) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+public:
+	// intervals between consecutive updates, i.e. main loop iterations, over the measured frames
+	std::vector<double> update_intervals_us;
+
+	// render and swap times of all windows over the measured frames
+	std::vector<double> render_times_us;
+	std::vector<double> swap_times_us;
+
+	double cpu_time_ms = 0;
+	double wall_time_ms = 0;
+
+	frame_driver(
+		std::vector<ruisapp::window*> windows, //
+		std::vector<std::function<void(unsigned frame)>> steps,
+		unsigned num_frames,
+		std::function<void()> done_handler
+	) :
+		windows(std::move(windows)),
+		steps(std::move(steps)),
+		num_frames(num_frames),
+		num_seen_samples(this->windows.size(), 0),
+		done_handler(std::move(done_handler))
+	{
+		this->update_intervals_us.reserve(num_frames);
+	}
+
+	void update([[maybe_unused]] uint32_t dt_ms) override
+	{
+		auto now = clock_type::now();
+
+		if (this->frame == num_warmup_frames) {
+			this->cpu_start = std::clock();
+			this->wall_start = now;
+
+			// skip the samples of the warm-up frames
+			for (size_t i = 0; i != this->windows.size(); ++i) {
+				this->num_seen_samples[i] = this->windows[i]->get_frame_statistics().get_num_recorded();
+			}
+		} else if (this->frame > num_warmup_frames) {
+			this->update_intervals_us.push_back(
+				std::chrono::duration<double, std::micro>(now - this->last_update).count()
+			);
+			if (this->is_frame_statistics_collection_due()) {
+				this->collect_frame_statistics();
+			}
+		}
+		this->last_update = now;
+
+		if (this->update_intervals_us.size() == this->num_frames) {
+			this->cpu_time_ms = double(std::clock() - this->cpu_start) * 1000 / CLOCKS_PER_SEC;
+			this->wall_time_ms = std::chrono::duration<double, std::milli>(now - this->wall_start).count();
+
+			this->collect_frame_statistics();
+
+			// finish the scenario outside of the updater
+			if (this->done_handler) {
+				auto h = std::move(this->done_handler);
+				this->done_handler = nullptr;
+				h();
+			}
+			return;
+		}
+
+		for (const auto& s : this->steps) {
+			s(this->frame);
+		}
+
+		for (auto w : this->windows) {
+			w->invalidate();
+		}
+
+		++this->frame;
+	}
+};
+
+class application : public ruisapp::application
+{
+	std::vector<scenario> scenarios;
+	size_t cur_scenario = 0;
+
+	unsigned num_frames = default_num_frames;
+	std::string tag;
+
+	bool widgets_initialized = false;
+
+	std::vector<ruisapp::window*> windows;
+	std::shared_ptr<frame_driver> driver;
+
+	void parse_args(utki::span<std::string_view> args)
+	{
+		std::vector<std::string> selected;
+
+		for (auto a : args) {
+			if (a.starts_with("--frames="sv)) {
+				a.remove_prefix("--frames="sv.size());
+				this->num_frames = unsigned(std::stoul(std::string(a)));
+			} else if (a.starts_with("--scenario="sv)) {
+				a.remove_prefix("--scenario="sv.size());
+				std::istringstream names{std::string(a)};
+				for (std::string n; std::getline(names, n, ',');) {
+					selected.push_back(std::move(n));
+				}
+			} else if (a.starts_with("--tag="sv)) {
+				a.remove_prefix("--tag="sv.size());
+				this->tag = a;
+			} else {
+				throw std::invalid_argument(utki::cat("unknown argument: ", a));
+			}
+		}
+
+		if (this->num_frames == 0) {
+			throw std::invalid_argument("number of frames must be greater than 0");
+		}
+
+		if (selected.empty()) {
+			return;
+		}
+
+		for (const auto& n : selected) {
+			if (std::none_of(this->scenarios.begin(), this->scenarios.end(), [&n](const auto& s) {
+					return s.name == n;
+				}))
+			{
+				throw std::invalid_argument(utki::cat("unknown scenario: ", n));
+			}
+		}
+
+		std::erase_if(this->scenarios, [&selected](const auto& s) {
+			return std::find(selected.begin(), selected.end(), s.name) == selected.end();
+		});
+	}
+
+	void start_next_scenario()
+	{
+		if (this->cur_scenario == this->scenarios.size()) {
+			this->quit();
+			return;
+		}
+
+		const auto& s = this->scenarios[this->cur_scenario];
+
+		std::vector<std::function<void(unsigned frame)>> steps;
+
+		for (unsigned i = 0; i != s.num_windows; ++i) {
+			auto& w = this->make_window(s.window_params);
+			this->windows.push_back(&w);
+
+			auto& c = w.gui.context.get();
+
+			// measure rendering, not waiting for the display refresh
+			c.ren().ctx().set_vsync_enabled(false);
+
+			// all windows share the resource loader and the style provider, so initialize them only once
+			if (!this->widgets_initialized) {
+				ruis::init_standard_widgets(
+					w.gui.context, //
+					this->get_res_file("../../res/ruis_res/")
+				);
+				c.loader().mount_res_pack(this->get_res_file("../app/res/"));
+				this->widgets_initialized = true;
+			}
+
+			auto sw = s.populate(w);
+			w.gui.set_root(sw.root);
+			steps.push_back(std::move(sw.step));
+		}
+
+		this->driver = std::make_shared<frame_driver>(
+			this->windows, //
+			std::move(steps),
+			this->num_frames,
+			[this]() {
+				this->post_to_ui_thread([this]() {
+					this->finish_scenario();
+				});
+			}
+		);
+
+		this->windows.front()->gui.context.get().updater.get().start(
+			utki::shared_ref<ruis::updateable>(this->driver), //
+			0
+		);
+	}
+
+	void finish_scenario()
+	{
+		this->windows.front()->gui.context.get().updater.get().stop(*this->driver);
+
+		this->print_results();
+
+		for (auto w : this->windows) {
+			this->destroy_window(*w);
+		}
+		this->windows.clear();
+		this->driver.reset();
+
+		++this->cur_scenario;
+
+		// windows are actually destroyed by the main loop, so start the next scenario on the next main loop iteration
+		this->post_to_ui_thread([this]() {
+			this->start_next_scenario();
+		});
+	}
+
+	void print_results()
+	{
+		const auto& s = this->scenarios[this->cur_scenario];
+
+		auto mem = get_memory_usage();
+
+		std::stringstream ss;
+		ss << std::fixed << std::setprecision(2);
+		ss << "{";
+		ss << R"("scenario":")" << s.name << R"(",)";
+		ss << R"("tag":")" << this->tag << R"(",)";
+		ss << R"("windows":)" << s.num_windows << ",";
+		ss << R"("frames":)" << this->driver->update_intervals_us.size() << ",";
+		print_percentiles(ss, "update_interval_us"sv, this->driver->update_intervals_us);
+		ss << ",";
+		print_percentiles(ss, "render_us"sv, this->driver->render_times_us);
+		ss << ",";
+		print_percentiles(ss, "swap_us"sv, this->driver->swap_times_us);
+		ss << ",";
+		ss << R"("cpu_time_ms":)" << this->driver->cpu_time_ms << ",";
+		ss << R"("wall_time_ms":)" << this->driver->wall_time_ms << ",";
+		ss << R"("rss_kb":)" << mem.rss_kb << ",";
+		ss << R"("peak_rss_kb":)" << mem.peak_rss_kb;
+		ss << "}";
+
+		std::cout << ss.str() << std::endl;
+	}
+
+public:
+	application(utki::span<std::string_view> args) :
+		ruisapp::application({.name = "bench"s}),
+		scenarios(make_scenarios())
+	{
+		this->parse_args(args);
+
+		this->post_to_ui_thread([this]() {
+			this->start_next_scenario();
+		});
+	}
+};
+} // namespace
+
+const ruisapp::application_factory app_fac([](auto executable, auto args) {
+	return std::make_unique<::application>(args);
+});
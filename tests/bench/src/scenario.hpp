@@ -0,0 +1,31 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <ruis/widget/widget.hpp>
+#include <ruisapp/window.hpp>
+
+// Contents of a benchmark scenario window.
+struct scenario_window {
+	utki::shared_ref<ruis::widget> root;
+
+	// Called before rendering each frame to change the window contents, e.g. to scroll a list.
+	// Frame numbers start from 0.
+	std::function<void(unsigned frame)> step;
+};
+
+struct scenario {
+	std::string name;
+
+	unsigned num_windows = 1;
+
+	ruisapp::window_parameters window_params;
+
+	// Creates contents of each scenario window.
+	// Called once for each window, the returned root widget is set to the window by the caller.
+	std::function<scenario_window(ruisapp::window& w)> populate;
+};
+
+std::vector<scenario> make_scenarios();
@@ -0,0 +1,369 @@
+#include <string>
+
+#include <ruis/widget/container.hpp>
+#include <ruis/widget/group/list.hpp>
+#include <ruis/widget/group/scroll_area.hpp>
+#include <ruis/widget/label/text.hpp>
+#include <utki/unicode.hpp>
+
+#include "../../app/src/cube_widget.hpp"
+
+#include "scenario.hpp"
+
+using namespace std::string_literals;
+
+using namespace ruis::length_literals;
+
+namespace m {
+using namespace ruis::make;
+using namespace ::make;
+} // namespace m
+
+namespace {
+constexpr unsigned default_window_width = 800;
+constexpr unsigned default_window_height = 600;
+
+// position in range [0, 1) of a sawtooth wave with the given period in frames
+ruis::real sawtooth(unsigned frame, unsigned period)
+{
+	return ruis::real(frame % period) / ruis::real(period);
+}
+
+// position in range [0, 1] of a triangle wave with the given period in frames
+ruis::real triangle(unsigned frame, unsigned period)
+{
+	auto f = sawtooth(frame, period) * 2;
+	return f <= 1 ? f : 2 - f;
+}
+
+std::u32string make_line(size_t index)
+{
+	return utki::to_utf32(
+		"line "s + std::to_string(index) + ": The quick brown fox jumps over the lazy dog. 0123456789 !@#$%^&*()"s
+	);
+}
+
+class lines_provider : public ruis::list_provider
+{
+	size_t num_lines;
+
+public:
+	lines_provider(
+		utki::shared_ref<ruis::context> context, //
+		size_t num_lines
+	) :
+		list_provider(std::move(context)),
+		num_lines(num_lines)
+	{}
+
+	size_t count() const noexcept override
+	{
+		return this->num_lines;
+	}
+
+	utki::shared_ref<ruis::widget> get_widget(size_t index) override
+	{
+		return m::text(
+			this->context, //
+			{},
+			make_line(index)
+		);
+	}
+};
+
+// list with thousands of items scrolled continuously
+scenario_window make_scrolling_list(ruisapp::window& w)
+{
+	constexpr size_t num_items = 5000;
+	constexpr ruis::real scroll_step = 7;
+
+	const auto& c = w.gui.context;
+
+	// clang-format off
+	auto list = m::list(c,
+		{
+			.layout_params{
+				.dims{ruis::dim::fill, ruis::dim::fill}
+			},
+			.widget_params{
+				.clip = true
+			},
+			.list_params{
+				.provider = utki::make_shared<lines_provider>(c, num_items)
+			}
+		}
+	);
+	// clang-format on
+
+	return {
+		.root = m::pile(c, {}, {list}),
+		.step =
+			[list]([[maybe_unused]] unsigned frame) {
+				auto& l = list.get();
+				l.scroll_by(scroll_step);
+				if (l.get_scroll_factor() >= 1) {
+					l.set_scroll_factor(0);
+				}
+			} //
+	};
+}
+
+// scroll area containing scroll areas, all of them scrolled continuously
+scenario_window make_nested_scroll_areas(ruisapp::window& w)
+{
+	constexpr size_t num_inner_areas = 20;
+	constexpr size_t num_lines_per_inner_area = 30;
+
+	const auto& c = w.gui.context;
+
+	std::vector<utki::shared_ref<ruis::scroll_area>> inner_areas;
+	std::vector<utki::shared_ref<ruis::widget>> rows;
+
+	for (size_t i = 0; i != num_inner_areas; ++i) {
+		std::vector<utki::shared_ref<ruis::widget>> lines;
+		for (size_t j = 0; j != num_lines_per_inner_area; ++j) {
+			lines.emplace_back(m::text(c, {}, make_line(i * num_lines_per_inner_area + j)));
+		}
+
+		// clang-format off
+		auto area = m::scroll_area(c,
+			{
+				.layout_params{
+					.dims{400_pp, 150_pp}
+				},
+				.widget_params{
+					.clip = true
+				}
+			},
+			{
+				m::column(c,
+					{
+						.layout_params{
+							.dims{ruis::dim::min, ruis::dim::min}
+						}
+					},
+					std::move(lines)
+				)
+			}
+		);
+		// clang-format on
+
+		inner_areas.push_back(area);
+		rows.emplace_back(std::move(area));
+	}
+
+	// clang-format off
+	auto outer_area = m::scroll_area(c,
+		{
+			.layout_params{
+				.dims{ruis::dim::fill, ruis::dim::fill}
+			},
+			.widget_params{
+				.clip = true
+			}
+		},
+		{
+			m::column(c,
+				{
+					.layout_params{
+						.dims{ruis::dim::min, ruis::dim::min}
+					}
+				},
+				std::move(rows)
+			)
+		}
+	);
+	// clang-format on
+
+	return {
+		.root = m::pile(c, {}, {outer_area}),
+		.step =
+			[outer_area, inner_areas = std::move(inner_areas)](unsigned frame) {
+				constexpr unsigned outer_period = 600;
+				constexpr unsigned inner_horizontal_period = 200;
+				constexpr unsigned inner_vertical_period = 120;
+
+				outer_area.get().set_scroll_factor({0, sawtooth(frame, outer_period)});
+
+				for (unsigned i = 0; i != inner_areas.size(); ++i) {
+					// shift phases, so that the areas are scrolled to different positions
+					inner_areas[i].get().set_scroll_factor({
+						triangle(frame + i * 7, inner_horizontal_period), //
+						triangle(frame + i * 13, inner_vertical_period)
+					});
+				}
+			} //
+	};
+}
+
+scenario_window make_spinning_cube(ruisapp::window& w)
+{
+	constexpr ruis::real angle_step = 0.02f;
+
+	const auto& c = w.gui.context;
+
+	// clang-format off
+	auto cube = m::cube_widget(c,
+		{
+			.layout_params{
+				.dims{ruis::dim::fill, ruis::dim::fill}
+			},
+			.widget_params{
+				.depth = true
+			}
+		}
+	);
+	// clang-format on
+
+	return {
+		.root = m::pile(c, {}, {cube}),
+		.step =
+			[cube]([[maybe_unused]] unsigned frame) {
+				cube.get().rotate(angle_step);
+			} //
+	};
+}
+
+// columns of text lines, some of the lines change every frame
+scenario_window make_text_heavy(ruisapp::window& w)
+{
+	constexpr size_t num_columns = 2;
+	constexpr size_t num_lines_per_column = 40;
+	constexpr size_t num_changed_lines_per_frame = 8;
+
+	const auto& c = w.gui.context;
+
+	std::vector<utki::shared_ref<ruis::text>> lines;
+	std::vector<utki::shared_ref<ruis::widget>> columns;
+
+	for (size_t i = 0; i != num_columns; ++i) {
+		std::vector<utki::shared_ref<ruis::widget>> column_lines;
+		for (size_t j = 0; j != num_lines_per_column; ++j) {
+			auto t = m::text(c, {}, make_line(i * num_lines_per_column + j));
+			lines.push_back(t);
+			column_lines.emplace_back(std::move(t));
+		}
+
+		// clang-format off
+		columns.emplace_back(m::column(c,
+			{
+				.layout_params{
+					.dims{ruis::dim::fill, ruis::dim::fill},
+					.weight = 1
+				},
+				.widget_params{
+					.clip = true
+				}
+			},
+			std::move(column_lines)
+		));
+		// clang-format on
+	}
+
+	// clang-format off
+	auto root = m::row(c,
+		{
+			.layout_params{
+				.dims{ruis::dim::fill, ruis::dim::fill}
+			}
+		},
+		std::move(columns)
+	);
+	// clang-format on
+
+	return {
+		.root = root,
+		.step =
+			[lines = std::move(lines)](unsigned frame) {
+				for (size_t i = 0; i != num_changed_lines_per_frame; ++i) {
+					auto index = (size_t(frame) * num_changed_lines_per_frame + i) % lines.size();
+					lines[index].get().set_text(make_line(size_t(frame) + index));
+				}
+			} //
+	};
+}
+
+// the window contents are laid out for a different size every frame
+scenario_window make_resize_storm(ruisapp::window& w)
+{
+	auto ret = make_text_heavy(w);
+
+	// The application has no way to resize native windows, so only the GUI viewport is changed,
+	// which makes the widgets to be laid out again and the whole window to be re-rendered, same
+	// as what happens when the window is resized by the user.
+	ret.step = [&w, text_step = std::move(ret.step)](unsigned frame) {
+		constexpr unsigned period = 60;
+		const ruis::vec2 min_dims = {200, 150};
+		const ruis::vec2 max_dims = {default_window_width, default_window_height};
+
+		auto dims = min_dims + (max_dims - min_dims) * triangle(frame, period);
+		w.gui.set_viewport(ruis::rect(0, 0, dims.x(), dims.y()));
+		text_step(frame);
+	};
+
+	return ret;
+}
+} // namespace
+
+std::vector<scenario> make_scenarios()
+{
+	const ruisapp::window_parameters default_window_params = {
+		.dims = {default_window_width, default_window_height},
+		.title = "bench"s
+	};
+
+	std::vector<scenario> ret;
+
+	ret.push_back({
+		.name = "list_scroll"s,
+		.window_params = default_window_params,
+		.populate = &make_scrolling_list
+	});
+
+	ret.push_back({
+		.name = "nested_scroll_areas"s,
+		.window_params = default_window_params,
+		.populate = &make_nested_scroll_areas
+	});
+
+	ret.push_back({
+		.name = "spinning_cube"s,
+		.window_params =
+			[&]() {
+				auto p = default_window_params;
+				p.buffers.set(ruisapp::buffer::depth);
+				return p;
+			}(),
+		.populate = &make_spinning_cube
+	});
+
+	ret.push_back({
+		.name = "text_heavy"s,
+		.window_params = default_window_params,
+		.populate = &make_text_heavy
+	});
+
+	for (unsigned num_windows : {1, 4, 16}) {
+		constexpr unsigned small_window_width = 400;
+		constexpr unsigned small_window_height = 300;
+
+		ret.push_back({
+			.name = "multi_window_"s + std::to_string(num_windows),
+			.num_windows = num_windows,
+			.window_params =
+				{
+					.dims = {small_window_width, small_window_height},
+					.title = "bench"s
+				},
+			.populate = &make_scrolling_list
+		});
+	}
+
+	ret.push_back({
+		.name = "resize_storm"s,
+		.window_params = default_window_params,
+		.populate = &make_resize_storm
+	});
+
+	return ret;
+}
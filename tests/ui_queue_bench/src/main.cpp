@@ -0,0 +1,145 @@
+// Multi-producer throughput and latency benchmark of the UI procedure queue.
+// Compares the ruisapp procedure_queue against nitki::queue.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <nitki/queue.hpp>
+#include <opros/wait_set.hpp>
+
+#include "../../../src/ruisapp/glue/procedure_queue.hxx"
+#include "../../../src/ruisapp/glue/wakeup_waitable.hxx"
+
+namespace {
+using clock_type = std::chrono::steady_clock;
+
+constexpr unsigned num_producers = 4;
+
+struct result {
+	double throughput; // procedures per second
+	std::vector<uint32_t> latencies_ns;
+};
+
+// in case the pace is zero the producers post as fast as they can
+template <typename queue_type>
+result run(
+	queue_type& queue, //
+	unsigned num_procs_per_producer,
+	std::chrono::nanoseconds pace
+)
+{
+	std::vector<uint32_t> latencies;
+	latencies.reserve(size_t(num_producers) * num_procs_per_producer);
+
+	size_t num_done = 0;
+
+	std::atomic_bool go{false};
+
+	std::vector<std::thread> producers;
+	for (unsigned i = 0; i != num_producers; ++i) {
+		producers.emplace_back([&]() {
+			while (!go.load(std::memory_order_acquire)) {
+				std::this_thread::yield();
+			}
+			auto next = clock_type::now();
+			for (unsigned j = 0; j != num_procs_per_producer; ++j) {
+				if (pace.count() != 0) {
+					next += pace;
+					while (clock_type::now() < next) {
+						std::this_thread::yield();
+					}
+				}
+				auto posted = clock_type::now();
+				// capture a few pointers, like the typical posted procedure does
+				queue.push_back([posted, &latencies, &num_done]() {
+					latencies.push_back(uint32_t(
+						std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - posted).count()
+					));
+					++num_done;
+				});
+			}
+		});
+	}
+
+	opros::wait_set wait_set(1);
+	wait_set.add(queue, {opros::ready::read}, &queue);
+
+	auto start = clock_type::now();
+	go.store(true, std::memory_order_release);
+
+	const auto total = size_t(num_producers) * num_procs_per_producer;
+
+	while (num_done != total) {
+		wait_set.wait(std::nullopt);
+		while (auto m = queue.pop_front()) {
+			m();
+		}
+	}
+
+	auto elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+
+	wait_set.remove(queue);
+
+	for (auto& t : producers) {
+		t.join();
+	}
+
+	return {
+		.throughput = double(total) / elapsed, //
+		.latencies_ns = std::move(latencies)
+	};
+}
+
+void print(std::string_view name, result r)
+{
+	auto& l = r.latencies_ns;
+	std::sort(l.begin(), l.end());
+
+	auto percentile = [&l](double p) {
+		return double(l[std::min(size_t(double(l.size()) * p), l.size() - 1)]) / 1000;
+	};
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << name << ":" << '\n';
+	std::cout << "    throughput = " << r.throughput / 1'000'000 << " Mprocs/s" << '\n';
+	std::cout << "    latency p50 = " << percentile(0.5) << " us" //
+		<< ", p99 = " << percentile(0.99) //
+		<< " us, p99.9 = " << percentile(0.999) //
+		<< " us, max = " << percentile(1) << " us" << std::endl;
+}
+
+template <typename queue_type>
+void bench(std::string_view name)
+{
+	// saturated producers, measures throughput,
+	// latency is dominated by the queue backlog
+	{
+		queue_type queue;
+		print(std::string(name).append(" (saturated)"), run(queue, 250'000, std::chrono::nanoseconds(0)));
+	}
+
+	// paced producers, measures wakeup latency
+	{
+		queue_type queue;
+		print(std::string(name).append(" (paced)"), run(queue, 10'000, std::chrono::microseconds(100)));
+	}
+}
+} // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] const char** argv)
+{
+	std::cout << num_producers << " producers" << std::endl;
+
+	bench<nitki::queue>("nitki::queue");
+	bench<procedure_queue<wakeup_waitable>>("procedure_queue");
+
+	return 0;
+}
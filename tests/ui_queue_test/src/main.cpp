@@ -0,0 +1,158 @@
+// Checks that the prioritized UI procedure queue signals its wakeup for procedures
+// posted after a drain() which has left the lanes not popped empty,
+// and that the UI procedure queue preserves the order of procedures posted from the same thread
+// when it overflows.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+
+#include "../../../src/ruisapp/glue/prioritized_procedure_queue.hxx"
+#include "../../../src/ruisapp/glue/wakeup_waitable.hxx"
+
+namespace {
+using queue_type = prioritized_procedure_queue<wakeup_waitable>;
+
+bool is_signalled(const queue_type& queue)
+{
+	pollfd pfd{
+		.fd = queue.get_fd(), //
+		.events = POLLIN,
+		.revents = 0
+	};
+	return poll(&pfd, 1, 0) == 1 && (pfd.revents & POLLIN) != 0;
+}
+
+void check(
+	bool condition, //
+	std::string_view message
+)
+{
+	if (!condition) {
+		std::cerr << "FAILED: " << message << std::endl;
+		std::exit(1);
+	}
+}
+
+// budget which is already exhausted
+ui_queue_budget exhausted_budget()
+{
+	return {
+		.deadline = queue_type::clock::now(), //
+		.run_idle = false
+	};
+}
+
+void test_input_lane_wakeup()
+{
+	queue_type queue;
+
+	queue.push_back([]() {}, ruisapp::ui_priority::input);
+	check(is_signalled(queue), "first input procedure signals the wakeup");
+
+	// the input lane is drained by procedure count, so it is never popped empty
+	auto res = queue.drain(exhausted_budget());
+	check(res.num_executed == 1, "drain executes the input procedure");
+	check(!is_signalled(queue), "drain clears the wakeup");
+
+	queue.push_back([]() {}, ruisapp::ui_priority::input);
+	check(is_signalled(queue), "input procedure posted after drain signals the wakeup");
+}
+
+void test_normal_lane_wakeup()
+{
+	queue_type queue;
+
+	queue.push_back([]() {});
+	queue.push_back([]() {});
+
+	// with exhausted budget only one normal procedure is executed
+	auto res = queue.drain(exhausted_budget());
+	check(res.num_executed == 1, "drain with exhausted budget executes one normal procedure");
+	check(queue.has_pending(false), "second normal procedure is left in the queue");
+	check(!is_signalled(queue), "drain clears the wakeup");
+
+	queue.push_back([]() {});
+	check(is_signalled(queue), "normal procedure posted after drain signals the wakeup");
+}
+
+// Captured by a procedure to make moving it slow, so that a producer is kept in between
+// claiming a ring cell and writing the procedure to it.
+struct slow_move {
+	constexpr static auto move_duration = std::chrono::milliseconds(100);
+
+	slow_move() = default;
+
+	slow_move(const slow_move&) = delete;
+	slow_move& operator=(const slow_move&) = delete;
+
+	slow_move(slow_move&&) noexcept
+	{
+		std::this_thread::sleep_for(move_duration);
+	}
+
+	slow_move& operator=(slow_move&&) = delete;
+
+	~slow_move() = default;
+};
+
+void test_order_preserved_on_overflow()
+{
+	using single_queue_type = procedure_queue<wakeup_waitable>;
+
+	single_queue_type queue;
+
+	std::vector<unsigned> executed;
+
+	// the producer claims the first ring cell and stays writing it
+	std::thread slow_producer([&queue]() {
+		queue.push_back([s = slow_move()]() {});
+	});
+
+	while (queue.size() == 0) {
+		std::this_thread::yield();
+	}
+
+	// the first procedure goes to the ring, the last one finds the ring full and goes to the overflow queue
+	constexpr unsigned num_procs = single_queue_type::capacity;
+	for (unsigned i = 0; i != num_procs; ++i) {
+		queue.push_back([&executed, i]() {
+			executed.push_back(i);
+		});
+	}
+
+	// procedures from the overflow queue are not taken until the claimed cell is written
+	while (auto proc = queue.pop_front()) {
+		proc();
+	}
+	check(executed.empty(), "no procedures are taken while the first ring cell is being written");
+
+	slow_producer.join();
+
+	while (auto proc = queue.pop_front()) {
+		proc();
+	}
+
+	check(executed.size() == num_procs, "all procedures are executed");
+	for (unsigned i = 0; i != executed.size(); ++i) {
+		if (executed[i] != i) {
+			check(false, "order of procedures posted from the same thread is preserved");
+		}
+	}
+}
+} // namespace
+
+int main()
+{
+	test_input_lane_wakeup();
+	test_normal_lane_wakeup();
+	test_order_preserved_on_overflow();
+
+	std::cout << "PASSED" << std::endl;
+	return 0;
+}
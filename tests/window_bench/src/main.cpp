@@ -0,0 +1,87 @@
+// Benchmark of repeated window creation and destruction,
+// like opening and closing popups or tooltips.
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <ruisapp/application.hpp>
+
+using namespace std::string_literals;
+
+namespace {
+using clock_type = std::chrono::steady_clock;
+
+constexpr unsigned num_windows = 1000;
+
+class application : public ruisapp::application
+{
+	std::vector<double> durations_us;
+
+	void print_results()
+	{
+		// the first window creation also chooses the framebuffer config, so report it separately
+		auto first = this->durations_us.front();
+
+		std::vector<double> rest(std::next(this->durations_us.begin()), this->durations_us.end());
+		std::sort(rest.begin(), rest.end());
+
+		auto percentile = [&rest](double p) {
+			return rest[std::min(size_t(double(rest.size()) * p), rest.size() - 1)];
+		};
+
+		double total = 0;
+		for (auto d : this->durations_us) {
+			total += d;
+		}
+
+		std::cout << std::fixed << std::setprecision(2);
+		std::cout << num_windows << " windows created and destroyed in " << total / 1000 << " ms" << '\n';
+		std::cout << "    first window = " << first << " us" << '\n';
+		std::cout << "    rest p50 = " << percentile(0.5) << " us" //
+				  << ", p99 = " << percentile(0.99) //
+				  << " us, max = " << percentile(1) << " us" << std::endl;
+	}
+
+	void create_and_destroy_next_window()
+	{
+		if (this->durations_us.size() == num_windows) {
+			this->print_results();
+			this->quit();
+			return;
+		}
+
+		auto start = clock_type::now();
+
+		auto& w = this->make_window({
+			.dims = {200, 100}, //
+			.title = "window_bench"s
+		});
+		this->destroy_window(w);
+
+		this->durations_us.push_back(std::chrono::duration<double, std::micro>(clock_type::now() - start).count());
+
+		// windows are actually destroyed by the main loop, so create the next one on the next main loop iteration
+		this->post_to_ui_thread([this]() {
+			this->create_and_destroy_next_window();
+		});
+	}
+
+public:
+	application() :
+		ruisapp::application({.name = "window_bench"s})
+	{
+		this->durations_us.reserve(num_windows);
+
+		this->post_to_ui_thread([this]() {
+			this->create_and_destroy_next_window();
+		});
+	}
+};
+} // namespace
+
+const ruisapp::application_factory app_fac([](auto executable, auto args) {
+	return std::make_unique<::application>();
+});